@@ -0,0 +1,215 @@
+// Asset pipeline stages on the real files under res/, all on the CPU (no GL context is created):
+//   OBJ parse of nanosuit.obj through assimp, the processMesh conversion of its meshes,
+//   JPEG / PNG / HDR decode, DXT1 / DXT5 compression and the mip chain of a 2K texture, RGB -> YCoCg.
+// Every stage runs a few warm-up passes, then the measured repetitions. Results are printed and written as
+// JSON so runs can be diffed across commits.
+//
+// usage: bench_asset_pipeline [--reps N] [--warmup N] [--output asset_bench.json]
+
+#include "bench_common.h"
+
+// model.h pulls in stb_image.h, compile its implementation in this translation unit.
+#define STB_IMAGE_IMPLEMENTATION
+#include <learnopengl/model.h>
+
+extern "C" {
+#include <image_DXT.h>
+}
+#include <image_helper.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+
+static const int TEXTURE_SIZE = 2048;
+
+struct StageResult
+{
+    std::string Name;
+    BenchStats Stats;
+    double Bytes;       // input bytes one repetition processes, for throughput
+};
+
+static std::vector<StageResult> results;
+
+static void measure(const char* name, int warmup, int reps, double bytes, const std::function<void()> &stage)
+{
+    for (int i = 0; i < warmup; i++)
+        stage();
+    std::vector<double> samples;
+    samples.reserve(reps);
+    for (int i = 0; i < reps; i++)
+    {
+        double start = BenchNow();
+        stage();
+        samples.push_back(BenchNow() - start);
+    }
+    StageResult result = {name, ComputeStats(samples), bytes};
+    PrintStats(name, result.Stats);
+    results.push_back(result);
+}
+
+static bool writeResults(const char* path, int warmup, int reps)
+{
+    FILE* file = std::fopen(path, "w");
+    if (file == NULL)
+    {
+        std::cout << "ERROR::BENCH::FAILED_TO_WRITE " << path << std::endl;
+        return false;
+    }
+    std::fprintf(file, "{\n  \"warmup\": %d,\n  \"reps\": %d,\n  \"stages\": [\n", warmup, reps);
+    for (unsigned int i = 0; i < results.size(); i++)
+    {
+        const StageResult &result = results[i];
+        const BenchStats &stats = result.Stats;
+        double throughput = stats.P50 > 0.0 ? result.Bytes / (1024.0 * 1024.0) / (stats.P50 / 1000.0) : 0.0;
+        std::fprintf(file, "    {\"name\": \"%s\", \"mean\": %.4f, \"min\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f, \"mb_per_s\": %.2f}%s\n",
+                     result.Name.c_str(), stats.Mean, stats.Min, stats.P50, stats.P95, stats.P99, stats.Max, throughput,
+                     i + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(file, "  ]\n}\n");
+    std::fclose(file);
+    return true;
+}
+
+static long fileSize(const char* path)
+{
+    FILE* file = std::fopen(path, "rb");
+    if (file == NULL)
+        return 0;
+    std::fseek(file, 0, SEEK_END);
+    long size = std::ftell(file);
+    std::fclose(file);
+    return size;
+}
+
+// decodes path once up front so a missing file fails the run instead of timing the error path.
+static bool decode(const char* name, const char* path, bool hdr, int warmup, int reps)
+{
+    int width, height, channels;
+    if (!stbi_info(path, &width, &height, &channels))
+    {
+        std::cout << "ERROR::BENCH::FAILED_TO_LOAD " << path << std::endl;
+        return false;
+    }
+    measure(name, warmup, reps, (double) fileSize(path), [&]() {
+        int w, h, c;
+        if (hdr)
+            stbi_image_free(stbi_loadf(path, &w, &h, &c, 0));
+        else
+            stbi_image_free(stbi_load(path, &w, &h, &c, 0));
+    });
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    int reps = 20;
+    int warmup = 3;
+    const char* output = "asset_bench.json";
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "--reps") == 0)
+            reps = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--warmup") == 0)
+            warmup = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--output") == 0)
+            output = argv[i + 1];
+        else
+        {
+            std::cout << "unknown option " << argv[i] << std::endl;
+            return -1;
+        }
+    }
+
+    // same post processing as Model::loadModel
+    const char* objPath = "../res/objects/nanosuit/nanosuit.obj";
+    const unsigned int importFlags = aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_CalcTangentSpace;
+    Assimp::Importer importer;
+    const aiScene* scene = importer.ReadFile(objPath, importFlags);
+    if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
+    {
+        std::cout << "ERROR::ASSIMP:: " << importer.GetErrorString() << std::endl;
+        return -1;
+    }
+    measure("obj parse (nanosuit.obj)", warmup, reps, (double) fileSize(objPath), [&]() {
+        Assimp::Importer parser;
+        parser.ReadFile(objPath, importFlags);
+    });
+
+    // the GL-free part of processMesh, fresh vectors every time like the loader
+    double meshBytes = 0.0;
+    for (unsigned int m = 0; m < scene->mNumMeshes; m++)
+        meshBytes += scene->mMeshes[m]->mNumVertices * sizeof(Vertex);
+    unsigned int indexCount = 0;
+    measure("processMesh (nanosuit, all meshes)", warmup, reps, meshBytes, [&]() {
+        indexCount = 0;
+        for (unsigned int m = 0; m < scene->mNumMeshes; m++)
+        {
+            vector<Vertex> vertices;
+            vector<unsigned int> indices;
+            Model::ConvertMesh(scene->mMeshes[m], vertices, indices);
+            indexCount += (unsigned int) indices.size();
+        }
+    });
+    if (indexCount == 0 || indexCount % 3 != 0)
+    {
+        std::cout << "ERROR::BENCH::MESH_CONVERSION " << indexCount << " indices" << std::endl;
+        return -1;
+    }
+
+    if (!decode("jpeg decode (container.jpg)", "../res/textures/container.jpg", false, warmup, reps) ||
+        !decode("png decode (wood.png)", "../res/textures/wood.png", false, warmup, reps) ||
+        !decode("hdr decode (newport_loft.hdr)", "../res/textures/hdr/newport_loft.hdr", true, warmup, reps))
+        return -1;
+
+    // a 2K texture: wood.png scaled up, once as RGB (DXT1 input) and once as RGBA (DXT5, mips, YCoCg)
+    int width, height, channels;
+    unsigned char* wood = stbi_load("../res/textures/wood.png", &width, &height, &channels, 4);
+    if (wood == NULL)
+        return -1;
+    std::vector<unsigned char> rgba(TEXTURE_SIZE * TEXTURE_SIZE * 4);
+    std::vector<unsigned char> rgb(TEXTURE_SIZE * TEXTURE_SIZE * 3);
+    up_scale_image(wood, width, height, 4, &rgba[0], TEXTURE_SIZE, TEXTURE_SIZE);
+    for (int i = 0; i < TEXTURE_SIZE * TEXTURE_SIZE; i++)
+        std::memcpy(&rgb[i * 3], &rgba[i * 4], 3);
+    stbi_image_free(wood);
+
+    int dxt1Size = 0, dxt5Size = 0;
+    measure("dxt1 compress (2048x2048 RGB)", warmup, reps, (double) rgb.size(), [&]() {
+        std::free(convert_image_to_DXT1(&rgb[0], TEXTURE_SIZE, TEXTURE_SIZE, 3, &dxt1Size));
+    });
+    measure("dxt5 compress (2048x2048 RGBA)", warmup, reps, (double) rgba.size(), [&]() {
+        std::free(convert_image_to_DXT5(&rgba[0], TEXTURE_SIZE, TEXTURE_SIZE, 4, &dxt5Size));
+    });
+    // 4 bits per texel for DXT1, 8 for DXT5
+    if (dxt1Size != TEXTURE_SIZE * TEXTURE_SIZE / 2 || dxt5Size != TEXTURE_SIZE * TEXTURE_SIZE)
+    {
+        std::cout << "ERROR::BENCH::DXT_SIZE " << dxt1Size << " " << dxt5Size << std::endl;
+        return -1;
+    }
+
+    // the whole chain down to 1x1, each level from the one above it
+    std::vector<unsigned char> levels[2];
+    levels[0].resize(rgba.size() / 4);
+    levels[1].resize(rgba.size() / 4);
+    measure("mipmap_image chain (2048 -> 1)", warmup, reps, (double) rgba.size(), [&]() {
+        const unsigned char* source = &rgba[0];
+        int size = TEXTURE_SIZE;
+        for (int level = 0; size > 1; level++, size /= 2)
+        {
+            unsigned char* target = &levels[level % 2][0];
+            mipmap_image(source, size, size, 4, target, 2, 2);
+            source = target;
+        }
+    });
+
+    // in place, so it works on a copy; converting the same texels again costs the same
+    std::vector<unsigned char> scratch(rgba);
+    measure("rgb -> YCoCg (2048x2048 RGBA)", warmup, reps, (double) scratch.size(), [&]() {
+        convert_RGB_to_YCoCg(&scratch[0], TEXTURE_SIZE, TEXTURE_SIZE, 4);
+    });
+
+    return writeResults(output, warmup, reps) ? 0 : -1;
+}
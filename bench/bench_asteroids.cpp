@@ -0,0 +1,120 @@
+// Asteroid field: a planet surrounded by N instanced rocks (default 100000), all rocks in one instanced
+// draw per mesh. With --animate the ring rotates and every matrix is rewritten each frame through the
+// persistently mapped instance buffer.
+//
+// usage: bench_asteroids [rock count] [--animate]
+
+#include "bench_common.h"
+
+// model.h pulls in stb_image.h, compile its implementation in this translation unit.
+#define STB_IMAGE_IMPLEMENTATION
+#include <learnopengl/model.h>
+#include <learnopengl/instance_buffer.h>
+#include <learnopengl/shader_library.h>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cstdlib>
+#include <cstring>
+
+struct Rock
+{
+    float Angle;
+    float Radius;
+    float Height;
+    float Scale;
+    float Rotation;
+};
+
+static glm::mat4 rockMatrix(const Rock &rock, float time)
+{
+    float angle = rock.Angle + time * 0.05f;
+    glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(std::sin(angle) * rock.Radius, rock.Height, std::cos(angle) * rock.Radius));
+    model = glm::scale(model, glm::vec3(rock.Scale));
+    return glm::rotate(model, rock.Rotation, glm::vec3(0.4f, 0.6f, 0.8f));
+}
+
+int main(int argc, char** argv)
+{
+    unsigned int count = 100000;
+    bool animate = false;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--animate") == 0)
+            animate = true;
+        else
+            count = (unsigned int) std::atoi(argv[i]);
+    }
+
+    GLFWwindow* window = CreateBenchContext(1280, 720);
+    if (window == NULL)
+        return -1;
+
+    ShaderLibrary library;
+    int handle = library.Submit("asteroid", "../res/shaders/asteroid.vs", "../res/shaders/asteroid.fs");
+    Model planet("../res/objects/planet/planet.obj");
+    Model rock("../res/objects/rock/rock.obj");
+    Shader shader = library.Get(handle);
+
+    // ring of rocks around the planet, same distribution as the classic instancing chapter
+    std::vector<Rock> rocks(count);
+    srand(1);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        float offset = 25.0f;
+        rocks[i].Angle = (float) i / (float) count * 2.0f * glm::pi<float>();
+        rocks[i].Radius = 150.0f + (rand() % (int) (2 * offset * 100)) / 100.0f - offset;
+        rocks[i].Height = ((rand() % (int) (2 * offset * 100)) / 100.0f - offset) * 0.4f;
+        rocks[i].Scale = (rand() % 20) / 100.0f + 0.05f;
+        rocks[i].Rotation = (float) (rand() % 360);
+    }
+
+    InstanceBuffer planetInstance(1, 1);
+    planetInstance.Map()[0] = glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, -3.0f, 0.0f)), glm::vec3(4.0f));
+    planetInstance.Commit(1);
+
+    InstanceBuffer rockInstances(count, animate ? 3 : 1);
+    if (!animate)
+    {
+        glm::mat4* matrices = rockInstances.Map();
+        for (unsigned int i = 0; i < count; i++)
+            matrices[i] = rockMatrix(rocks[i], 0.0f);
+        rockInstances.Commit(count);
+    }
+
+    shader.use();
+    shader.setMat4("projection", glm::perspective(glm::radians(45.0f), 1280.0f / 720.0f, 0.1f, 1000.0f));
+    shader.setMat4("view", glm::lookAt(glm::vec3(0.0f, 60.0f, 260.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f)));
+    glEnable(GL_DEPTH_TEST);
+
+    const int warmup = 30;
+    const int frames = 300;
+    std::vector<double> samples;
+    for (int frame = 0; frame < warmup + frames; frame++)
+    {
+        double start = BenchNow();
+        if (animate)
+        {
+            glm::mat4* matrices = rockInstances.Map();
+            for (unsigned int i = 0; i < count; i++)
+                matrices[i] = rockMatrix(rocks[i], frame / 60.0f);
+            rockInstances.Commit(count);
+        }
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        planet.DrawInstanced(shader, planetInstance);
+        rock.DrawInstanced(shader, rockInstances);
+        rockInstances.Fence();
+        glfwSwapBuffers(window);
+        glFinish();
+        if (frame >= warmup)
+            samples.push_back(BenchNow() - start);
+    }
+
+    BenchStats stats = ComputeStats(samples);
+    std::printf("%u rocks%s\n", count, animate ? " (animated)" : "");
+    PrintStats("frame", stats);
+    std::printf("%.1f million instances/s\n", count / stats.Mean / 1000.0);
+
+    DestroyBenchContext(window);
+    return 0;
+}
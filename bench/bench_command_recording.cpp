@@ -0,0 +1,233 @@
+// Recording 50k draws into per thread command buffers on 1 to 16 workers, then replaying them on the GL thread.
+
+#include "bench_common.h"
+
+#include <learnopengl/command_buffer.h>
+#include <learnopengl/frustum_culling.h>
+#include <learnopengl/shader_library.h>
+#include <learnopengl/worker_pool.h>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cmath>
+#include <cstdlib>
+#include <string>
+
+static const char* vertexCode =
+        "#version 330 core\n"
+        "layout (location = 0) in vec3 aPos;\n"
+        "uniform mat4 model;\n"
+        "uniform mat4 viewProjection;\n"
+        "void main() { gl_Position = viewProjection * model * vec4(aPos, 1.0); }\n";
+
+static const char* fragmentCode =
+        "#version 330 core\n"
+        "out vec4 FragColor;\n"
+        "uniform sampler2D texture_diffuse1;\n"
+        "uniform vec4 tint;\n"
+        "void main() { FragColor = texture(texture_diffuse1, vec2(0.5)) * tint; }\n";
+
+struct SceneObject
+{
+    glm::vec3 Position;
+    glm::vec3 Axis;
+    float Speed;
+    float Radius;
+    unsigned int Program;   // index into the programs
+    unsigned int Material;  // index into the materials
+    unsigned int Mesh;      // index into the meshes
+};
+
+struct BenchMesh
+{
+    GLuint VAO, VBO, EBO;
+    unsigned int Count;
+};
+
+// a box with its corners pulled in by bevel, so the meshes differ in index count.
+static BenchMesh createMesh(float bevel)
+{
+    float v[8 * 3];
+    for (int i = 0; i < 8; i++)
+    {
+        v[i * 3 + 0] = (i & 1) ? 0.5f - bevel : -0.5f + bevel;
+        v[i * 3 + 1] = (i & 2) ? 0.5f : -0.5f;
+        v[i * 3 + 2] = (i & 4) ? 0.5f : -0.5f;
+    }
+    unsigned int indices[36] = {0, 1, 3, 0, 3, 2, 4, 6, 7, 4, 7, 5, 0, 2, 6, 0, 6, 4,
+                                1, 5, 7, 1, 7, 3, 0, 4, 5, 0, 5, 1, 2, 3, 7, 2, 7, 6};
+    BenchMesh mesh;
+    mesh.Count = 36;
+    glGenVertexArrays(1, &mesh.VAO);
+    glGenBuffers(1, &mesh.VBO);
+    glGenBuffers(1, &mesh.EBO);
+    glBindVertexArray(mesh.VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, mesh.VBO);
+    glBufferData(GL_ARRAY_BUFFER, 8 * 3 * sizeof(float), v, GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*) 0);
+    glBindVertexArray(0);
+    return mesh;
+}
+
+int main()
+{
+    GLFWwindow* window = CreateBenchContext(320, 240);
+    if (window == NULL)
+        return -1;
+
+    const unsigned int objects = 50000;
+    const unsigned int programCount = 4, materialCount = 16, meshCount = 8;
+    const int frames = 30;
+
+    ShaderLibrary library;
+    std::vector<int> handles;
+    for (unsigned int i = 0; i < programCount; i++)
+        handles.push_back(library.SubmitSource("program" + std::to_string(i), vertexCode, fragmentCode));
+    std::vector<Shader> programs;
+    std::vector<GLint> modelLocations, tintLocations;
+    for (unsigned int i = 0; i < programCount; i++)
+    {
+        programs.push_back(library.Get(handles[i]));
+        modelLocations.push_back(glGetUniformLocation(programs[i].ID, "model"));
+        tintLocations.push_back(glGetUniformLocation(programs[i].ID, "tint"));
+    }
+
+    // resolved up front on the GL thread, workers only copy them
+    std::vector<GLuint> textures(materialCount);
+    std::vector<MaterialBinding> materials(materialCount);
+    glGenTextures(materialCount, &textures[0]);
+    for (unsigned int i = 0; i < materialCount; i++)
+    {
+        unsigned char texel[4] = {(unsigned char) (i * 16), 128, (unsigned char) (255 - i * 16), 255};
+        glBindTexture(GL_TEXTURE_2D, textures[i]);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, texel);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        materials[i].program = 0;
+        materials[i].count = 1;
+        materials[i].units[0] = 0;
+        materials[i].textures[0] = textures[i];
+    }
+
+    std::vector<BenchMesh> meshes;
+    for (unsigned int i = 0; i < meshCount; i++)
+        meshes.push_back(createMesh(0.05f * i));
+
+    // grouped by program, then material, like a sorted scene would be
+    std::srand(7);
+    std::vector<SceneObject> scene(objects);
+    for (unsigned int i = 0; i < objects; i++)
+    {
+        SceneObject &object = scene[i];
+        object.Position = glm::vec3(std::rand() % 2000 / 10.0f - 100.0f, std::rand() % 400 / 10.0f - 20.0f, -(float) (std::rand() % 2000) / 10.0f);
+        object.Axis = glm::normalize(glm::vec3(std::rand() % 100 + 1, std::rand() % 100, std::rand() % 100));
+        object.Speed = 0.5f + std::rand() % 100 / 50.0f;
+        object.Radius = 0.87f;
+        object.Program = (unsigned int) ((unsigned long long) i * programCount / objects);
+        object.Material = (unsigned int) ((unsigned long long) i * materialCount / objects);
+        object.Mesh = std::rand() % meshCount;
+    }
+
+    glm::mat4 projection = glm::perspective(glm::radians(60.0f), 320.0f / 240.0f, 0.1f, 250.0f);
+    glm::mat4 viewProjection = projection * glm::lookAt(glm::vec3(0.0f, 0.0f, 10.0f), glm::vec3(0.0f, 0.0f, -50.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    Frustum frustum = Frustum::FromMatrix(viewProjection);
+    for (unsigned int i = 0; i < programCount; i++)
+    {
+        programs[i].use();
+        programs[i].setMat4("viewProjection", viewProjection);
+        programs[i].setInt("texture_diffuse1", 0);
+    }
+
+    std::printf("%u objects, %u programs, %u materials, %u meshes, %u hardware threads\n\n", objects, programCount, materialCount, meshCount,
+                std::thread::hardware_concurrency());
+    std::printf("%-8s %12s %12s %10s %12s %10s %10s\n", "workers", "record ms", "replay ms", "speedup", "draws", "binds", "skipped");
+
+    const unsigned int workerCounts[] = {1, 2, 4, 8, 16};
+    double singleRecord = 0.0;
+    unsigned int singleDraws = 0;
+    bool valid = true;
+    for (unsigned int w = 0; w < sizeof(workerCounts) / sizeof(workerCounts[0]); w++)
+    {
+        WorkerPool pool(workerCounts[w]);
+        std::vector<CommandBuffer> buffers(pool.Workers());
+        std::vector<const CommandBuffer*> merged(pool.Workers());
+        for (unsigned int i = 0; i < buffers.size(); i++)
+            merged[i] = &buffers[i];
+
+        std::vector<double> recordSamples, replaySamples;
+        std::vector<size_t> capacities;
+        CommandReplayStats stats;
+        for (int frame = 0; frame < frames; frame++)
+        {
+            float time = frame / 60.0f;
+            double start = BenchNow();
+            pool.ParallelFor(objects, [&](unsigned int worker, unsigned int begin, unsigned int end)
+            {
+                CommandBuffer &buffer = buffers[worker];
+                buffer.Reset();
+                for (unsigned int i = begin; i < end; i++)
+                {
+                    const SceneObject &object = scene[i];
+                    if (!frustum.IntersectsSphere(object.Position, object.Radius))
+                        continue;
+                    glm::mat4 model = glm::rotate(glm::translate(glm::mat4(1.0f), object.Position), time * object.Speed, object.Axis);
+                    const BenchMesh &mesh = meshes[object.Mesh];
+                    buffer.BindProgram(programs[object.Program].ID);
+                    buffer.BindMaterial(materials[object.Material]);
+                    buffer.BindVertexArray(mesh.VAO);
+                    buffer.SetMat4(modelLocations[object.Program], model);
+                    buffer.SetVec4(tintLocations[object.Program], glm::vec4(1.0f, 1.0f, 1.0f, 0.5f + 0.5f * std::sin(time + i)));
+                    buffer.DrawElements(mesh.Count);
+                }
+            });
+            double recorded = BenchNow();
+            CommandBuffer::Replay(&merged[0], (unsigned int) merged.size(), &stats);
+            glFinish();
+            double replayed = BenchNow();
+            recordSamples.push_back(recorded - start);
+            replaySamples.push_back(replayed - recorded);
+
+            // after the first frame the buffers must not grow again
+            if (frame == 0)
+            {
+                for (unsigned int i = 0; i < buffers.size(); i++)
+                    capacities.push_back(buffers[i].Capacity());
+            }
+        }
+        for (unsigned int i = 0; i < buffers.size(); i++)
+        {
+            if (buffers[i].Capacity() != capacities[i])
+            {
+                std::printf("ERROR: buffer %u grew after the first frame\n", i);
+                valid = false;
+            }
+        }
+
+        BenchStats record = ComputeStats(recordSamples);
+        BenchStats replay = ComputeStats(replaySamples);
+        if (w == 0)
+        {
+            singleRecord = record.P50;
+            singleDraws = stats.Draws;
+        }
+        else if (stats.Draws != singleDraws)
+        {
+            std::printf("ERROR: %u workers replayed %u draws, 1 worker %u\n", workerCounts[w], stats.Draws, singleDraws);
+            valid = false;
+        }
+        std::printf("%-8u %12.3f %12.3f %9.2fx %12u %10u %10u\n", workerCounts[w], record.P50, replay.P50, singleRecord / record.P50,
+                    stats.Draws, stats.ProgramBinds + stats.MaterialBinds + stats.VAOBinds, stats.SkippedBinds);
+    }
+
+    for (unsigned int i = 0; i < meshCount; i++)
+    {
+        glDeleteVertexArrays(1, &meshes[i].VAO);
+        glDeleteBuffers(1, &meshes[i].VBO);
+        glDeleteBuffers(1, &meshes[i].EBO);
+    }
+    glDeleteTextures(materialCount, &textures[0]);
+    DestroyBenchContext(window);
+    return valid ? 0 : 1;
+}
@@ -0,0 +1,93 @@
+#ifndef BENCH_COMMON_H
+#define BENCH_COMMON_H
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <vector>
+
+// Shared helpers for the benchmark executables: a hidden GL context and basic timing statistics.
+
+struct BenchStats
+{
+    double Mean;
+    double Min;
+    double P50;
+    double P95;
+    double P99;
+    double Max;
+};
+
+inline double BenchNow()
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// expects samples in milliseconds (or any unit, the result keeps it).
+inline BenchStats ComputeStats(std::vector<double> samples)
+{
+    BenchStats stats = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+    if (samples.empty())
+        return stats;
+    std::sort(samples.begin(), samples.end());
+    double sum = 0.0;
+    for (unsigned int i = 0; i < samples.size(); i++)
+        sum += samples[i];
+    size_t last = samples.size() - 1;
+    stats.Mean = sum / samples.size();
+    stats.Min = samples[0];
+    stats.P50 = samples[(size_t) (last * 0.50 + 0.5)];
+    stats.P95 = samples[(size_t) (last * 0.95 + 0.5)];
+    stats.P99 = samples[(size_t) (last * 0.99 + 0.5)];
+    stats.Max = samples[last];
+    return stats;
+}
+
+inline void PrintStats(const char* name, const BenchStats &stats, const char* unit = "ms")
+{
+    std::printf("%-40s mean %9.3f%s  p50 %9.3f%s  p95 %9.3f%s  p99 %9.3f%s\n", name,
+                stats.Mean, unit, stats.P50, unit, stats.P95, unit, stats.P99, unit);
+}
+
+// creates an invisible window with a 4.6 core context and loads glad, returns NULL on failure.
+inline GLFWwindow* CreateBenchContext(int width = 800, int height = 600)
+{
+    if (!glfwInit())
+    {
+        std::cout << "Failed to init GLFW " << std::endl;
+        return NULL;
+    }
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    GLFWwindow* window = glfwCreateWindow(width, height, "LearnOpenGL bench", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return NULL;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSwapInterval(0);
+
+    if (!gladLoadGLLoader((GLADloadproc) glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return NULL;
+    }
+    return window;
+}
+
+inline void DestroyBenchContext(GLFWwindow* window)
+{
+    glfwDestroyWindow(window);
+    glfwTerminate();
+}
+
+#endif
@@ -0,0 +1,69 @@
+// Frustum culling throughput on 1M random boxes: scalar reference against the SSE and AVX batches.
+// No GL context is needed, only the CPU side of FrustumCuller runs.
+
+#include "bench_common.h"
+
+#include <learnopengl/frustum_culling.h>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cstdlib>
+#include <random>
+
+typedef void (FrustumCuller::*CullFunction)(const Frustum &, std::vector<uint32_t> &) const;
+
+// returns false if the culled set differs from the scalar reference.
+static bool run(const char* name, const FrustumCuller &culler, CullFunction cull, const Frustum &frustum,
+                const std::vector<uint32_t> &reference)
+{
+    std::vector<uint32_t> visible;
+    visible.reserve(culler.Size());
+    std::vector<double> samples;
+    for (int i = 0; i < 50; i++)
+    {
+        double start = BenchNow();
+        (culler.*cull)(frustum, visible);
+        samples.push_back(BenchNow() - start);
+    }
+    BenchStats stats = ComputeStats(samples);
+    PrintStats(name, stats);
+    std::printf("%-10s %u visible, %.1f Mboxes/s, %s reference\n", name, (unsigned int) visible.size(),
+                culler.Size() / stats.P50 / 1000.0, visible == reference ? "matches" : "DIFFERS FROM");
+    return visible == reference;
+}
+
+int main(int argc, char* argv[])
+{
+    unsigned int count = argc > 1 ? (unsigned int) std::atoi(argv[1]) : 1000000;
+
+    // boxes scattered in a 1km cube around a camera looking down -z, roughly a quarter of them end up visible
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> position(-500.0f, 500.0f);
+    std::uniform_real_distribution<float> size(0.5f, 10.0f);
+    FrustumCuller culler;
+    culler.Reserve(count);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        glm::vec3 center(position(random), position(random), position(random));
+        glm::vec3 extent(size(random), size(random), size(random));
+        culler.Add(center - extent, center + extent);
+    }
+
+    glm::mat4 projection = glm::perspective(glm::radians(90.0f), 16.0f / 9.0f, 0.1f, 600.0f);
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    Frustum frustum = Frustum::FromMatrix(projection * view);
+
+    std::vector<uint32_t> reference;
+    culler.CullScalar(frustum, reference);
+
+    std::printf("%u boxes\n", count);
+    bool matches = run("scalar", culler, &FrustumCuller::CullScalar, frustum, reference);
+#if defined(FRUSTUM_CULLING_SSE)
+    matches &= run("sse", culler, &FrustumCuller::CullSSE, frustum, reference);
+#endif
+    if (FrustumCuller::HasAVX())
+        matches &= run("avx", culler, &FrustumCuller::CullAVX, frustum, reference);
+    else
+        std::printf("avx        skipped, neither the build nor the CPU has it\n");
+    return matches ? 0 : -1;
+}
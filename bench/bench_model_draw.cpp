@@ -0,0 +1,82 @@
+// CPU cost of submitting the nanosuit model once the material bindings are resolved: one draw per mesh
+// (Model::Draw) versus all meshes merged in one glMultiDrawElementsIndirect (MergedGeometry).
+
+#include "bench_common.h"
+
+// model.h pulls in stb_image.h, compile its implementation in this translation unit.
+#define STB_IMAGE_IMPLEMENTATION
+#include <learnopengl/model.h>
+#include <learnopengl/shader_library.h>
+#include <learnopengl/merged_geometry.h>
+
+static const char* vertexCode =
+        "#version 330 core\n"
+        "layout (location = 0) in vec3 aPos;\n"
+        "layout (location = 2) in vec2 aTexCoords;\n"
+        "out vec2 TexCoords;\n"
+        "uniform mat4 mvp;\n"
+        "void main() { TexCoords = aTexCoords; gl_Position = mvp * vec4(aPos, 1.0); }\n";
+
+static const char* fragmentCode =
+        "#version 330 core\n"
+        "in vec2 TexCoords;\n"
+        "out vec4 FragColor;\n"
+        "uniform sampler2D texture_diffuse1;\n"
+        "uniform sampler2D texture_specular1;\n"
+        "void main() { FragColor = texture(texture_diffuse1, TexCoords) + 0.1 * texture(texture_specular1, TexCoords); }\n";
+
+int main()
+{
+    GLFWwindow* window = CreateBenchContext();
+    if (window == NULL)
+        return -1;
+
+    ShaderLibrary library;
+    int modelHandle = library.SubmitSource("model", vertexCode, fragmentCode);
+    int mergedHandle = library.Submit("merged", "../res/shaders/merged.vs", "../res/shaders/merged.fs");
+    Model model("../res/objects/nanosuit/nanosuit.obj");
+    std::cout << "nanosuit: " << model.meshes.size() << " meshes" << std::endl;
+    Shader shader = library.Get(modelHandle);
+    Shader mergedShader = library.Get(mergedHandle);
+
+    MergedGeometry merged;
+    merged.Add(model);
+    merged.Build();
+    std::cout << "merged: " << merged.DrawCount() << " draws in " << merged.Batches().size() << " batches" << std::endl;
+
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), 800.0f / 600.0f, 0.1f, 100.0f);
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 8.0f, 20.0f), glm::vec3(0.0f, 8.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+    const int warmup = 100;
+    const int frames = 1000;
+    std::vector<double> samples, mergedSamples;
+    for (int frame = 0; frame < warmup + frames; frame++)
+    {
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        double start = BenchNow();
+        shader.use();
+        shader.setMat4("mvp", projection * view);
+        model.Draw(shader);
+        double elapsed = BenchNow() - start;
+        glFinish();
+
+        start = BenchNow();
+        mergedShader.use();
+        mergedShader.setMat4("projection", projection);
+        mergedShader.setMat4("view", view);
+        merged.Draw(mergedShader);
+        double mergedElapsed = BenchNow() - start;
+        glFinish();
+
+        if (frame >= warmup)
+        {
+            samples.push_back(elapsed * 1000.0);
+            mergedSamples.push_back(mergedElapsed * 1000.0);
+        }
+    }
+    PrintStats("Model::Draw nanosuit (CPU)", ComputeStats(samples), "us");
+    PrintStats("MergedGeometry::Draw nanosuit (CPU)", ComputeStats(mergedSamples), "us");
+
+    DestroyBenchContext(window);
+    return 0;
+}
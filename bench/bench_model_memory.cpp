@@ -0,0 +1,109 @@
+// Resident memory of loading every model under res/objects with one Mesh::CpuData policy: what the meshes
+// keep on the CPU after upload (full vertices, positions only, nothing). Prints the RSS before loading, the
+// peak while loading (VmHWM) and the steady RSS once the loads are done and the freed scratch is trimmed,
+// plus the mesh bytes MemoryTracker counts. The peak never goes down, run each policy in its own process.
+// Heap fragmentation is the share of the heap (glibc mallinfo2, mmapped chunks aside) that is free but can't be
+// given back because live blocks sit around it; the import staging lives in the loader arena (LinearArena)
+// instead of the heap, diff the numbers against an older build for the effect.
+//
+// usage: bench_model_memory [--keep all|positions|none]
+
+#include "bench_common.h"
+
+// model.h pulls in stb_image.h, compile its implementation in this translation unit.
+#define STB_IMAGE_IMPLEMENTATION
+#include <learnopengl/model.h>
+#include <learnopengl/memory_tracker.h>
+#include <learnopengl/linear_arena.h>
+
+#include <malloc.h>
+#include <cstdlib>
+#include <cstring>
+
+static const char* modelPaths[] = {
+    "../res/objects/nanosuit/nanosuit.obj",
+    "../res/objects/cyborg/cyborg.obj",
+    "../res/objects/planet/planet.obj",
+    "../res/objects/rock/rock.obj",
+};
+
+// a "VmRSS:" style line of /proc/self/status, in MB
+static double statusMegabytes(const char* field)
+{
+    FILE* file = std::fopen("/proc/self/status", "r");
+    if (file == NULL)
+        return 0.0;
+    char line[256];
+    double kilobytes = 0.0;
+    size_t length = std::strlen(field);
+    while (std::fgets(line, sizeof(line), file))
+    {
+        if (std::strncmp(line, field, length) == 0)
+        {
+            kilobytes = std::atof(line + length);
+            break;
+        }
+    }
+    std::fclose(file);
+    return kilobytes / 1024.0;
+}
+
+int main(int argc, char** argv)
+{
+    Mesh::CpuData keep = Mesh::KEEP_ALL;
+    const char* keepName = "all";
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "--keep") == 0 && std::strcmp(argv[i + 1], "all") == 0)
+            keep = Mesh::KEEP_ALL;
+        else if (std::strcmp(argv[i], "--keep") == 0 && std::strcmp(argv[i + 1], "positions") == 0)
+            keep = Mesh::KEEP_POSITIONS;
+        else if (std::strcmp(argv[i], "--keep") == 0 && std::strcmp(argv[i + 1], "none") == 0)
+            keep = Mesh::KEEP_NONE;
+        else
+        {
+            std::cout << "unknown option " << argv[i] << " " << argv[i + 1] << std::endl;
+            return -1;
+        }
+        keepName = argv[i + 1];
+    }
+
+    GLFWwindow* window = CreateBenchContext();
+    if (window == NULL)
+        return -1;
+
+    double before = statusMegabytes("VmRSS:");
+    double start = BenchNow();
+    std::vector<Model*> models;
+    unsigned int meshCount = 0;
+    for (unsigned int i = 0; i < sizeof(modelPaths) / sizeof(modelPaths[0]); i++)
+    {
+        models.push_back(new Model(modelPaths[i], false, keep));
+        meshCount += (unsigned int) models.back()->meshes.size();
+    }
+    glFinish();
+    double elapsed = BenchNow() - start;
+    // give the freed importer scratch back to the system, what is left is what the models hold
+    malloc_trim(0);
+#if __GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33)
+    struct mallinfo2 heap = mallinfo2();
+#else
+    // before glibc 2.33 only the int fields, which wrap past 2GB
+    struct mallinfo heap = mallinfo();
+#endif
+    LinearArena &arena = LinearArena::ThreadScratch();
+
+    MemoryTracker::Usage meshes = MemoryTracker::Instance().CategoryUsage(MemoryTracker::MESHES);
+    std::printf("keep %s: %u models, %u meshes loaded in %.1f ms\n", keepName, (unsigned int) models.size(), meshCount, elapsed);
+    std::printf("  rss before %.1f MB, peak %.1f MB, steady %.1f MB\n", before, statusMegabytes("VmHWM:"), statusMegabytes("VmRSS:"));
+    std::printf("  mesh cpu %.2f MB, mesh gpu %.2f MB\n", meshes.Cpu / (1024.0 * 1024.0), meshes.Gpu / (1024.0 * 1024.0));
+    std::printf("  heap %.1f MB, in use %.1f MB, free %.1f MB (%.1f%% fragmentation), mmapped %.1f MB\n", (double) heap.arena / (1024.0 * 1024.0),
+                (double) heap.uordblks / (1024.0 * 1024.0), (double) heap.fordblks / (1024.0 * 1024.0),
+                heap.arena > 0 ? 100.0 * heap.fordblks / heap.arena : 0.0, (double) heap.hblkhd / (1024.0 * 1024.0));
+    std::printf("  loader arena peak %.2f MB, kept %.2f MB\n", arena.Peak() / (1024.0 * 1024.0), arena.Capacity() / (1024.0 * 1024.0));
+
+    for (unsigned int i = 0; i < models.size(); i++)
+        delete models[i];
+    DestroyBenchContext(window);
+    return 0;
+}
@@ -0,0 +1,198 @@
+// Occlusion culling rates of OcclusionCuller on two generated scenes, after frustum culling:
+//   asteroids: a planet occluder inside a ring of rocks (like the instancing demo), seen from the ring plane
+//   indoor:    a grid of rooms with doorways, furniture boxes in every room, the camera inside one of them
+// Also times the occluder rasterization with one worker and with every hardware thread.
+
+#include "bench_common.h"
+
+#include <learnopengl/frustum_culling.h>
+#include <learnopengl/occlusion_culler.h>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <random>
+
+struct Occluder
+{
+    std::vector<glm::vec3> Positions;
+    std::vector<unsigned int> Indices;
+    glm::mat4 Model;
+};
+
+struct Scene
+{
+    const char* Name;
+    std::vector<Occluder> Occluders;
+    std::vector<glm::vec3> Mins, Maxs;
+    glm::mat4 ViewProjection;
+};
+
+// unit cube from -1 to 1, 12 triangles
+static Occluder box(const glm::vec3 &center, const glm::vec3 &extent)
+{
+    Occluder occluder;
+    for (int i = 0; i < 8; i++)
+        occluder.Positions.push_back(glm::vec3((i & 1) ? 1.0f : -1.0f, (i & 2) ? 1.0f : -1.0f, (i & 4) ? 1.0f : -1.0f));
+    unsigned int faces[6][4] = {{0, 2, 6, 4}, {1, 5, 7, 3}, {0, 4, 5, 1}, {2, 3, 7, 6}, {0, 1, 3, 2}, {4, 6, 7, 5}};
+    for (int f = 0; f < 6; f++)
+    {
+        unsigned int quad[6] = {faces[f][0], faces[f][1], faces[f][2], faces[f][0], faces[f][2], faces[f][3]};
+        occluder.Indices.insert(occluder.Indices.end(), quad, quad + 6);
+    }
+    occluder.Model = glm::scale(glm::translate(glm::mat4(1.0f), center), extent);
+    return occluder;
+}
+
+// low poly sphere standing in for the planet model
+static Occluder sphere(float radius, int rings, int segments)
+{
+    Occluder occluder;
+    for (int r = 0; r <= rings; r++)
+    {
+        float phi = glm::pi<float>() * r / rings;
+        for (int s = 0; s <= segments; s++)
+        {
+            float theta = 2.0f * glm::pi<float>() * s / segments;
+            occluder.Positions.push_back(glm::vec3(std::sin(phi) * std::cos(theta), std::cos(phi), std::sin(phi) * std::sin(theta)));
+        }
+    }
+    for (int r = 0; r < rings; r++)
+    {
+        for (int s = 0; s < segments; s++)
+        {
+            unsigned int a = r * (segments + 1) + s, b = a + segments + 1;
+            unsigned int quad[6] = {a, b, a + 1, a + 1, b, b + 1};
+            occluder.Indices.insert(occluder.Indices.end(), quad, quad + 6);
+        }
+    }
+    // the simplified mesh must stay inside the real one, shrink it a little
+    occluder.Model = glm::scale(glm::mat4(1.0f), glm::vec3(radius * 0.95f));
+    return occluder;
+}
+
+static Scene asteroidScene()
+{
+    Scene scene;
+    scene.Name = "asteroids";
+    scene.Occluders.push_back(sphere(25.0f, 12, 16));
+    std::mt19937 random(7);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    for (int i = 0; i < 100000; i++)
+    {
+        float angle = 2.0f * glm::pi<float>() * unit(random);
+        float radius = 40.0f + 60.0f * unit(random);
+        glm::vec3 center(std::cos(angle) * radius, (unit(random) - 0.5f) * 6.0f, std::sin(angle) * radius);
+        glm::vec3 extent(0.1f + 0.3f * unit(random));
+        scene.Mins.push_back(center - extent);
+        scene.Maxs.push_back(center + extent);
+    }
+    glm::mat4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 400.0f);
+    scene.ViewProjection = projection * glm::lookAt(glm::vec3(0.0f, 2.0f, 70.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    return scene;
+}
+
+static Scene indoorScene()
+{
+    Scene scene;
+    scene.Name = "indoor";
+    const int rooms = 12;
+    const float size = 10.0f, wall = 0.2f, doorway = 1.0f;
+    std::mt19937 random(11);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    for (int i = 0; i <= rooms; i++)
+    {
+        for (int j = 0; j < rooms; j++)
+        {
+            // two wall segments per room side, leaving a doorway in the middle
+            float along = j * size + size * 0.5f, offset = (size * 0.5f + doorway) * 0.5f, length = (size * 0.5f - doorway) * 0.5f;
+            for (int side = -1; side <= 1; side += 2)
+            {
+                scene.Occluders.push_back(box(glm::vec3(i * size, 1.5f, along + side * offset), glm::vec3(wall, 1.5f, length)));
+                scene.Occluders.push_back(box(glm::vec3(along + side * offset, 1.5f, i * size), glm::vec3(length, 1.5f, wall)));
+            }
+        }
+    }
+    for (int i = 0; i < rooms; i++)
+    {
+        for (int j = 0; j < rooms; j++)
+        {
+            for (int k = 0; k < 50; k++)
+            {
+                glm::vec3 center(i * size + 1.0f + 8.0f * unit(random), 0.5f * unit(random), j * size + 1.0f + 8.0f * unit(random));
+                glm::vec3 extent(0.2f + 0.3f * unit(random));
+                scene.Mins.push_back(center - extent);
+                scene.Maxs.push_back(center + extent);
+            }
+        }
+    }
+    glm::mat4 projection = glm::perspective(glm::radians(70.0f), 16.0f / 9.0f, 0.1f, 200.0f);
+    scene.ViewProjection = projection * glm::lookAt(glm::vec3(15.0f, 1.7f, 15.0f), glm::vec3(60.0f, 1.7f, 40.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    return scene;
+}
+
+static void run(const Scene &scene, OcclusionCuller &culler)
+{
+    FrustumCuller frustumCuller;
+    for (unsigned int i = 0; i < scene.Mins.size(); i++)
+        frustumCuller.Add(scene.Mins[i], scene.Maxs[i]);
+    std::vector<uint32_t> inFrustum;
+    frustumCuller.Cull(Frustum::FromMatrix(scene.ViewProjection), inFrustum);
+
+    std::vector<double> renderTimes, testTimes;
+    unsigned int visible = 0;
+    for (int frame = 0; frame < 50; frame++)
+    {
+        double start = BenchNow();
+        culler.BeginFrame(scene.ViewProjection);
+        for (unsigned int i = 0; i < scene.Occluders.size(); i++)
+            culler.AddOccluder(scene.Occluders[i].Positions, scene.Occluders[i].Indices, scene.Occluders[i].Model);
+        culler.Render();
+        renderTimes.push_back(BenchNow() - start);
+
+        start = BenchNow();
+        visible = 0;
+        for (unsigned int i = 0; i < inFrustum.size(); i++)
+        {
+            if (culler.TestBox(scene.Mins[inFrustum[i]], scene.Maxs[inFrustum[i]]))
+                visible++;
+        }
+        testTimes.push_back(BenchNow() - start);
+    }
+
+    const OcclusionStats &stats = culler.Stats();
+    std::printf("%s, %u workers: %zu instances, %zu in frustum, %u occluded (%.1f%%), %u drawn, %u occluder triangles\n",
+                scene.Name, culler.Workers(), scene.Mins.size(), inFrustum.size(), stats.Occluded,
+                100.0 * stats.Occluded / std::max(1u, stats.Tested), visible, stats.Triangles);
+    PrintStats("  rasterize + hierarchy", ComputeStats(renderTimes));
+    PrintStats("  box tests", ComputeStats(testTimes));
+}
+
+// a box straight behind a wall must be occluded, one in front of it and one peeking over it must not.
+static bool sanityCheck()
+{
+    OcclusionCuller culler(320, 192, 1);
+    glm::mat4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+    culler.BeginFrame(projection * glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f)));
+    Occluder wall = box(glm::vec3(0.0f, 0.0f, -10.0f), glm::vec3(5.0f, 2.0f, 0.1f));
+    culler.AddOccluder(wall.Positions, wall.Indices, wall.Model);
+    culler.Render();
+    bool behind = !culler.TestBox(glm::vec3(-1.0f, -1.0f, -22.0f), glm::vec3(1.0f, 1.0f, -20.0f));
+    bool front = culler.TestBox(glm::vec3(-1.0f, -1.0f, -6.0f), glm::vec3(1.0f, 1.0f, -5.0f));
+    bool above = culler.TestBox(glm::vec3(-1.0f, 3.0f, -22.0f), glm::vec3(1.0f, 6.0f, -20.0f));
+    return behind && front && above;
+}
+
+int main()
+{
+    bool sane = sanityCheck();
+    std::printf("sanity check %s\n", sane ? "passed" : "FAILED");
+    Scene scenes[] = {asteroidScene(), indoorScene()};
+    for (int s = 0; s < 2; s++)
+    {
+        OcclusionCuller single(320, 192, 1);
+        run(scenes[s], single);
+        OcclusionCuller parallel;
+        run(scenes[s], parallel);
+    }
+    return sane ? 0 : -1;
+}
@@ -0,0 +1,84 @@
+// A deferred frame described as a RenderGraph at 1920x1080: shadow map, G-buffer, SSAO, lighting, a bloom
+// chain, tonemapping and UI, plus a debug view nothing reads. Prints the compiled pass order, what got culled
+// and the transient memory saved by aliasing, then times Execute() with passes that only clear their targets.
+
+#include "bench_common.h"
+
+#include <learnopengl/render_graph.h>
+
+static void clearPass(const RenderGraph &)
+{
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+}
+
+static void buildFrame(RenderGraph &graph, int width, int height)
+{
+    RenderTextureDesc shadowDesc = {2048, 2048, GL_DEPTH_COMPONENT32F};
+    RenderTextureDesc colorDesc = {width, height, GL_RGBA8};
+    RenderTextureDesc hdrDesc = {width, height, GL_RGBA16F};
+    RenderTextureDesc depthDesc = {width, height, GL_DEPTH24_STENCIL8};
+    RenderTextureDesc halfDesc = {width / 2, height / 2, GL_RGBA16F};
+    RenderTextureDesc aoDesc = {width, height, GL_R8};
+
+    RenderGraph::Resource backbuffer = graph.ImportBackbuffer("backbuffer", width, height);
+    RenderGraph::Resource shadow = graph.CreateTexture("shadow map", shadowDesc);
+    RenderGraph::Resource albedo = graph.CreateTexture("albedo", colorDesc);
+    RenderGraph::Resource normal = graph.CreateTexture("normal", hdrDesc);
+    RenderGraph::Resource depth = graph.CreateTexture("depth", depthDesc);
+    RenderGraph::Resource ao = graph.CreateTexture("ssao", aoDesc);
+    RenderGraph::Resource aoBlurred = graph.CreateTexture("ssao blurred", aoDesc);
+    RenderGraph::Resource hdr = graph.CreateTexture("hdr", hdrDesc);
+    RenderGraph::Resource bright = graph.CreateTexture("bright", halfDesc);
+    RenderGraph::Resource blurX = graph.CreateTexture("blur x", halfDesc);
+    RenderGraph::Resource blurY = graph.CreateTexture("blur y", halfDesc);
+    RenderGraph::Resource debug = graph.CreateTexture("debug normals", colorDesc);
+
+    graph.AddPass("shadow", clearPass).Write(shadow);
+    graph.AddPass("gbuffer", clearPass).Write(albedo).Write(normal).Write(depth);
+    graph.AddPass("ssao", clearPass).Read(normal).Read(depth).Write(ao);
+    graph.AddPass("ssao blur", clearPass).Read(ao).Write(aoBlurred);
+    graph.AddPass("lighting", clearPass).Read(albedo).Read(normal).Read(depth).Read(aoBlurred).Read(shadow).Write(hdr);
+    graph.AddPass("debug view", clearPass).Read(normal).Write(debug);
+    graph.AddPass("bright pass", clearPass).Read(hdr).Write(bright);
+    graph.AddPass("blur x", clearPass).Read(bright).Write(blurX);
+    graph.AddPass("blur y", clearPass).Read(blurX).Write(blurY);
+    graph.AddPass("tonemap", clearPass).Read(hdr).Read(blurY).Write(backbuffer);
+    graph.AddPass("ui", clearPass).Write(backbuffer);
+}
+
+int main()
+{
+    const int width = 1920, height = 1080;
+    RenderGraph graph;
+    buildFrame(graph, width, height);
+    double start = BenchNow();
+    if (!graph.Compile())
+        return -1;
+    double compileTime = BenchNow() - start;
+
+    const RenderGraphStats &stats = graph.Stats();
+    std::printf("compile %.3fms, %u passes, %u culled, %u barriers\n", compileTime, stats.Passes, stats.CulledPasses, stats.Barriers);
+    std::printf("order:");
+    for (unsigned int i = 0; i < graph.Order().size(); i++)
+        std::printf(" %s%s", graph.PassName(graph.Order()[i]).c_str(), i + 1 < graph.Order().size() ? " ->" : "\n");
+    std::printf("transient targets %u -> %u textures, %.1fMB -> %.1fMB, saved %.1fMB\n", stats.TransientTextures,
+                stats.PhysicalTextures, stats.TransientBytes / 1048576.0, stats.PhysicalBytes / 1048576.0,
+                stats.SavedBytes() / 1048576.0);
+
+    GLFWwindow* window = CreateBenchContext(width, height);
+    if (window == NULL)
+        return -1;
+    std::vector<double> samples;
+    for (int frame = 0; frame < 200; frame++)
+    {
+        start = BenchNow();
+        graph.Execute();
+        samples.push_back(BenchNow() - start);
+    }
+    glFinish();
+    PrintStats("execute (cpu)", ComputeStats(samples));
+    std::printf("gl error 0x%x\n", glGetError());
+    DestroyBenchContext(window);
+    return 0;
+}
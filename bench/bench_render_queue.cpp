@@ -0,0 +1,99 @@
+// State changes per frame with and without sort keys on a scene mixing the res/objects models.
+
+#include "bench_common.h"
+
+// model.h pulls in stb_image.h, compile its implementation in this translation unit.
+#define STB_IMAGE_IMPLEMENTATION
+#include <learnopengl/model.h>
+#include <learnopengl/render_queue.h>
+#include <learnopengl/shader_library.h>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+static const char* vertexCode =
+        "#version 330 core\n"
+        "layout (location = 0) in vec3 aPos;\n"
+        "layout (location = 2) in vec2 aTexCoords;\n"
+        "out vec2 TexCoords;\n"
+        "uniform mat4 model;\n"
+        "uniform mat4 viewProjection;\n"
+        "void main() { TexCoords = aTexCoords; gl_Position = viewProjection * model * vec4(aPos, 1.0); }\n";
+
+static const char* diffuseCode =
+        "#version 330 core\n"
+        "in vec2 TexCoords;\n"
+        "out vec4 FragColor;\n"
+        "uniform sampler2D texture_diffuse1;\n"
+        "void main() { FragColor = texture(texture_diffuse1, TexCoords); }\n";
+
+static const char* specularCode =
+        "#version 330 core\n"
+        "in vec2 TexCoords;\n"
+        "out vec4 FragColor;\n"
+        "uniform sampler2D texture_diffuse1;\n"
+        "uniform sampler2D texture_specular1;\n"
+        "void main() { FragColor = texture(texture_diffuse1, TexCoords) * (0.5 + texture(texture_specular1, TexCoords)); }\n";
+
+static void printStats(const char* name, const RenderQueueStats &stats)
+{
+    std::printf("%-10s draws %6u  program binds %6u  material binds %6u  vao binds %6u  total %6u\n", name,
+                stats.Draws, stats.ProgramBinds, stats.MaterialBinds, stats.VAOBinds, stats.StateChanges());
+}
+
+int main()
+{
+    GLFWwindow* window = CreateBenchContext();
+    if (window == NULL)
+        return -1;
+
+    ShaderLibrary library;
+    int diffuseHandle = library.SubmitSource("diffuse", vertexCode, diffuseCode);
+    int specularHandle = library.SubmitSource("specular", vertexCode, specularCode);
+    Model nanosuit("../res/objects/nanosuit/nanosuit.obj");
+    Model cyborg("../res/objects/cyborg/cyborg.obj");
+    Model planet("../res/objects/planet/planet.obj");
+    Model rock("../res/objects/rock/rock.obj");
+    Shader diffuse = library.Get(diffuseHandle);
+    Shader specular = library.Get(specularHandle);
+
+    Model* models[] = {&nanosuit, &cyborg, &planet, &rock};
+    Shader* shaders[] = {&specular, &specular, &diffuse, &diffuse};
+
+    glm::vec3 viewPosition(0.0f, 10.0f, 60.0f);
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), 800.0f / 600.0f, 0.1f, 200.0f);
+    glm::mat4 view = glm::lookAt(viewPosition, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 viewProjection = projection * view;
+    diffuse.use();
+    diffuse.setMat4("viewProjection", viewProjection);
+    specular.use();
+    specular.setMat4("viewProjection", viewProjection);
+
+    RenderQueue queue;
+    queue.SetDepthRange(0.1f, 200.0f);
+    const int frames = 200;
+    for (int sorted = 0; sorted < 2; sorted++)
+    {
+        queue.SortingEnabled = sorted == 1;
+        std::vector<double> samples;
+        for (int frame = 0; frame < frames; frame++)
+        {
+            double start = BenchNow();
+            queue.Clear();
+            // a 10x10 grid cycling through the models, the way a level would place them
+            for (int i = 0; i < 100; i++)
+            {
+                glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3((i % 10 - 5) * 8.0f, 0.0f, (i / 10 - 5) * 8.0f));
+                models[i % 4]->Submit(queue, *shaders[i % 4], model, viewPosition);
+            }
+            queue.Sort();
+            queue.Submit();
+            samples.push_back(BenchNow() - start);
+            glFinish();
+        }
+        printStats(sorted ? "sorted" : "unsorted", queue.Stats());
+        PrintStats(sorted ? "queue CPU sorted" : "queue CPU unsorted", ComputeStats(samples));
+    }
+
+    DestroyBenchContext(window);
+    return 0;
+}
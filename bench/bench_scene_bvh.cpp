@@ -0,0 +1,180 @@
+// SceneBVH against a linear scan at 10k, 100k and 1M instances: build, refit after moving 10% of the
+// instances, background rebuild, and frustum/ray/sphere queries. Every query result is checked against the
+// linear scan. Pass instance counts on the command line to override the defaults.
+
+#include "bench_common.h"
+
+#include <learnopengl/scene_bvh.h>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cmath>
+#include <cstdlib>
+#include <random>
+
+static void printLine(const char* name, double bvh, double linear)
+{
+    std::printf("  %-22s bvh %10.3fms  linear %10.3fms  speedup %8.1fx\n", name, bvh, linear, linear / bvh);
+}
+
+// returns false if any query result differs from the linear scan.
+static bool run(unsigned int count)
+{
+    bool matches = true;
+    // constant density: the world grows with the instance count
+    float half = 4.0f * std::cbrt((float) count);
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> position(-half, half);
+    std::uniform_real_distribution<float> size(0.5f, 3.0f);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+    std::vector<glm::vec3> mins(count), maxs(count);
+    SceneBVH bvh;
+    for (unsigned int i = 0; i < count; i++)
+    {
+        glm::vec3 center(position(random), position(random), position(random));
+        glm::vec3 extent(size(random), size(random), size(random));
+        mins[i] = center - extent;
+        maxs[i] = center + extent;
+        bvh.Insert(mins[i], maxs[i]);
+    }
+
+    std::printf("%u instances\n", count);
+    double start = BenchNow();
+    bvh.Build();
+    std::printf("  %-22s %10.3fms  %u nodes\n", "build", BenchNow() - start, (unsigned int) bvh.Nodes().size());
+
+    // frustum: a camera in the middle of the world looking down -z, 200 units deep
+    glm::mat4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 200.0f);
+    Frustum frustum = Frustum::FromMatrix(projection * glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f)));
+    std::vector<uint32_t> result, reference;
+    start = BenchNow();
+    bvh.QueryFrustum(frustum, result);
+    double bvhTime = BenchNow() - start;
+    start = BenchNow();
+    reference.clear();
+    for (unsigned int i = 0; i < count; i++)
+    {
+        if (SceneBVH::IntersectsFrustum(frustum, mins[i], maxs[i]))
+            reference.push_back(i);
+    }
+    double linearTime = BenchNow() - start;
+    std::sort(result.begin(), result.end());
+    printLine("frustum", bvhTime, linearTime);
+    std::printf("  %-22s %u visible, %s\n", "", (unsigned int) result.size(), result == reference ? "matches" : "DIFFERS");
+    matches &= result == reference;
+
+    // rays and spheres: 1000 queries each from random points of the world
+    const int queries = 1000;
+    std::vector<glm::vec3> origins(queries), directions(queries);
+    for (int q = 0; q < queries; q++)
+    {
+        origins[q] = glm::vec3(position(random), position(random), position(random));
+        directions[q] = glm::normalize(glm::vec3(unit(random), unit(random), unit(random)) + glm::vec3(0.0f, 0.0f, 1e-3f));
+    }
+    int mismatches = 0;
+    std::vector<float> distances(queries);
+    start = BenchNow();
+    for (int q = 0; q < queries; q++)
+    {
+        SceneBVH::RayHit hit;
+        distances[q] = bvh.QueryRay(origins[q], directions[q], 1000.0f, hit) ? hit.Distance : -1.0f;
+    }
+    bvhTime = BenchNow() - start;
+    start = BenchNow();
+    for (int q = 0; q < queries; q++)
+    {
+        float closest = 1000.0f, distance;
+        bool found = false;
+        for (unsigned int i = 0; i < count; i++)
+        {
+            if (SceneBVH::IntersectsRay(origins[q], directions[q], mins[i], maxs[i], closest, distance) && distance < closest)
+            {
+                closest = distance;
+                found = true;
+            }
+        }
+        if ((found ? closest : -1.0f) != distances[q])
+            mismatches++;
+    }
+    linearTime = BenchNow() - start;
+    printLine("ray x1000", bvhTime, linearTime);
+    std::printf("  %-22s %d mismatches\n", "", mismatches);
+    matches &= mismatches == 0;
+
+    mismatches = 0;
+    std::vector<std::vector<uint32_t> > found(queries);
+    start = BenchNow();
+    for (int q = 0; q < queries; q++)
+        bvh.QuerySphere(origins[q], 20.0f, found[q]);
+    bvhTime = BenchNow() - start;
+    start = BenchNow();
+    for (int q = 0; q < queries; q++)
+    {
+        reference.clear();
+        for (unsigned int i = 0; i < count; i++)
+        {
+            if (SceneBVH::IntersectsSphere(origins[q], 20.0f, mins[i], maxs[i]))
+                reference.push_back(i);
+        }
+        std::sort(found[q].begin(), found[q].end());
+        if (found[q] != reference)
+            mismatches++;
+    }
+    linearTime = BenchNow() - start;
+    printLine("sphere x1000", bvhTime, linearTime);
+    std::printf("  %-22s %d mismatches\n", "", mismatches);
+    matches &= mismatches == 0;
+
+    // move 10% of the instances a little every frame until the tree quality triggers a rebuild
+    std::uniform_int_distribution<unsigned int> pick(0, count - 1);
+    std::vector<double> refits;
+    int frame = 0;
+    while (!bvh.Rebuilding() && frame < 1000)
+    {
+        for (unsigned int i = 0; i < count / 10; i++)
+        {
+            unsigned int id = pick(random);
+            glm::vec3 offset = glm::vec3(unit(random), unit(random), unit(random)) * 2.0f;
+            mins[id] += offset;
+            maxs[id] += offset;
+            bvh.Update(id, mins[id], maxs[id]);
+        }
+        start = BenchNow();
+        bvh.Refit();
+        refits.push_back(BenchNow() - start);
+        frame++;
+    }
+    PrintStats("  refit (10% moved)", ComputeStats(refits));
+    std::printf("  %-22s after %d frames, quality %.2f\n", "rebuild started", frame, bvh.Quality());
+    start = BenchNow();
+    while (bvh.Rebuilding())
+        bvh.Refit();
+    std::printf("  %-22s %10.3fms until swapped in, quality %.2f\n", "background rebuild", BenchNow() - start, bvh.Quality());
+
+    bvh.QueryFrustum(frustum, result);
+    reference.clear();
+    for (unsigned int i = 0; i < count; i++)
+    {
+        if (SceneBVH::IntersectsFrustum(frustum, mins[i], maxs[i]))
+            reference.push_back(i);
+    }
+    std::sort(result.begin(), result.end());
+    std::printf("  %-22s %s\n", "frustum after rebuild", result == reference ? "matches" : "DIFFERS");
+    return matches && result == reference;
+}
+
+int main(int argc, char* argv[])
+{
+    bool matches = true;
+    if (argc > 1)
+    {
+        for (int i = 1; i < argc; i++)
+            matches &= run((unsigned int) std::atoi(argv[i]));
+        return matches ? 0 : -1;
+    }
+    matches &= run(10000);
+    matches &= run(100000);
+    matches &= run(1000000);
+    return matches ? 0 : -1;
+}
@@ -0,0 +1,73 @@
+// Startup cost of compiling N programs: one at a time (what the Shader constructor does)
+// versus submitting them all to a ShaderLibrary and collecting the results afterwards.
+
+#include "bench_common.h"
+#include <learnopengl/shader_library.h>
+
+#include <string>
+
+// every program gets a unique define so the driver's shader cache can't hide the compile cost.
+static std::string makeVariant(const std::string &code, int salt)
+{
+    size_t lineEnd = code.find('\n');
+    return code.substr(0, lineEnd + 1) + "#define VARIANT_" + std::to_string(salt) + "\n" + code.substr(lineEnd + 1);
+}
+
+static std::string readFile(const char* path)
+{
+    std::ifstream file(path);
+    std::stringstream stream;
+    stream << file.rdbuf();
+    return stream.str();
+}
+
+int main()
+{
+    GLFWwindow* window = CreateBenchContext();
+    if (window == NULL)
+        return -1;
+
+    std::string vertexCode = readFile("../res/shaders/shader.vs");
+    std::string fragmentCode = readFile("../res/shaders/shader.fs");
+
+    ShaderLibrary library((GLADloadproc) glfwGetProcAddress);
+    std::cout << "GL_KHR_parallel_shader_compile: " << (library.SupportsParallelCompile() ? "yes" : "no") << std::endl;
+
+    const int counts[] = {1, 10, 100};
+    const int repetitions = 5;
+    int salt = 0;
+    for (int count : counts)
+    {
+        std::vector<double> serial, batched;
+        for (int r = 0; r < repetitions; r++)
+        {
+            // serial: wait for every program before submitting the next one.
+            double start = BenchNow();
+            for (int i = 0; i < count; i++)
+            {
+                int handle = library.SubmitSource("serial", makeVariant(vertexCode, salt).c_str(), makeVariant(fragmentCode, salt).c_str());
+                library.Get(handle);
+                salt++;
+            }
+            serial.push_back(BenchNow() - start);
+            library.Clear();
+
+            // batched: submit everything, then collect.
+            start = BenchNow();
+            for (int i = 0; i < count; i++)
+            {
+                library.SubmitSource("batched", makeVariant(vertexCode, salt).c_str(), makeVariant(fragmentCode, salt).c_str());
+                salt++;
+            }
+            library.Collect();
+            batched.push_back(BenchNow() - start);
+            library.Clear();
+        }
+        std::string name = std::to_string(count) + " programs";
+        PrintStats((name + " serial").c_str(), ComputeStats(serial));
+        PrintStats((name + " batched").c_str(), ComputeStats(batched));
+    }
+
+    DestroyBenchContext(window);
+    return 0;
+}
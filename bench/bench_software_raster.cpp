@@ -0,0 +1,181 @@
+// SoftwareRasterizer frame times on a generated scene: a wooden floor reaching past the camera (near plane
+// clipping) and a grid of textured crates with specular maps, seen from a camera circling the grid.
+// Renders with one worker and with every hardware thread, both must produce the same image.
+//
+// usage: bench_software_raster [--frames N] [--width W] [--height H] [--image frame.ppm]
+
+#include "bench_common.h"
+
+// software_rasterizer.h loads textures through stb_image, compile its implementation in this translation unit.
+#define STB_IMAGE_IMPLEMENTATION
+#include <learnopengl/software_rasterizer.h>
+
+#include <cstdlib>
+#include <cstring>
+
+struct Geometry
+{
+    std::vector<Vertex> Vertices;
+    std::vector<unsigned int> Indices;
+};
+
+static Vertex vertex(const glm::vec3 &position, const glm::vec3 &normal, const glm::vec2 &texCoords)
+{
+    Vertex v;
+    v.Position = position;
+    v.Normal = normal;
+    v.TexCoords = texCoords;
+    v.Tangent = glm::vec3(0.0f);
+    v.Bitangent = glm::vec3(0.0f);
+    return v;
+}
+
+// unit cube from -0.5 to 0.5, every face with its own vertices and the whole texture, counter clockwise outside
+static Geometry cube()
+{
+    Geometry geometry;
+    for (int axis = 0; axis < 3; axis++)
+    {
+        for (int side = -1; side <= 1; side += 2)
+        {
+            glm::vec3 normal(0.0f);
+            normal[axis] = (float) side;
+            glm::vec3 u(0.0f), v(0.0f);
+            u[(axis + 1) % 3] = 1.0f;
+            v[(axis + 2) % 3] = 1.0f;
+            if (side < 0)
+                std::swap(u, v);
+            unsigned int first = (unsigned int) geometry.Vertices.size();
+            glm::vec3 center = normal * 0.5f;
+            geometry.Vertices.push_back(vertex(center - 0.5f * u - 0.5f * v, normal, glm::vec2(0.0f, 0.0f)));
+            geometry.Vertices.push_back(vertex(center + 0.5f * u - 0.5f * v, normal, glm::vec2(1.0f, 0.0f)));
+            geometry.Vertices.push_back(vertex(center + 0.5f * u + 0.5f * v, normal, glm::vec2(1.0f, 1.0f)));
+            geometry.Vertices.push_back(vertex(center - 0.5f * u + 0.5f * v, normal, glm::vec2(0.0f, 1.0f)));
+            unsigned int quad[6] = {first, first + 1, first + 2, first, first + 2, first + 3};
+            geometry.Indices.insert(geometry.Indices.end(), quad, quad + 6);
+        }
+    }
+    return geometry;
+}
+
+// a square in the xz plane facing up, the texture repeats every unit
+static Geometry floorPlane(float size)
+{
+    Geometry geometry;
+    glm::vec3 up(0.0f, 1.0f, 0.0f);
+    geometry.Vertices.push_back(vertex(glm::vec3(-size, 0.0f, size), up, glm::vec2(0.0f, 0.0f)));
+    geometry.Vertices.push_back(vertex(glm::vec3(size, 0.0f, size), up, glm::vec2(size, 0.0f)));
+    geometry.Vertices.push_back(vertex(glm::vec3(size, 0.0f, -size), up, glm::vec2(size, size)));
+    geometry.Vertices.push_back(vertex(glm::vec3(-size, 0.0f, -size), up, glm::vec2(0.0f, size)));
+    unsigned int quad[6] = {0, 1, 2, 0, 2, 3};
+    geometry.Indices.assign(quad, quad + 6);
+    return geometry;
+}
+
+static void drawScene(SoftwareRasterizer &rasterizer, const Geometry &box, const Geometry &ground, const SoftwareMaterial &crate,
+                      const SoftwareMaterial &wood, float angle)
+{
+    glm::vec3 eye(std::sin(angle) * 12.0f, 3.0f, std::cos(angle) * 12.0f);
+    glm::mat4 view = glm::lookAt(eye, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float) rasterizer.Width() / rasterizer.Height(), 0.1f, 100.0f);
+    rasterizer.BeginFrame(glm::vec4(0.1f, 0.1f, 0.1f, 1.0f));
+    rasterizer.SetCamera(view, projection);
+    rasterizer.Draw(ground.Vertices, ground.Indices, glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, -0.5f, 0.0f)), wood);
+    for (int z = -4; z <= 4; z++)
+    {
+        for (int x = -4; x <= 4; x++)
+        {
+            glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(x * 1.6f, 0.0f, z * 1.6f));
+            model = glm::rotate(model, (x * 7 + z) * 0.3f, glm::vec3(0.0f, 1.0f, 0.0f));
+            rasterizer.Draw(box.Vertices, box.Indices, model, crate);
+        }
+    }
+    rasterizer.Render();
+}
+
+// a red square in front of a green one: the center is red whatever the draw order, the corners show the clear color.
+static bool sanityCheck()
+{
+    SoftwareRasterizer rasterizer(128, 128, 1);
+    rasterizer.Ambient = 1.0f;
+    rasterizer.LightColor = glm::vec3(0.0f);
+    Geometry square = floorPlane(1.0f);
+    glm::mat4 facing = glm::rotate(glm::mat4(1.0f), glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+    SoftwareMaterial red = {nullptr, nullptr, glm::vec3(1.0f, 0.0f, 0.0f), 0.0f, 32.0f};
+    SoftwareMaterial green = {nullptr, nullptr, glm::vec3(0.0f, 1.0f, 0.0f), 0.0f, 32.0f};
+    rasterizer.BeginFrame(glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
+    rasterizer.SetCamera(glm::lookAt(glm::vec3(0.0f, 0.0f, 5.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f)),
+                         glm::perspective(glm::radians(45.0f), 1.0f, 0.1f, 100.0f));
+    rasterizer.Draw(square.Vertices, square.Indices, glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, 1.0f)) * facing, red);
+    rasterizer.Draw(square.Vertices, square.Indices, glm::scale(facing, glm::vec3(2.0f)), green);
+    rasterizer.Render();
+    const std::vector<uint32_t> &color = rasterizer.Color();
+    uint32_t center = color[64 * rasterizer.Stride() + 64];
+    uint32_t corner = color[0];
+    return center == 0xFF0000FFu && corner == 0xFFFF0000u;
+}
+
+int main(int argc, char** argv)
+{
+    int frames = 30;
+    int width = 800, height = 600;
+    const char* image = nullptr;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "--frames") == 0)
+            frames = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--width") == 0)
+            width = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--height") == 0)
+            height = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--image") == 0)
+            image = argv[i + 1];
+        else
+        {
+            std::cout << "unknown option " << argv[i] << std::endl;
+            return -1;
+        }
+    }
+
+    if (!sanityCheck())
+    {
+        std::printf("sanity check FAILED\n");
+        return -1;
+    }
+    std::printf("sanity check passed\n");
+
+    Geometry box = cube();
+    Geometry ground = floorPlane(40.0f);
+    SoftwareRasterizer single(width, height, 1);
+    SoftwareRasterizer parallel(width, height);
+    SoftwareRasterizer* rasterizers[2] = {&single, &parallel};
+    for (int r = 0; r < 2; r++)
+    {
+        SoftwareRasterizer &rasterizer = *rasterizers[r];
+        SoftwareMaterial crate = {rasterizer.LoadTexture("../res/textures/container2.png"),
+                                  rasterizer.LoadTexture("../res/textures/container2_specular.png"), glm::vec3(1.0f), 0.5f, 32.0f};
+        SoftwareMaterial wood = {rasterizer.LoadTexture("../res/textures/wood.png"), nullptr, glm::vec3(1.0f), 0.2f, 16.0f};
+        if (crate.Diffuse == nullptr || crate.SpecularMap == nullptr || wood.Diffuse == nullptr)
+            return -1;
+
+        std::vector<double> times;
+        for (int frame = 0; frame < frames; frame++)
+        {
+            double start = BenchNow();
+            drawScene(rasterizer, box, ground, crate, wood, frame * 0.05f);
+            times.push_back(BenchNow() - start);
+        }
+        // the last frame again at a fixed angle, to compare the two rasterizers
+        drawScene(rasterizer, box, ground, crate, wood, 0.6f);
+        const SoftwareRasterStats &stats = rasterizer.Stats();
+        std::printf("%dx%d, %u workers: %u triangles (%u clipped), %u binned, %u pixels shaded\n", width, height,
+                    rasterizer.Workers(), stats.Triangles, stats.Clipped, stats.Binned, stats.Shaded);
+        PrintStats("  frame", ComputeStats(times));
+    }
+
+    bool same = single.Color() == parallel.Color();
+    std::printf("images of 1 and %u workers %s\n", parallel.Workers(), same ? "match" : "DIFFER");
+    if (image != nullptr && !parallel.WritePPM(image))
+        return -1;
+    return same ? 0 : -1;
+}
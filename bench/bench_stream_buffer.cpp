@@ -0,0 +1,215 @@
+// Per frame dynamic data through glBufferSubData against StreamBuffer, for the three streaming paths:
+//   uniform: one small uniform block per draw (5000 draws)
+//   storage: one array of 50000 matrices per frame read from an SSBO
+//   vertex:  20000 debug line vertices per frame
+// Prints CPU frame times and the stalls StreamBuffer reported.
+
+#include "bench_common.h"
+
+#include <learnopengl/shader_library.h>
+#include <learnopengl/stream_buffer.h>
+
+#include <glm/glm.hpp>
+
+#include <cstring>
+
+static const char* uniformVertex =
+        "#version 430 core\n"
+        "layout (std140, binding = 0) uniform Draw { mat4 mvp; vec4 color; };\n"
+        "out vec4 Color;\n"
+        "void main() { Color = color; gl_Position = mvp * vec4(0.0, 0.0, 0.0, 1.0); }\n";
+
+static const char* storageVertex =
+        "#version 430 core\n"
+        "layout (std430, binding = 0) readonly buffer Transforms { mat4 transforms[]; };\n"
+        "out vec4 Color;\n"
+        "void main() { Color = vec4(1.0); gl_Position = transforms[gl_VertexID] * vec4(0.0, 0.0, 0.0, 1.0); }\n";
+
+static const char* lineVertex =
+        "#version 430 core\n"
+        "layout (location = 0) in vec3 aPos;\n"
+        "layout (location = 1) in vec4 aColor;\n"
+        "out vec4 Color;\n"
+        "void main() { Color = aColor; gl_Position = vec4(aPos, 1.0); }\n";
+
+static const char* fragment =
+        "#version 430 core\n"
+        "in vec4 Color;\n"
+        "out vec4 FragColor;\n"
+        "void main() { FragColor = Color; }\n";
+
+struct DrawBlock
+{
+    glm::mat4 mvp;
+    glm::vec4 color;
+};
+
+struct LineVertex
+{
+    glm::vec3 position;
+    glm::vec4 color;
+};
+
+static const int FRAMES = 100;
+static const int UNIFORM_DRAWS = 5000;
+static const int STORAGE_MATRICES = 50000;
+static const int LINE_VERTICES = 20000;
+
+static void frame(GLFWwindow* window, std::vector<double> &samples, double start)
+{
+    glfwSwapBuffers(window);
+    samples.push_back(BenchNow() - start);
+}
+
+static void report(const char* name, const std::vector<double> &subData, const std::vector<double> &stream, const StreamBuffer &buffer)
+{
+    std::string label(name);
+    PrintStats((label + " glBufferSubData").c_str(), ComputeStats(subData));
+    PrintStats((label + " StreamBuffer").c_str(), ComputeStats(stream));
+    const StreamBufferStats &stats = buffer.Stats();
+    std::printf("%-40s %u frames, %u stalls (%.3fms), peak %.1fKB per frame, %u overflows\n", "", stats.Frames, stats.Stalls,
+                stats.StallMilliseconds, stats.PeakBytes / 1024.0, stats.Overflows);
+}
+
+int main()
+{
+    GLFWwindow* window = CreateBenchContext(256, 256);
+    if (window == NULL)
+        return -1;
+
+    ShaderLibrary library;
+    int uniformHandle = library.SubmitSource("uniform", uniformVertex, fragment);
+    int storageHandle = library.SubmitSource("storage", storageVertex, fragment);
+    int lineHandle = library.SubmitSource("lines", lineVertex, fragment);
+    Shader uniformShader = library.Get(uniformHandle);
+    Shader storageShader = library.Get(storageHandle);
+    Shader lineShader = library.Get(lineHandle);
+
+    unsigned int emptyVAO;
+    glCreateVertexArrays(1, &emptyVAO);
+    unsigned int lineVAO;
+    glCreateVertexArrays(1, &lineVAO);
+    glEnableVertexArrayAttrib(lineVAO, 0);
+    glVertexArrayAttribFormat(lineVAO, 0, 3, GL_FLOAT, GL_FALSE, offsetof(LineVertex, position));
+    glVertexArrayAttribBinding(lineVAO, 0, 0);
+    glEnableVertexArrayAttrib(lineVAO, 1);
+    glVertexArrayAttribFormat(lineVAO, 1, 4, GL_FLOAT, GL_FALSE, offsetof(LineVertex, color));
+    glVertexArrayAttribBinding(lineVAO, 1, 0);
+
+    std::vector<DrawBlock> blocks(UNIFORM_DRAWS);
+    std::vector<glm::mat4> matrices(STORAGE_MATRICES);
+    std::vector<LineVertex> lines(LINE_VERTICES);
+    for (int i = 0; i < UNIFORM_DRAWS; i++)
+        blocks[i].color = glm::vec4(1.0f);
+    for (int i = 0; i < LINE_VERTICES; i++)
+        lines[i].color = glm::vec4(1.0f);
+
+    // uniform blocks, one per draw
+    {
+        unsigned int ubo;
+        glCreateBuffers(1, &ubo);
+        glNamedBufferData(ubo, sizeof(DrawBlock), NULL, GL_DYNAMIC_DRAW);
+        StreamBuffer stream(UNIFORM_DRAWS * 256);
+        std::vector<double> subData, streamed;
+        uniformShader.use();
+        glBindVertexArray(emptyVAO);
+        for (int f = 0; f < FRAMES; f++)
+        {
+            double start = BenchNow();
+            glBindBufferBase(GL_UNIFORM_BUFFER, 0, ubo);
+            for (int i = 0; i < UNIFORM_DRAWS; i++)
+            {
+                blocks[i].mvp[3].x = (float) f;
+                glNamedBufferSubData(ubo, 0, sizeof(DrawBlock), &blocks[i]);
+                glDrawArrays(GL_POINTS, 0, 1);
+            }
+            frame(window, subData, start);
+        }
+        for (int f = 0; f < FRAMES; f++)
+        {
+            double start = BenchNow();
+            stream.BeginFrame();
+            for (int i = 0; i < UNIFORM_DRAWS; i++)
+            {
+                blocks[i].mvp[3].x = (float) f;
+                StreamBuffer::BindUniform(0, stream.Upload(&blocks[i], sizeof(DrawBlock), stream.UniformAlignment()));
+                glDrawArrays(GL_POINTS, 0, 1);
+            }
+            stream.EndFrame();
+            frame(window, streamed, start);
+        }
+        report("uniform", subData, streamed, stream);
+        glDeleteBuffers(1, &ubo);
+    }
+
+    // one storage buffer array per frame
+    {
+        unsigned int ssbo;
+        glCreateBuffers(1, &ssbo);
+        glNamedBufferData(ssbo, STORAGE_MATRICES * sizeof(glm::mat4), NULL, GL_DYNAMIC_DRAW);
+        StreamBuffer stream(STORAGE_MATRICES * sizeof(glm::mat4));
+        std::vector<double> subData, streamed;
+        storageShader.use();
+        glBindVertexArray(emptyVAO);
+        for (int f = 0; f < FRAMES; f++)
+        {
+            double start = BenchNow();
+            matrices[f % STORAGE_MATRICES][3].x = (float) f;
+            glNamedBufferSubData(ssbo, 0, STORAGE_MATRICES * sizeof(glm::mat4), matrices.data());
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, ssbo);
+            glDrawArrays(GL_POINTS, 0, STORAGE_MATRICES);
+            frame(window, subData, start);
+        }
+        for (int f = 0; f < FRAMES; f++)
+        {
+            double start = BenchNow();
+            stream.BeginFrame();
+            matrices[f % STORAGE_MATRICES][3].x = (float) f;
+            StreamAllocation allocation = stream.AllocateStorage(STORAGE_MATRICES * sizeof(glm::mat4));
+            std::memcpy(allocation.Data, matrices.data(), STORAGE_MATRICES * sizeof(glm::mat4));
+            StreamBuffer::BindStorage(0, allocation);
+            glDrawArrays(GL_POINTS, 0, STORAGE_MATRICES);
+            stream.EndFrame();
+            frame(window, streamed, start);
+        }
+        report("storage", subData, streamed, stream);
+        glDeleteBuffers(1, &ssbo);
+    }
+
+    // debug line vertices
+    {
+        unsigned int vbo;
+        glCreateBuffers(1, &vbo);
+        glNamedBufferData(vbo, LINE_VERTICES * sizeof(LineVertex), NULL, GL_DYNAMIC_DRAW);
+        StreamBuffer stream(LINE_VERTICES * sizeof(LineVertex));
+        std::vector<double> subData, streamed;
+        lineShader.use();
+        glBindVertexArray(lineVAO);
+        for (int f = 0; f < FRAMES; f++)
+        {
+            double start = BenchNow();
+            lines[f % LINE_VERTICES].position.x = (float) f;
+            glNamedBufferSubData(vbo, 0, LINE_VERTICES * sizeof(LineVertex), lines.data());
+            glVertexArrayVertexBuffer(lineVAO, 0, vbo, 0, sizeof(LineVertex));
+            glDrawArrays(GL_LINES, 0, LINE_VERTICES);
+            frame(window, subData, start);
+        }
+        for (int f = 0; f < FRAMES; f++)
+        {
+            double start = BenchNow();
+            stream.BeginFrame();
+            lines[f % LINE_VERTICES].position.x = (float) f;
+            StreamAllocation allocation = stream.Upload(lines.data(), LINE_VERTICES * sizeof(LineVertex), sizeof(LineVertex));
+            glVertexArrayVertexBuffer(lineVAO, 0, allocation.Buffer, allocation.Offset, sizeof(LineVertex));
+            glDrawArrays(GL_LINES, 0, LINE_VERTICES);
+            stream.EndFrame();
+            frame(window, streamed, start);
+        }
+        report("vertex", subData, streamed, stream);
+        glDeleteBuffers(1, &vbo);
+    }
+
+    std::printf("gl error 0x%x\n", glGetError());
+    DestroyBenchContext(window);
+    return 0;
+}
@@ -0,0 +1,116 @@
+#ifndef ALLOCATION_COUNTER_H
+#define ALLOCATION_COUNTER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+// Counts the calls to the global operator new, to check that steady state frames don't touch the heap.
+// One translation unit of an executable defines ALLOCATION_COUNTER_IMPLEMENTATION before including this header,
+// which replaces the global operator new/delete with counting versions (like STB_IMAGE_IMPLEMENTATION).
+//
+// What goes through operator new is seen: our code and the standard containers. Heaps of our own that sit on
+// malloc report to Record() themselves (ImGui's, see GUIManager); malloc calls of C libraries and the GL driver
+// are not counted. Nothing is counted outside Enable(true)/Enable(false), the hook itself is one relaxed atomic
+// load per allocation then.
+class AllocationCounter
+{
+public:
+    struct Counts
+    {
+        uint64_t Allocations;
+        uint64_t Bytes;
+    };
+
+    static void Enable(bool enable)
+    {
+        state().Enabled.store(enable, std::memory_order_relaxed);
+    }
+
+    static void Reset()
+    {
+        state().Allocations.store(0);
+        state().Bytes.store(0);
+    }
+
+    static Counts Read()
+    {
+        Counts counts = {state().Allocations.load(), state().Bytes.load()};
+        return counts;
+    }
+
+    // called by the replaced operator new and by allocators that bypass it.
+    static void Record(size_t size)
+    {
+        State &counters = state();
+        if (!counters.Enabled.load(std::memory_order_relaxed))
+            return;
+        counters.Allocations.fetch_add(1, std::memory_order_relaxed);
+        counters.Bytes.fetch_add(size, std::memory_order_relaxed);
+    }
+
+private:
+    struct State
+    {
+        std::atomic<bool> Enabled;
+        std::atomic<uint64_t> Allocations;
+        std::atomic<uint64_t> Bytes;
+    };
+
+    // constant initialized, so it is usable from allocations made during static initialization
+    static State &state()
+    {
+        static State counters = {{false}, {0}, {0}};
+        return counters;
+    }
+};
+
+#ifdef ALLOCATION_COUNTER_IMPLEMENTATION
+void* operator new(size_t size)
+{
+    AllocationCounter::Record(size);
+    void* pointer = std::malloc(size > 0 ? size : 1);
+    if (pointer == nullptr)
+        throw std::bad_alloc();
+    return pointer;
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t &) noexcept
+{
+    AllocationCounter::Record(size);
+    return std::malloc(size > 0 ? size : 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t &) noexcept
+{
+    return operator new(size, std::nothrow);
+}
+
+void operator delete(void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, size_t) noexcept
+{
+    std::free(pointer);
+}
+#endif
+#endif
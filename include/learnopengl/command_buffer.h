@@ -0,0 +1,279 @@
+#ifndef COMMAND_BUFFER_H
+#define COMMAND_BUFFER_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <learnopengl/mesh.h>
+#include <learnopengl/render_queue.h>
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// What a replay issued and what it skipped because it was already current.
+struct CommandReplayStats
+{
+    unsigned int Commands;
+    unsigned int Draws;
+    unsigned int ProgramBinds;
+    unsigned int MaterialBinds;
+    unsigned int VAOBinds;
+    unsigned int SkippedBinds;
+};
+
+// A linear list of draw commands recorded without touching GL, so any thread can fill one. Commands are
+// packed back to back in a byte array (a small header then the payload); Reset() keeps the memory, so once a
+// buffer has seen its largest frame, recording never allocates again.
+//
+// Recording doesn't resolve anything through GL: programs, uniform locations and MaterialBindings
+// (Mesh::GetBinding) must have been resolved on the GL thread beforehand, workers only copy them.
+//
+// Replay(), on the GL thread, walks one or more buffers in order and issues the calls, skipping binds of the
+// program/material/VAO that is already current.
+class CommandBuffer
+{
+public:
+    enum Type
+    {
+        BindProgramCommand,
+        BindMaterialCommand,
+        BindVertexArrayCommand,
+        SetMat4Command,
+        SetVec4Command,
+        DrawElementsCommand
+    };
+
+    CommandBuffer() : commands(0), used(0)
+    {
+    }
+
+    // forgets the commands, keeps the memory.
+    void Reset()
+    {
+        used = 0;
+        commands = 0;
+    }
+
+    void Reserve(size_t bytes)
+    {
+        if (data.size() < bytes)
+            data.resize(bytes);
+    }
+
+    void BindProgram(unsigned int program)
+    {
+        write(BindProgramCommand, &program, sizeof(program));
+    }
+
+    // copies the texture units and names, the binding itself doesn't need to outlive the recording.
+    void BindMaterial(const MaterialBinding &material)
+    {
+        uint32_t count = material.count;
+        char* payload = begin(BindMaterialCommand, sizeof(uint32_t) + 2 * count * sizeof(GLuint));
+        std::memcpy(payload, &count, sizeof(count));
+        std::memcpy(payload + sizeof(count), material.units, count * sizeof(GLuint));
+        std::memcpy(payload + sizeof(count) + count * sizeof(GLuint), material.textures, count * sizeof(GLuint));
+    }
+
+    void BindVertexArray(unsigned int vao)
+    {
+        write(BindVertexArrayCommand, &vao, sizeof(vao));
+    }
+
+    void SetMat4(GLint location, const glm::mat4 &value)
+    {
+        char* payload = begin(SetMat4Command, sizeof(GLint) + sizeof(glm::mat4));
+        std::memcpy(payload, &location, sizeof(location));
+        std::memcpy(payload + sizeof(location), &value[0][0], sizeof(glm::mat4));
+    }
+
+    void SetVec4(GLint location, const glm::vec4 &value)
+    {
+        char* payload = begin(SetVec4Command, sizeof(GLint) + sizeof(glm::vec4));
+        std::memcpy(payload, &location, sizeof(location));
+        std::memcpy(payload + sizeof(location), &value[0], sizeof(glm::vec4));
+    }
+
+    // indexed triangles from the bound VAO.
+    void DrawElements(unsigned int count, unsigned int firstIndex = 0, int baseVertex = 0, unsigned int instances = 1)
+    {
+        DrawArgs args = {count, firstIndex, baseVertex, instances};
+        write(DrawElementsCommand, &args, sizeof(args));
+    }
+
+    // everything a render queue packet needs: program, material, VAO, model matrix, draw.
+    void Record(const DrawPacket &packet, GLint modelLocation)
+    {
+        BindProgram(packet.Program);
+        if (packet.Material != nullptr)
+            BindMaterial(*packet.Material);
+        BindVertexArray(packet.VAO);
+        if (modelLocation >= 0)
+            SetMat4(modelLocation, packet.Model);
+        DrawElements(packet.Count, packet.FirstIndex);
+    }
+
+    unsigned int Commands() const
+    {
+        return commands;
+    }
+
+    size_t Size() const
+    {
+        return used;
+    }
+
+    size_t Capacity() const
+    {
+        return data.size();
+    }
+
+    // issues the commands of buffers[0..count) in order. stats may be null.
+    static void Replay(const CommandBuffer* const* buffers, unsigned int count, CommandReplayStats* stats = nullptr)
+    {
+        CommandReplayStats local;
+        std::memset(&local, 0, sizeof(local));
+        // nothing is known to be bound when the replay starts
+        unsigned int program = ~0u, vao = ~0u;
+        // the material last bound, compared by content
+        const char* material = nullptr;
+        uint32_t materialSize = 0;
+
+        for (unsigned int b = 0; b < count; b++)
+        {
+            const char* cursor = buffers[b]->data.data();
+            const char* end = cursor + buffers[b]->used;
+            while (cursor < end)
+            {
+                Header header;
+                std::memcpy(&header, cursor, sizeof(header));
+                const char* payload = cursor + sizeof(Header);
+                cursor += header.Size;
+                local.Commands++;
+                switch (header.Type)
+                {
+                    case BindProgramCommand:
+                    {
+                        unsigned int id;
+                        std::memcpy(&id, payload, sizeof(id));
+                        if (id == program)
+                        {
+                            local.SkippedBinds++;
+                            break;
+                        }
+                        glUseProgram(id);
+                        program = id;
+                        local.ProgramBinds++;
+                        break;
+                    }
+                    case BindMaterialCommand:
+                    {
+                        uint32_t size = header.Size - sizeof(Header);
+                        if (material != nullptr && size == materialSize && std::memcmp(material, payload, size) == 0)
+                        {
+                            local.SkippedBinds++;
+                            break;
+                        }
+                        uint32_t textures;
+                        std::memcpy(&textures, payload, sizeof(textures));
+                        for (uint32_t t = 0; t < textures; t++)
+                        {
+                            GLuint unit, texture;
+                            std::memcpy(&unit, payload + sizeof(uint32_t) + t * sizeof(GLuint), sizeof(GLuint));
+                            std::memcpy(&texture, payload + sizeof(uint32_t) + (textures + t) * sizeof(GLuint), sizeof(GLuint));
+                            glBindTextureUnit(unit, texture);
+                        }
+                        material = payload;
+                        materialSize = size;
+                        local.MaterialBinds++;
+                        break;
+                    }
+                    case BindVertexArrayCommand:
+                    {
+                        unsigned int id;
+                        std::memcpy(&id, payload, sizeof(id));
+                        if (id == vao)
+                        {
+                            local.SkippedBinds++;
+                            break;
+                        }
+                        glBindVertexArray(id);
+                        vao = id;
+                        local.VAOBinds++;
+                        break;
+                    }
+                    case SetMat4Command:
+                    {
+                        GLint location;
+                        glm::mat4 value;
+                        std::memcpy(&location, payload, sizeof(location));
+                        std::memcpy(&value[0][0], payload + sizeof(location), sizeof(value));
+                        glUniformMatrix4fv(location, 1, GL_FALSE, &value[0][0]);
+                        break;
+                    }
+                    case SetVec4Command:
+                    {
+                        GLint location;
+                        glm::vec4 value;
+                        std::memcpy(&location, payload, sizeof(location));
+                        std::memcpy(&value[0], payload + sizeof(location), sizeof(value));
+                        glUniform4fv(location, 1, &value[0]);
+                        break;
+                    }
+                    case DrawElementsCommand:
+                    {
+                        DrawArgs args;
+                        std::memcpy(&args, payload, sizeof(args));
+                        glDrawElementsInstancedBaseVertex(GL_TRIANGLES, args.Count, GL_UNSIGNED_INT,
+                                                          (void*) (sizeof(unsigned int) * args.FirstIndex), args.Instances, args.BaseVertex);
+                        local.Draws++;
+                        break;
+                    }
+                }
+            }
+        }
+        if (stats != nullptr)
+            *stats = local;
+    }
+
+private:
+    struct Header
+    {
+        uint16_t Type;
+        uint16_t Size;      // header included
+    };
+
+    struct DrawArgs
+    {
+        unsigned int Count;
+        unsigned int FirstIndex;
+        int BaseVertex;
+        unsigned int Instances;
+    };
+
+    std::vector<char> data;
+    unsigned int commands;
+    size_t used;
+
+    // reserves a command of payloadSize bytes and returns where its payload goes.
+    char* begin(Type type, size_t payloadSize)
+    {
+        // 4 byte aligned so headers never straddle odd offsets
+        size_t size = (sizeof(Header) + payloadSize + 3) & ~(size_t) 3;
+        if (used + size > data.size())
+            data.resize(data.size() * 2 > used + size ? data.size() * 2 : used + size + 4096);
+        Header header = {(uint16_t) type, (uint16_t) size};
+        std::memcpy(&data[used], &header, sizeof(header));
+        char* payload = &data[used + sizeof(Header)];
+        used += size;
+        commands++;
+        return payload;
+    }
+
+    void write(Type type, const void* payload, size_t size)
+    {
+        std::memcpy(begin(type, size), payload, size);
+    }
+};
+#endif
@@ -0,0 +1,326 @@
+#ifndef CPU_PROFILER_H
+#define CPU_PROFILER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// CPU profiling zones. Release builds (NDEBUG) compile them out unless CPU_PROFILER_ENABLED is defined to 1.
+#ifndef CPU_PROFILER_ENABLED
+#ifdef NDEBUG
+#define CPU_PROFILER_ENABLED 0
+#else
+#define CPU_PROFILER_ENABLED 1
+#endif
+#endif
+
+// zones read the time stamp counter where there is one (an invariant TSC on any recent x86), it is about
+// twice as cheap as steady_clock. Ticks become nanoseconds only when the events are read.
+#if defined(_M_X64) || defined(__x86_64__)
+#define CPU_PROFILER_RDTSC 1
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#else
+#define CPU_PROFILER_RDTSC 0
+#endif
+
+#define CPU_PROFILER_CONCAT_INNER(a, b) a##b
+#define CPU_PROFILER_CONCAT(a, b) CPU_PROFILER_CONCAT_INNER(a, b)
+
+#if CPU_PROFILER_ENABLED
+// times the rest of the enclosing block, name must be a string literal.
+#define CPU_PROFILE_ZONE(name) CpuZone CPU_PROFILER_CONCAT(cpuZone, __LINE__)(name)
+// names the calling thread in traces and in the flame view.
+#define CPU_PROFILE_THREAD(name) CpuProfiler::Instance().NameThread(name)
+// marks the start of a frame (on the render thread).
+#define CPU_PROFILE_FRAME() CpuProfiler::Instance().MarkFrame()
+#else
+#define CPU_PROFILE_ZONE(name) ((void) 0)
+#define CPU_PROFILE_THREAD(name) ((void) 0)
+#define CPU_PROFILE_FRAME() ((void) 0)
+#endif
+
+// A closed zone. Begin/End are nanoseconds since the profiler started once read through Collect().
+struct CpuZoneEvent
+{
+    const char* Name;
+    uint64_t Begin;
+    uint64_t End;
+    uint32_t Depth;
+    uint32_t Thread;    // index into CpuProfiler::ThreadName()
+};
+
+// Zone recorder. Every thread writes into its own ring of ThreadBuffer::Capacity events, with no lock and
+// no allocation: a zone is two clock reads and a few stores. Readers (trace export, the flame view) copy a ring
+// while it is being written. Every slot is a small seqlock: the writer makes its sequence odd, stores the fields
+// (release/acquire atomics, plain moves on x86) and publishes the event number; a reader keeps a copy only if
+// the sequence was the expected one before and after reading the fields, so a slot being overwritten is skipped.
+class CpuProfiler
+{
+public:
+    struct Slot
+    {
+        std::atomic<uint64_t> Sequence;     // 2 * (i + 1) once event i is complete, odd while it is written
+        std::atomic<const char*> Name;
+        std::atomic<uint64_t> Begin;
+        std::atomic<uint64_t> End;
+        std::atomic<uint32_t> Depth;
+    };
+
+    struct ThreadBuffer
+    {
+        enum
+        {
+            Capacity = 16384
+        };
+
+        Slot Events[Capacity];
+        std::atomic<uint64_t> Head;     // events written so far, Events[i % Capacity] holds event i
+        uint32_t Depth;                 // zones currently open on the thread, only touched by the thread
+        uint32_t Index;
+        char Name[32];                  // guarded by the profiler mutex
+    };
+
+    static CpuProfiler &Instance()
+    {
+        static CpuProfiler profiler;
+        return profiler;
+    }
+
+    // raw timestamp, what zones record.
+    static uint64_t Ticks()
+    {
+#if CPU_PROFILER_RDTSC
+        return __rdtsc();
+#else
+        return (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    // nanoseconds since the profiler started.
+    uint64_t Now()
+    {
+        return ToNanoseconds(Ticks());
+    }
+
+    // converts a Ticks() value to nanoseconds since the profiler started.
+    uint64_t ToNanoseconds(uint64_t ticks)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        calibrate();
+        return toNanoseconds(ticks);
+    }
+
+    // the calling thread's ring, registered on first use.
+    ThreadBuffer &Buffer()
+    {
+        static thread_local ThreadBuffer* buffer = nullptr;
+        if (buffer == nullptr)
+            buffer = registerThread();
+        return *buffer;
+    }
+
+    void NameThread(const char* name)
+    {
+        ThreadBuffer &buffer = Buffer();
+        std::lock_guard<std::mutex> lock(mutex);
+        std::snprintf(buffer.Name, sizeof(buffer.Name), "%s", name);
+    }
+
+    void Record(ThreadBuffer &buffer, const char* name, uint64_t begin, uint64_t end, uint32_t depth)
+    {
+        uint64_t head = buffer.Head.load(std::memory_order_relaxed);
+        Slot &slot = buffer.Events[head % ThreadBuffer::Capacity];
+        // a reader that sees any of the new fields also sees the odd sequence
+        slot.Sequence.store(2 * head + 1, std::memory_order_relaxed);
+        slot.Name.store(name, std::memory_order_release);
+        slot.Begin.store(begin, std::memory_order_release);
+        slot.End.store(end, std::memory_order_release);
+        slot.Depth.store(depth, std::memory_order_release);
+        slot.Sequence.store(2 * head + 2, std::memory_order_release);
+        buffer.Head.store(head + 1, std::memory_order_release);
+    }
+
+    void MarkFrame()
+    {
+        uint64_t now = Ticks();
+        std::lock_guard<std::mutex> lock(mutex);
+        frames[frameCount % FrameHistory] = now;
+        frameCount++;
+    }
+
+    // start and end of the last completed frame, false before two frames were marked.
+    bool LastFrame(uint64_t &begin, uint64_t &end)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (frameCount < 2)
+            return false;
+        calibrate();
+        begin = toNanoseconds(frames[(frameCount - 2) % FrameHistory]);
+        end = toNanoseconds(frames[(frameCount - 1) % FrameHistory]);
+        return true;
+    }
+
+    // appends the events of every thread that overlap [begin, end) (nanoseconds) to out.
+    void Collect(uint64_t begin, uint64_t end, std::vector<CpuZoneEvent> &out)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        calibrate();
+        for (unsigned int t = 0; t < threads.size(); t++)
+        {
+            ThreadBuffer &buffer = *threads[t];
+            uint64_t head = buffer.Head.load(std::memory_order_acquire);
+            uint64_t first = head > ThreadBuffer::Capacity ? head - ThreadBuffer::Capacity : 0;
+            for (uint64_t i = first; i < head; i++)
+            {
+                // events the writer overwrote meanwhile are dropped
+                const Slot &slot = buffer.Events[i % ThreadBuffer::Capacity];
+                if (slot.Sequence.load(std::memory_order_acquire) != 2 * i + 2)
+                    continue;
+                CpuZoneEvent event;
+                event.Name = slot.Name.load(std::memory_order_acquire);
+                event.Begin = slot.Begin.load(std::memory_order_acquire);
+                event.End = slot.End.load(std::memory_order_acquire);
+                event.Depth = slot.Depth.load(std::memory_order_acquire);
+                event.Thread = buffer.Index;
+                if (slot.Sequence.load(std::memory_order_relaxed) != 2 * i + 2)
+                    continue;
+                event.Begin = toNanoseconds(event.Begin);
+                event.End = toNanoseconds(event.End);
+                if (event.End >= begin && event.Begin < end)
+                    out.push_back(event);
+            }
+        }
+    }
+
+    unsigned int Threads()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return (unsigned int) threads.size();
+    }
+
+    std::string ThreadName(unsigned int index)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return index < threads.size() ? threads[index]->Name : "";
+    }
+
+    // writes every event still in the rings as Chrome trace-event JSON (chrome://tracing, Perfetto).
+    bool WriteChromeTrace(const char* path)
+    {
+        std::vector<CpuZoneEvent> events;
+        Collect(0, UINT64_MAX, events);
+        FILE* file = std::fopen(path, "w");
+        if (file == nullptr)
+        {
+            std::cout << "ERROR::CPU_PROFILER::FAILED_TO_WRITE " << path << std::endl;
+            return false;
+        }
+        std::fprintf(file, "{\"traceEvents\": [\n");
+        unsigned int threadCount = Threads();
+        for (unsigned int t = 0; t < threadCount; t++)
+        {
+            std::fprintf(file, "{\"ph\": \"M\", \"name\": \"thread_name\", \"pid\": 1, \"tid\": %u, \"args\": {\"name\": \"%s\"}},\n", t,
+                         ThreadName(t).c_str());
+        }
+        for (size_t i = 0; i < events.size(); i++)
+        {
+            const CpuZoneEvent &event = events[i];
+            std::fprintf(file, "{\"ph\": \"X\", \"name\": \"%s\", \"pid\": 1, \"tid\": %u, \"ts\": %.3f, \"dur\": %.3f}%s\n", event.Name,
+                         event.Thread, event.Begin / 1000.0, (event.End - event.Begin) / 1000.0, i + 1 < events.size() ? "," : "");
+        }
+        std::fprintf(file, "]}\n");
+        std::fclose(file);
+        return true;
+    }
+
+private:
+    enum
+    {
+        FrameHistory = 8
+    };
+
+    std::chrono::steady_clock::time_point epoch;
+    uint64_t epochTicks;
+    double nanosecondsPerTick;
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> threads;
+    uint64_t frames[FrameHistory];
+    uint64_t frameCount;
+
+    CpuProfiler() : epoch(std::chrono::steady_clock::now()), epochTicks(Ticks()), nanosecondsPerTick(1.0), frameCount(0)
+    {
+    }
+
+    // measures the tick rate against steady_clock over the whole run so far.
+    void calibrate()
+    {
+#if CPU_PROFILER_RDTSC
+        double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - epoch).count();
+        uint64_t ticks = Ticks() - epochTicks;
+        if (ticks > 0)
+            nanosecondsPerTick = elapsed / ticks;
+#endif
+    }
+
+    uint64_t toNanoseconds(uint64_t ticks) const
+    {
+        return ticks > epochTicks ? (uint64_t) ((ticks - epochTicks) * nanosecondsPerTick) : 0;
+    }
+
+    ThreadBuffer* registerThread()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        // buffers stay alive with the profiler, so events of finished threads can still be exported
+        threads.push_back(std::unique_ptr<ThreadBuffer>(new ThreadBuffer()));
+        ThreadBuffer* buffer = threads.back().get();
+        for (unsigned int i = 0; i < ThreadBuffer::Capacity; i++)
+            buffer->Events[i].Sequence.store(0, std::memory_order_relaxed);
+        buffer->Head.store(0);
+        buffer->Depth = 0;
+        buffer->Index = (uint32_t) threads.size() - 1;
+        std::snprintf(buffer->Name, sizeof(buffer->Name), "thread %u", buffer->Index);
+        return buffer;
+    }
+
+    CpuProfiler(const CpuProfiler &);
+    CpuProfiler &operator=(const CpuProfiler &);
+};
+
+// records the time between construction and destruction as one zone of the calling thread.
+class CpuZone
+{
+public:
+    explicit CpuZone(const char* name) : name(name), buffer(CpuProfiler::Instance().Buffer())
+    {
+        depth = buffer.Depth++;
+        begin = CpuProfiler::Ticks();
+    }
+
+    ~CpuZone()
+    {
+        uint64_t end = CpuProfiler::Ticks();
+        buffer.Depth--;
+        CpuProfiler::Instance().Record(buffer, name, begin, end, depth);
+    }
+
+private:
+    const char* name;
+    CpuProfiler::ThreadBuffer &buffer;
+    uint64_t begin;
+    uint32_t depth;
+
+    CpuZone(const CpuZone &);
+    CpuZone &operator=(const CpuZone &);
+};
+#endif
@@ -0,0 +1,130 @@
+#ifndef FIXED_TIMESTEP_H
+#define FIXED_TIMESTEP_H
+
+// Measured over the last full second: how often the simulation ticked and how often a frame was rendered.
+struct FixedTimestepStats
+{
+    double SimulationRate;      // ticks per second
+    double RenderRate;          // frames per second
+    double FrameMilliseconds;   // average frame time
+    unsigned int Ticks;         // total ticks so far
+    unsigned int Frames;        // total frames so far
+    unsigned int DroppedTicks;  // ticks skipped because a frame took too long
+};
+
+// Frame loop clock running the simulation at a fixed rate whatever the render rate is. Every frame:
+//
+//     timestep.BeginFrame(glfwGetTime());
+//     while (timestep.Tick())
+//     {
+//         previous = current;
+//         simulate(current, timestep.TickSeconds);   // sample input here, once per tick
+//     }
+//     render(interpolate(previous, current, timestep.Alpha()));
+//     timestep.EndFrame(glfwGetTime());
+//
+// BeginFrame() adds the elapsed time to an accumulator, Tick() consumes it TickSeconds at a time, what is left
+// (Alpha(), in [0, 1)) is how far the render time is between the last two simulation states. A frame never runs
+// more than MaxTicksPerFrame ticks, after a long stall the rest is dropped instead of trying to catch up.
+//
+// The timestep doesn't pace frames, rendering runs at whatever rate the loop (FramePacer) allows.
+class FixedTimestep
+{
+public:
+    double TickSeconds;
+    unsigned int MaxTicksPerFrame;
+
+    explicit FixedTimestep(double tickRate = 60.0, unsigned int maxTicksPerFrame = 8)
+        : TickSeconds(1.0 / tickRate), MaxTicksPerFrame(maxTicksPerFrame), accumulator(0.0), lastTime(-1.0),
+          pending(0), windowStart(-1.0), windowTicks(0), windowFrames(0), updated(false)
+    {
+        stats.SimulationRate = 0.0;
+        stats.RenderRate = 0.0;
+        stats.FrameMilliseconds = 0.0;
+        stats.Ticks = 0;
+        stats.Frames = 0;
+        stats.DroppedTicks = 0;
+    }
+
+    // now in seconds, from any monotonic clock (glfwGetTime()).
+    void BeginFrame(double now)
+    {
+        if (lastTime < 0.0)
+        {
+            // the first frame shows the initial state
+            lastTime = now;
+            windowStart = now;
+        }
+        accumulator += now - lastTime;
+        lastTime = now;
+
+        pending = (unsigned int) (accumulator / TickSeconds);
+        if (pending > MaxTicksPerFrame)
+        {
+            stats.DroppedTicks += pending - MaxTicksPerFrame;
+            accumulator -= (pending - MaxTicksPerFrame) * TickSeconds;
+            pending = MaxTicksPerFrame;
+        }
+    }
+
+    // true while the simulation owes a tick for this frame.
+    bool Tick()
+    {
+        if (pending == 0)
+            return false;
+        pending--;
+        accumulator -= TickSeconds;
+        stats.Ticks++;
+        windowTicks++;
+        return true;
+    }
+
+    // blend factor between the previous and the current simulation state.
+    float Alpha() const
+    {
+        double alpha = accumulator / TickSeconds;
+        return (float) (alpha < 0.0 ? 0.0 : (alpha > 1.0 ? 1.0 : alpha));
+    }
+
+    // now in seconds, same clock as BeginFrame().
+    void EndFrame(double now)
+    {
+        stats.Frames++;
+        windowFrames++;
+        double elapsed = now - windowStart;
+        if (elapsed >= 1.0)
+        {
+            stats.SimulationRate = windowTicks / elapsed;
+            stats.RenderRate = windowFrames / elapsed;
+            stats.FrameMilliseconds = elapsed * 1000.0 / windowFrames;
+            windowStart = now;
+            windowTicks = 0;
+            windowFrames = 0;
+            updated = true;
+        }
+    }
+
+    // true once per second, when Stats() got new rates.
+    bool StatsUpdated()
+    {
+        bool result = updated;
+        updated = false;
+        return result;
+    }
+
+    const FixedTimestepStats &Stats() const
+    {
+        return stats;
+    }
+
+private:
+    double accumulator;
+    double lastTime;
+    unsigned int pending;
+    double windowStart;
+    unsigned int windowTicks;
+    unsigned int windowFrames;
+    bool updated;
+    FixedTimestepStats stats;
+};
+#endif
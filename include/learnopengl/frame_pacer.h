@@ -0,0 +1,283 @@
+#ifndef FRAME_PACER_H
+#define FRAME_PACER_H
+
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct FramePacingPercentiles
+{
+    double P50;
+    double P95;
+    double P99;
+};
+
+// Milliseconds over the recorded frames. Input..Swap are the stage durations, Latency is from the input
+// sample to the end of the swap (the earliest the frame can be on screen), Frame the time between frame starts.
+struct FramePacingReport
+{
+    unsigned int Frames;
+    FramePacingPercentiles Frame;
+    FramePacingPercentiles Wait;
+    FramePacingPercentiles Input;
+    FramePacingPercentiles Simulation;
+    FramePacingPercentiles Render;
+    FramePacingPercentiles Swap;
+    FramePacingPercentiles Latency;
+};
+
+// Frame pacing and latency timestamps for the render loop:
+//
+//     pacer.BeginFrame();                 // waits for the frame cap / just in time input point
+//     glfwPollEvents();
+//     pacer.Mark(FramePacer::Input);
+//     ... simulation ticks ...
+//     pacer.Mark(FramePacer::Simulation);
+//     ... render ...
+//     pacer.Mark(FramePacer::Render);
+//     glfwSwapBuffers(window);
+//     pacer.Mark(FramePacer::Swap);       // ends the frame
+//
+// The wait before a frame sleeps most of the way and spins the rest, the spin margin follows how late the
+// OS sleeps have been. With JustInTimeInput the wait is pushed so that input is sampled as late as the recent
+// frames allow: one refresh (or cap) interval after the last swap, minus the p95 of input-to-swap time.
+//
+// The last HistorySize frames are kept in fixed arrays, nothing is allocated per frame.
+class FramePacer
+{
+public:
+    enum SwapMode
+    {
+        Immediate,          // no vsync, tearing allowed
+        VSync,
+        AdaptiveVSync       // vsync, but tear instead of waiting a full interval when the frame is late
+    };
+
+    enum Stage
+    {
+        Input,
+        Simulation,
+        Render,
+        Swap,
+        STAGE_COUNT
+    };
+
+    enum
+    {
+        HistorySize = 1024
+    };
+
+    double MaxFrameRate;        // 0 = uncapped
+    double RefreshRate;         // display refresh, used by just in time input under vsync
+    bool JustInTimeInput;
+
+    FramePacer() : MaxFrameRate(0.0), RefreshRate(60.0), JustInTimeInput(false), mode(Immediate), frames(0), spinMargin(0.002),
+                   started(false)
+    {
+        history.resize(HistorySize * COLUMN_COUNT);
+        scratch.reserve(HistorySize);
+    }
+
+    // needs the window's context current. Returns false (and falls back to VSync) when adaptive vsync is missing.
+    bool SetSwapMode(SwapMode swapMode)
+    {
+        bool supported = true;
+        if (swapMode == AdaptiveVSync && !glfwExtensionSupported("WGL_EXT_swap_control_tear") &&
+            !glfwExtensionSupported("GLX_EXT_swap_control_tear"))
+        {
+            std::cout << "ERROR::FRAME_PACER::ADAPTIVE_VSYNC_NOT_SUPPORTED" << std::endl;
+            swapMode = VSync;
+            supported = false;
+        }
+        glfwSwapInterval(swapMode == Immediate ? 0 : (swapMode == VSync ? 1 : -1));
+        mode = swapMode;
+        return supported;
+    }
+
+    SwapMode GetSwapMode() const
+    {
+        return mode;
+    }
+
+    // waits for the next frame to be due, then starts its timestamps.
+    void BeginFrame()
+    {
+        Clock::time_point now = Clock::now();
+        if (started)
+        {
+            double interval = targetInterval();
+            double wait = 0.0;
+            if (MaxFrameRate > 0.0)
+                wait = interval - seconds(frameStart, now);
+            if (JustInTimeInput && interval > 0.0)
+            {
+                // sample input as late as the recent input-to-swap times allow
+                double work = percentile(LatencyColumn, 0.95) / 1000.0 + spinMargin;
+                double late = interval - work - seconds(swapEnd, now);
+                wait = std::max(wait, late);
+            }
+            if (wait > 0.0)
+                waitUntil(now + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(wait)));
+        }
+
+        Clock::time_point start = Clock::now();
+        if (started)
+        {
+            unsigned int slot = frames % HistorySize;
+            history[slot * COLUMN_COUNT + FrameColumn] = seconds(frameStart, start) * 1000.0;
+            history[slot * COLUMN_COUNT + WaitColumn] = seconds(now, start) * 1000.0;
+        }
+        frameStart = start;
+        stageStart = start;
+        started = true;
+    }
+
+    // closes stage, which started at the previous Mark() (or BeginFrame()). Swap ends the frame.
+    void Mark(Stage stage)
+    {
+        Clock::time_point now = Clock::now();
+        unsigned int slot = frames % HistorySize;
+        history[slot * COLUMN_COUNT + stage] = seconds(stageStart, now) * 1000.0;
+        if (stage == Input)
+            inputTime = now;
+        stageStart = now;
+        if (stage == Swap)
+        {
+            history[slot * COLUMN_COUNT + LatencyColumn] = seconds(inputTime, now) * 1000.0;
+            swapEnd = now;
+            frames++;
+        }
+    }
+
+    unsigned int Frames() const
+    {
+        return frames;
+    }
+
+    FramePacingReport Report()
+    {
+        FramePacingReport report;
+        report.Frames = std::min(frames, (unsigned int) HistorySize);
+        report.Input = percentiles(Input);
+        report.Simulation = percentiles(Simulation);
+        report.Render = percentiles(Render);
+        report.Swap = percentiles(Swap);
+        report.Frame = percentiles(FrameColumn);
+        report.Wait = percentiles(WaitColumn);
+        report.Latency = percentiles(LatencyColumn);
+        return report;
+    }
+
+    void PrintReport()
+    {
+        FramePacingReport report = Report();
+        const char* names[] = {"frame", "wait", "input", "simulation", "render", "swap", "input to swap"};
+        const FramePacingPercentiles* values[] = {&report.Frame, &report.Wait, &report.Input, &report.Simulation, &report.Render,
+                                                  &report.Swap, &report.Latency};
+        std::printf("frame pacing over %u frames (ms)\n", report.Frames);
+        for (unsigned int i = 0; i < 7; i++)
+            std::printf("%-16s p50 %8.3f  p95 %8.3f  p99 %8.3f\n", names[i], values[i]->P50, values[i]->P95, values[i]->P99);
+    }
+
+    std::string ReportJSON()
+    {
+        FramePacingReport report = Report();
+        const char* names[] = {"frame", "wait", "input", "simulation", "render", "swap", "latency"};
+        const FramePacingPercentiles* values[] = {&report.Frame, &report.Wait, &report.Input, &report.Simulation, &report.Render,
+                                                  &report.Swap, &report.Latency};
+        std::string json = "{\"frames\": " + std::to_string(report.Frames);
+        char entry[160];
+        for (unsigned int i = 0; i < 7; i++)
+        {
+            std::snprintf(entry, sizeof(entry), ", \"%s\": {\"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f}", names[i], values[i]->P50,
+                          values[i]->P95, values[i]->P99);
+            json += entry;
+        }
+        return json + "}";
+    }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    // columns of the history after the stage durations
+    enum
+    {
+        FrameColumn = STAGE_COUNT,
+        WaitColumn,
+        LatencyColumn,
+        COLUMN_COUNT
+    };
+
+    SwapMode mode;
+    unsigned int frames;
+    double spinMargin;          // seconds left to spin after sleeping
+    bool started;
+    Clock::time_point frameStart, stageStart, inputTime, swapEnd;
+    // HistorySize rows of COLUMN_COUNT milliseconds, frame i in row i % HistorySize
+    std::vector<double> history;
+    std::vector<double> scratch;
+
+    static double seconds(Clock::time_point from, Clock::time_point to)
+    {
+        return std::chrono::duration<double>(to - from).count();
+    }
+
+    double targetInterval() const
+    {
+        double interval = 0.0;
+        if (MaxFrameRate > 0.0)
+            interval = 1.0 / MaxFrameRate;
+        if (mode != Immediate && RefreshRate > 0.0)
+            interval = std::max(interval, 1.0 / RefreshRate);
+        return interval;
+    }
+
+    // sleeps while the OS can be trusted to wake up in time, spins the rest.
+    void waitUntil(Clock::time_point target)
+    {
+        while (true)
+        {
+            Clock::time_point now = Clock::now();
+            double remaining = seconds(now, target);
+            if (remaining <= 0.0)
+                return;
+            if (remaining > spinMargin)
+            {
+                double request = remaining - spinMargin;
+                std::this_thread::sleep_for(std::chrono::duration<double>(request));
+                double late = seconds(now, Clock::now()) - request;
+                // grow at once on a late wake up, shrink slowly when sleeps are accurate
+                spinMargin = late * 1.25 > spinMargin ? late * 1.25 : spinMargin * 0.98 + late * 0.02;
+                spinMargin = std::max(0.0002, std::min(spinMargin, 0.004));
+            }
+            else
+                std::this_thread::yield();
+        }
+    }
+
+    double percentile(unsigned int column, double fraction)
+    {
+        unsigned int count = std::min(frames, (unsigned int) HistorySize);
+        if (count == 0)
+            return 0.0;
+        scratch.clear();
+        for (unsigned int i = 0; i < count; i++)
+            scratch.push_back(history[i * COLUMN_COUNT + column]);
+        size_t index = (size_t) ((count - 1) * fraction + 0.5);
+        std::nth_element(scratch.begin(), scratch.begin() + index, scratch.end());
+        return scratch[index];
+    }
+
+    FramePacingPercentiles percentiles(unsigned int column)
+    {
+        FramePacingPercentiles result = {percentile(column, 0.50), percentile(column, 0.95), percentile(column, 0.99)};
+        return result;
+    }
+};
+#endif
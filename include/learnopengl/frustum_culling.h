@@ -0,0 +1,325 @@
+#ifndef FRUSTUM_CULLING_H
+#define FRUSTUM_CULLING_H
+
+#include <glm/glm.hpp>
+
+#include <learnopengl/mesh.h>
+#include <learnopengl/cpu_profiler.h>
+
+#include <cstdint>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FRUSTUM_CULLING_SSE
+#include <emmintrin.h>
+#endif
+// the AVX batch is always there on x86 with GCC/Clang: a build that doesn't target AVX compiles it for AVX alone
+// (target attribute) and only runs it when the CPU reports AVX. Elsewhere it needs a build targeting AVX.
+#if defined(__AVX__)
+#define FRUSTUM_CULLING_AVX
+#define FRUSTUM_CULLING_AVX_TARGET
+#include <immintrin.h>
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define FRUSTUM_CULLING_AVX
+#define FRUSTUM_CULLING_AVX_DISPATCH
+#define FRUSTUM_CULLING_AVX_TARGET __attribute__((target("avx")))
+#include <immintrin.h>
+#endif
+
+// The six planes of a view frustum, pointing inwards: a point p is inside when dot(plane.xyz, p) + plane.w >= 0
+// for every plane.
+struct Frustum
+{
+    enum Side { Left, Right, Bottom, Top, Near, Far };
+    glm::vec4 Planes[6];
+
+    // extracts the planes of projection * view (Gribb & Hartmann), in the space the matrix transforms from.
+    static Frustum FromMatrix(const glm::mat4 &viewProjection)
+    {
+        glm::vec4 row0(viewProjection[0][0], viewProjection[1][0], viewProjection[2][0], viewProjection[3][0]);
+        glm::vec4 row1(viewProjection[0][1], viewProjection[1][1], viewProjection[2][1], viewProjection[3][1]);
+        glm::vec4 row2(viewProjection[0][2], viewProjection[1][2], viewProjection[2][2], viewProjection[3][2]);
+        glm::vec4 row3(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+
+        Frustum frustum;
+        frustum.Planes[Left] = row3 + row0;
+        frustum.Planes[Right] = row3 - row0;
+        frustum.Planes[Bottom] = row3 + row1;
+        frustum.Planes[Top] = row3 - row1;
+        frustum.Planes[Near] = row3 + row2;
+        frustum.Planes[Far] = row3 - row2;
+        for (int i = 0; i < 6; i++)
+            frustum.Planes[i] /= glm::length(glm::vec3(frustum.Planes[i]));
+        return frustum;
+    }
+
+    bool IntersectsSphere(const glm::vec3 &center, float radius) const
+    {
+        for (int i = 0; i < 6; i++)
+        {
+            if (glm::dot(glm::vec3(Planes[i]), center) + Planes[i].w < -radius)
+                return false;
+        }
+        return true;
+    }
+
+    // conservative: a box crossing two planes outside the frustum corner is reported as intersecting.
+    bool IntersectsBox(const glm::vec3 &center, const glm::vec3 &extent) const
+    {
+        for (int i = 0; i < 6; i++)
+        {
+            glm::vec3 normal(Planes[i]);
+            float distance = glm::dot(normal, center) + Planes[i].w;
+            float reach = glm::dot(glm::abs(normal), extent);
+            if (distance + reach < 0.0f)
+                return false;
+        }
+        return true;
+    }
+};
+
+// model space bounds moved by transform: the box is re-fitted around the transformed box (Arvo), the sphere
+// radius grows with the largest axis scale.
+inline Bounds TransformBounds(const Bounds &bounds, const glm::mat4 &transform)
+{
+    glm::vec3 center = glm::vec3(transform * glm::vec4((bounds.Min + bounds.Max) * 0.5f, 1.0f));
+    glm::vec3 extent = (bounds.Max - bounds.Min) * 0.5f;
+    glm::mat3 linear(transform);
+    glm::vec3 worldExtent = glm::abs(linear[0]) * extent.x + glm::abs(linear[1]) * extent.y + glm::abs(linear[2]) * extent.z;
+    float scale = glm::sqrt(glm::max(glm::dot(linear[0], linear[0]), glm::max(glm::dot(linear[1], linear[1]), glm::dot(linear[2], linear[2]))));
+
+    Bounds result;
+    result.Min = center - worldExtent;
+    result.Max = center + worldExtent;
+    result.Center = glm::vec3(transform * glm::vec4(bounds.Center, 1.0f));
+    result.Radius = bounds.Radius * scale;
+    return result;
+}
+
+// Culls a list of world space boxes against a frustum. The boxes are kept as center/extent in structure of
+// arrays form, so one SIMD register holds the same coordinate of 4 (SSE) or 8 (AVX) boxes and a plane test
+// covers the whole batch with a handful of multiply/adds. Cull() returns the indices of the visible boxes in
+// the order they were added, ready to be turned into draw packets.
+class FrustumCuller
+{
+public:
+    void Clear()
+    {
+        for (int i = 0; i < 6; i++)
+            soa[i].clear();
+    }
+
+    void Reserve(unsigned int count)
+    {
+        for (int i = 0; i < 6; i++)
+            soa[i].reserve(count);
+    }
+
+    // adds a world space box, returns its index.
+    unsigned int Add(const glm::vec3 &min, const glm::vec3 &max)
+    {
+        glm::vec3 center = (min + max) * 0.5f;
+        glm::vec3 extent = (max - min) * 0.5f;
+        soa[0].push_back(center.x);
+        soa[1].push_back(center.y);
+        soa[2].push_back(center.z);
+        soa[3].push_back(extent.x);
+        soa[4].push_back(extent.y);
+        soa[5].push_back(extent.z);
+        return (unsigned int) soa[0].size() - 1;
+    }
+
+    // adds the box of model space bounds placed with transform.
+    unsigned int Add(const Bounds &bounds, const glm::mat4 &transform)
+    {
+        Bounds world = TransformBounds(bounds, transform);
+        return Add(world.Min, world.Max);
+    }
+
+    unsigned int Size() const
+    {
+        return (unsigned int) soa[0].size();
+    }
+
+    // whether CullAVX() runs the 8-wide batch: the build targets AVX, or the CPU has it (checked once).
+    static bool HasAVX()
+    {
+#if defined(FRUSTUM_CULLING_AVX_DISPATCH)
+        static const bool avx = (__builtin_cpu_init(), __builtin_cpu_supports("avx") != 0);
+        return avx;
+#elif defined(FRUSTUM_CULLING_AVX)
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    // visible box indices, using the widest instruction set the CPU and the build allow.
+    void Cull(const Frustum &frustum, std::vector<uint32_t> &visible) const
+    {
+        CPU_PROFILE_ZONE("FrustumCuller::Cull");
+        visible.clear();
+        unsigned int first = 0;
+#if defined(FRUSTUM_CULLING_AVX)
+        if (HasAVX())
+            first = cullAVX(frustum, visible);
+        else
+#endif
+        {
+#if defined(FRUSTUM_CULLING_SSE)
+            first = cullSSE(frustum, visible);
+#endif
+        }
+        cullScalar(frustum, first, visible);
+    }
+
+    // reference implementation, one box at a time.
+    void CullScalar(const Frustum &frustum, std::vector<uint32_t> &visible) const
+    {
+        visible.clear();
+        cullScalar(frustum, 0, visible);
+    }
+
+    // 4 boxes per iteration, falls back to CullScalar when SSE isn't available.
+    void CullSSE(const Frustum &frustum, std::vector<uint32_t> &visible) const
+    {
+        visible.clear();
+        unsigned int first = 0;
+#if defined(FRUSTUM_CULLING_SSE)
+        first = cullSSE(frustum, visible);
+#endif
+        cullScalar(frustum, first, visible);
+    }
+
+    // 8 boxes per iteration, falls back to CullSSE without AVX (see HasAVX()).
+    void CullAVX(const Frustum &frustum, std::vector<uint32_t> &visible) const
+    {
+#if defined(FRUSTUM_CULLING_AVX)
+        if (HasAVX())
+        {
+            visible.clear();
+            unsigned int first = cullAVX(frustum, visible);
+            cullScalar(frustum, first, visible);
+            return;
+        }
+#endif
+        CullSSE(frustum, visible);
+    }
+
+private:
+    // center x/y/z, extent x/y/z
+    std::vector<float> soa[6];
+
+    // tests the boxes from first to the end, same arithmetic (and order of operations) as the SIMD paths.
+    void cullScalar(const Frustum &frustum, unsigned int first, std::vector<uint32_t> &visible) const
+    {
+        for (unsigned int i = first; i < Size(); i++)
+        {
+            bool outside = false;
+            for (int p = 0; p < 6 && !outside; p++)
+            {
+                const glm::vec4 &plane = frustum.Planes[p];
+                float distance = plane.x * soa[0][i] + plane.y * soa[1][i] + plane.z * soa[2][i] + plane.w;
+                float reach = glm::abs(plane.x) * soa[3][i] + glm::abs(plane.y) * soa[4][i] + glm::abs(plane.z) * soa[5][i];
+                outside = distance + reach < 0.0f;
+            }
+            if (!outside)
+                visible.push_back(i);
+        }
+    }
+
+#if defined(FRUSTUM_CULLING_SSE)
+    // returns the index of the first box left for the scalar tail.
+    unsigned int cullSSE(const Frustum &frustum, std::vector<uint32_t> &visible) const
+    {
+        unsigned int count = Size() & ~3u;
+        const __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+        __m128 nx[6], ny[6], nz[6], nw[6], ax[6], ay[6], az[6];
+        for (int p = 0; p < 6; p++)
+        {
+            nx[p] = _mm_set1_ps(frustum.Planes[p].x);
+            ny[p] = _mm_set1_ps(frustum.Planes[p].y);
+            nz[p] = _mm_set1_ps(frustum.Planes[p].z);
+            nw[p] = _mm_set1_ps(frustum.Planes[p].w);
+            ax[p] = _mm_and_ps(nx[p], signMask);
+            ay[p] = _mm_and_ps(ny[p], signMask);
+            az[p] = _mm_and_ps(nz[p], signMask);
+        }
+
+        const __m128 zero = _mm_setzero_ps();
+        for (unsigned int i = 0; i < count; i += 4)
+        {
+            __m128 cx = _mm_loadu_ps(&soa[0][i]), cy = _mm_loadu_ps(&soa[1][i]), cz = _mm_loadu_ps(&soa[2][i]);
+            __m128 ex = _mm_loadu_ps(&soa[3][i]), ey = _mm_loadu_ps(&soa[4][i]), ez = _mm_loadu_ps(&soa[5][i]);
+            __m128 outside = _mm_setzero_ps();
+            for (int p = 0; p < 6; p++)
+            {
+                __m128 distance = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(nx[p], cx), _mm_mul_ps(ny[p], cy)), _mm_mul_ps(nz[p], cz)), nw[p]);
+                __m128 reach = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax[p], ex), _mm_mul_ps(ay[p], ey)), _mm_mul_ps(az[p], ez));
+                outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, reach), zero));
+            }
+            int inside = ~_mm_movemask_ps(outside) & 0xF;
+            while (inside != 0)
+            {
+                int lane = lowestBit(inside);
+                visible.push_back(i + lane);
+                inside &= inside - 1;
+            }
+        }
+        return count;
+    }
+#endif
+
+#if defined(FRUSTUM_CULLING_AVX)
+    FRUSTUM_CULLING_AVX_TARGET unsigned int cullAVX(const Frustum &frustum, std::vector<uint32_t> &visible) const
+    {
+        unsigned int count = Size() & ~7u;
+        const __m256 signMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+        __m256 nx[6], ny[6], nz[6], nw[6], ax[6], ay[6], az[6];
+        for (int p = 0; p < 6; p++)
+        {
+            nx[p] = _mm256_set1_ps(frustum.Planes[p].x);
+            ny[p] = _mm256_set1_ps(frustum.Planes[p].y);
+            nz[p] = _mm256_set1_ps(frustum.Planes[p].z);
+            nw[p] = _mm256_set1_ps(frustum.Planes[p].w);
+            ax[p] = _mm256_and_ps(nx[p], signMask);
+            ay[p] = _mm256_and_ps(ny[p], signMask);
+            az[p] = _mm256_and_ps(nz[p], signMask);
+        }
+
+        const __m256 zero = _mm256_setzero_ps();
+        for (unsigned int i = 0; i < count; i += 8)
+        {
+            __m256 cx = _mm256_loadu_ps(&soa[0][i]), cy = _mm256_loadu_ps(&soa[1][i]), cz = _mm256_loadu_ps(&soa[2][i]);
+            __m256 ex = _mm256_loadu_ps(&soa[3][i]), ey = _mm256_loadu_ps(&soa[4][i]), ez = _mm256_loadu_ps(&soa[5][i]);
+            __m256 outside = _mm256_setzero_ps();
+            for (int p = 0; p < 6; p++)
+            {
+                __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nx[p], cx), _mm256_mul_ps(ny[p], cy)), _mm256_mul_ps(nz[p], cz)), nw[p]);
+                __m256 reach = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ax[p], ex), _mm256_mul_ps(ay[p], ey)), _mm256_mul_ps(az[p], ez));
+                outside = _mm256_or_ps(outside, _mm256_cmp_ps(_mm256_add_ps(distance, reach), zero, _CMP_LT_OQ));
+            }
+            int inside = ~_mm256_movemask_ps(outside) & 0xFF;
+            while (inside != 0)
+            {
+                int lane = lowestBit(inside);
+                visible.push_back(i + lane);
+                inside &= inside - 1;
+            }
+        }
+        return count;
+    }
+#endif
+
+    static int lowestBit(int mask)
+    {
+        int lane = 0;
+        while ((mask & 1) == 0)
+        {
+            mask >>= 1;
+            lane++;
+        }
+        return lane;
+    }
+};
+#endif
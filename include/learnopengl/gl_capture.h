@@ -0,0 +1,959 @@
+#ifndef GL_CAPTURE_H
+#define GL_CAPTURE_H
+
+#include <glad/glad.h>
+
+#include <learnopengl/gl_capture_format.h>
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// the glad functions GLCapture hooks, as their names without the gl prefix.
+#define GL_CAPTURE_FUNCTIONS(X) \
+    X(GenBuffers) X(CreateBuffers) X(DeleteBuffers) X(GenVertexArrays) X(DeleteVertexArrays) X(GenTextures) \
+    X(CreateTextures) X(DeleteTextures) X(CreateFramebuffers) X(DeleteFramebuffers) X(CreateShader) X(ShaderSource) \
+    X(CompileShader) X(DeleteShader) X(CreateProgram) X(AttachShader) X(DetachShader) X(LinkProgram) X(DeleteProgram) \
+    X(GetUniformLocation) X(GetAttribLocation) \
+    X(BufferData) X(BufferSubData) X(NamedBufferStorage) X(MapNamedBufferRange) X(UnmapNamedBuffer) X(TexImage2D) \
+    X(TextureStorage2D) X(GenerateMipmap) X(TexParameteri) X(TextureParameteri) \
+    X(VertexAttribPointer) X(EnableVertexAttribArray) X(VertexAttribDivisor) X(NamedFramebufferTexture) \
+    X(NamedFramebufferDrawBuffer) X(NamedFramebufferDrawBuffers) \
+    X(UseProgram) X(BindVertexArray) X(BindBuffer) X(BindBufferBase) X(BindBufferRange) X(ActiveTexture) \
+    X(BindTexture) X(BindTextureUnit) X(BindTextures) X(BindSampler) X(BindFramebuffer) \
+    X(Enable) X(Disable) X(BlendFunc) X(BlendFuncSeparate) X(BlendEquation) X(BlendEquationSeparate) X(DepthFunc) \
+    X(DepthMask) X(PolygonMode) X(Viewport) X(Scissor) X(ClearColor) X(PixelStorei) X(MemoryBarrier) \
+    X(Uniform1i) X(Uniform1f) X(Uniform2f) X(Uniform3f) X(Uniform4f) X(Uniform2fv) X(Uniform3fv) X(Uniform4fv) \
+    X(UniformMatrix2fv) X(UniformMatrix3fv) X(UniformMatrix4fv) X(ProgramUniform1i) X(ProgramUniform1iv) \
+    X(Clear) X(DrawArrays) X(DrawElements) X(DrawElementsBaseVertex) X(DrawElementsInstancedBaseVertex) \
+    X(DrawElementsInstancedBaseInstance) X(MultiDrawElementsIndirect)
+
+// Records GL calls into a capture file (format in gl_capture_format.h) for tools/gl_replay and tools/gl_analyze.
+// Like GLStateCache, Start() swaps glad's function pointers for wrappers that write the call with its arguments
+// and payload (buffer and texture data, shader sources) and then forward it. Installed after the state cache it
+// sees every call the app makes, redundant ones included.
+//
+// Start right after the context is created: a capture holds everything from there on, so the replayer can
+// recreate every object the captured frames use. Frames are delimited with BeginFrame()/EndFrame().
+//
+// Writes through persistently mapped buffers (StreamBuffer) never go through GL. EndFrame() compares every such
+// mapping against a shadow copy and stores the changed ranges at the start of the frame, so a replay sees the
+// data before its draws. Other mappings are compared when they are unmapped. (Reading mapped memory back is slow,
+// which only matters while capturing.)
+//
+// Only the calls listed in GL_CAPTURE_FUNCTIONS are recorded (everything the samples issue while drawing), queries
+// and sync objects are not. Single threaded, like the rest of our GL code.
+class GLCapture : public GLCaptureFormat
+{
+public:
+    // opens path and installs the hooks, width/height is the size of the default framebuffer.
+    static bool Start(const char* path, int width, int height)
+    {
+        State &state = capture();
+        if (state.File != NULL)
+            return false;
+        state.File = std::fopen(path, "wb");
+        if (state.File == NULL)
+        {
+            std::cout << "ERROR::GL_CAPTURE::FAILED_TO_OPEN " << path << std::endl;
+            return false;
+        }
+        Header header;
+        std::memcpy(header.Magic, "GLCP", 4);
+        header.Version = Version;
+        header.Width = (uint32_t) width;
+        header.Height = (uint32_t) height;
+        std::fwrite(&header, sizeof(header), 1, state.File);
+
+        state.Path = path;
+        state.Frames = 0;
+        state.Bytes = sizeof(header);
+        state.InFrame = false;
+        state.UnpackBuffer = 0;
+        glGetIntegerv(GL_UNPACK_ALIGNMENT, &state.UnpackAlignment);
+        glGetIntegerv(GL_UNPACK_ROW_LENGTH, &state.UnpackRowLength);
+
+        Originals &gl = originals();
+#define GL_CAPTURE_HOOK(name) gl.name = glad_gl##name; if (gl.name != NULL) glad_gl##name = capture##name;
+        GL_CAPTURE_FUNCTIONS(GL_CAPTURE_HOOK)
+#undef GL_CAPTURE_HOOK
+
+        // the replay starts from the same unpack state
+        glPixelStorei(GL_UNPACK_ALIGNMENT, state.UnpackAlignment);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, state.UnpackRowLength);
+        return true;
+    }
+
+    // restores the glad pointers and closes the file.
+    static void Stop()
+    {
+        State &state = capture();
+        if (state.File == NULL)
+            return;
+        if (state.InFrame)
+            EndFrame();
+        Originals &gl = originals();
+#define GL_CAPTURE_UNHOOK(name) glad_gl##name = gl.name;
+        GL_CAPTURE_FUNCTIONS(GL_CAPTURE_UNHOOK)
+#undef GL_CAPTURE_UNHOOK
+
+        flush();
+        std::fclose(state.File);
+        state.File = NULL;
+        state.Mappings.clear();
+        std::printf("GL capture: %u frames, %.2f MB written to %s\n", state.Frames, state.Bytes / (1024.0 * 1024.0), state.Path.c_str());
+    }
+
+    static bool Active()
+    {
+        return capture().File != NULL;
+    }
+
+    // frames completed so far
+    static unsigned int Frames()
+    {
+        return capture().Frames;
+    }
+
+    static void BeginFrame()
+    {
+        State &state = capture();
+        if (state.File == NULL || state.InFrame)
+            return;
+        flush();
+        uint32_t args[] = {state.Frames};
+        write(FRAME_BEGIN, args, 1);
+        state.FrameStart = state.Stream.size();
+        state.InFrame = true;
+    }
+
+    static void EndFrame()
+    {
+        State &state = capture();
+        if (state.File == NULL || !state.InFrame)
+            return;
+        // what the frame wrote through persistent mappings goes in front of its first call
+        std::vector<char> writes;
+        for (unsigned int i = 0; i < state.Mappings.size(); i++)
+        {
+            if (state.Mappings[i].Persistent)
+                diffMapping(state.Mappings[i], writes);
+        }
+        state.Stream.insert(state.Stream.begin() + state.FrameStart, writes.begin(), writes.end());
+
+        uint32_t args[] = {state.Frames};
+        write(FRAME_END, args, 1);
+        state.InFrame = false;
+        state.Frames++;
+        flush();
+    }
+
+private:
+    struct Mapping
+    {
+        GLuint Buffer;
+        GLintptr Offset;
+        char* Pointer;
+        bool Persistent;
+        std::vector<char> Shadow;   // the contents as of the last diff
+    };
+
+    struct State
+    {
+        FILE* File;
+        std::string Path;
+        std::vector<char> Stream;   // records not written to the file yet, the whole frame while in one
+        size_t FrameStart;
+        bool InFrame;
+        unsigned int Frames;
+        double Bytes;
+        GLint UnpackAlignment;
+        GLint UnpackRowLength;
+        GLuint UnpackBuffer;
+        std::vector<Mapping> Mappings;
+    };
+
+    struct Originals
+    {
+#define GL_CAPTURE_ORIGINAL(name) decltype(glad_gl##name) name;
+        GL_CAPTURE_FUNCTIONS(GL_CAPTURE_ORIGINAL)
+#undef GL_CAPTURE_ORIGINAL
+    };
+
+    static State &capture()
+    {
+        static State state = State();
+        return state;
+    }
+
+    static Originals &originals()
+    {
+        static Originals gl = {};
+        return gl;
+    }
+
+    static uint32_t word(float value)
+    {
+        uint32_t result;
+        std::memcpy(&result, &value, sizeof(result));
+        return result;
+    }
+
+    static uint32_t low(uint64_t value)
+    {
+        return (uint32_t) value;
+    }
+
+    static uint32_t high(uint64_t value)
+    {
+        return (uint32_t) (value >> 32);
+    }
+
+    static void append(std::vector<char> &out, unsigned int call, const uint32_t* args, unsigned int words, const void* payload, size_t size)
+    {
+        Record record = {(uint16_t) call, (uint16_t) words, (uint32_t) size};
+        size_t start = out.size();
+        size_t padded = (size + 3) & ~(size_t) 3;
+        out.resize(start + sizeof(record) + words * sizeof(uint32_t) + padded, 0);
+        std::memcpy(&out[start], &record, sizeof(record));
+        if (words > 0)
+            std::memcpy(&out[start + sizeof(record)], args, words * sizeof(uint32_t));
+        if (size > 0)
+            std::memcpy(&out[start + sizeof(record) + words * sizeof(uint32_t)], payload, size);
+    }
+
+    static void write(unsigned int call, const uint32_t* args, unsigned int words, const void* payload = NULL, size_t size = 0)
+    {
+        State &state = capture();
+        append(state.Stream, call, args, words, payload, size);
+        // outside frames (loading) records go out in large blocks
+        if (!state.InFrame && state.Stream.size() > 1024 * 1024)
+            flush();
+    }
+
+    static void flush()
+    {
+        State &state = capture();
+        if (!state.Stream.empty())
+            std::fwrite(&state.Stream[0], 1, state.Stream.size(), state.File);
+        state.Bytes += state.Stream.size();
+        state.Stream.clear();
+    }
+
+    // stores the ranges of the mapping that changed since the last diff as MAPPED_WRITE records.
+    static void diffMapping(Mapping &mapping, std::vector<char> &out)
+    {
+        const size_t page = 256;
+        size_t length = mapping.Shadow.size();
+        size_t begin = 0;
+        while (begin < length)
+        {
+            size_t size = length - begin < page ? length - begin : page;
+            if (std::memcmp(mapping.Pointer + begin, &mapping.Shadow[begin], size) == 0)
+            {
+                begin += size;
+                continue;
+            }
+            size_t end = begin + size;
+            while (end < length)
+            {
+                size = length - end < page ? length - end : page;
+                if (std::memcmp(mapping.Pointer + end, &mapping.Shadow[end], size) == 0)
+                    break;
+                end += size;
+            }
+            std::memcpy(&mapping.Shadow[begin], mapping.Pointer + begin, end - begin);
+            uint64_t offset = (uint64_t) mapping.Offset + begin;
+            uint32_t args[] = {mapping.Buffer, low(offset), high(offset)};
+            append(out, MAPPED_WRITE, args, 3, mapping.Pointer + begin, end - begin);
+            begin = end;
+        }
+    }
+
+    // bytes glTexImage2D reads for an image, following the unpack alignment and row length.
+    static size_t imageSize(GLsizei width, GLsizei height, GLenum format, GLenum type)
+    {
+        size_t components = 4;
+        switch (format)
+        {
+            case GL_RED: case GL_RED_INTEGER: case GL_DEPTH_COMPONENT: case GL_STENCIL_INDEX: case GL_DEPTH_STENCIL: components = 1; break;
+            case GL_RG: case GL_RG_INTEGER: components = 2; break;
+            case GL_RGB: case GL_BGR: case GL_RGB_INTEGER: components = 3; break;
+            default: components = 4; break;
+        }
+        size_t pixel = components;
+        switch (type)
+        {
+            case GL_SHORT: case GL_UNSIGNED_SHORT: case GL_HALF_FLOAT: pixel = components * 2; break;
+            case GL_INT: case GL_UNSIGNED_INT: case GL_FLOAT: pixel = components * 4; break;
+            case GL_UNSIGNED_INT_24_8: pixel = 4; break;
+            default: break;
+        }
+        State &state = capture();
+        size_t rowPixels = state.UnpackRowLength > 0 ? (size_t) state.UnpackRowLength : (size_t) width;
+        size_t alignment = state.UnpackAlignment > 0 ? (size_t) state.UnpackAlignment : 4;
+        size_t row = (rowPixels * pixel + alignment - 1) / alignment * alignment;
+        return width > 0 && height > 0 ? row * (height - 1) + width * pixel : 0;
+    }
+
+    static void names(unsigned int call, GLsizei n, const GLuint* names)
+    {
+        uint32_t args[] = {(uint32_t) n};
+        write(call, args, 1, names, n > 0 ? n * sizeof(GLuint) : 0);
+    }
+
+    // objects
+
+    static void APIENTRY captureGenBuffers(GLsizei n, GLuint* buffers)
+    {
+        originals().GenBuffers(n, buffers);
+        names(GEN_BUFFERS, n, buffers);
+    }
+
+    static void APIENTRY captureCreateBuffers(GLsizei n, GLuint* buffers)
+    {
+        originals().CreateBuffers(n, buffers);
+        names(CREATE_BUFFERS, n, buffers);
+    }
+
+    static void APIENTRY captureDeleteBuffers(GLsizei n, const GLuint* buffers)
+    {
+        names(DELETE_BUFFERS, n, buffers);
+        // a buffer deleted while mapped is unmapped with it
+        std::vector<Mapping> &mappings = capture().Mappings;
+        for (GLsizei i = 0; i < n; i++)
+        {
+            for (unsigned int m = 0; m < mappings.size(); m++)
+            {
+                if (mappings[m].Buffer == buffers[i])
+                {
+                    mappings.erase(mappings.begin() + m);
+                    break;
+                }
+            }
+        }
+        originals().DeleteBuffers(n, buffers);
+    }
+
+    static void APIENTRY captureGenVertexArrays(GLsizei n, GLuint* arrays)
+    {
+        originals().GenVertexArrays(n, arrays);
+        names(GEN_VERTEX_ARRAYS, n, arrays);
+    }
+
+    static void APIENTRY captureDeleteVertexArrays(GLsizei n, const GLuint* arrays)
+    {
+        names(DELETE_VERTEX_ARRAYS, n, arrays);
+        originals().DeleteVertexArrays(n, arrays);
+    }
+
+    static void APIENTRY captureGenTextures(GLsizei n, GLuint* textures)
+    {
+        originals().GenTextures(n, textures);
+        names(GEN_TEXTURES, n, textures);
+    }
+
+    static void APIENTRY captureCreateTextures(GLenum target, GLsizei n, GLuint* textures)
+    {
+        originals().CreateTextures(target, n, textures);
+        uint32_t args[] = {target, (uint32_t) n};
+        write(CREATE_TEXTURES, args, 2, textures, n > 0 ? n * sizeof(GLuint) : 0);
+    }
+
+    static void APIENTRY captureDeleteTextures(GLsizei n, const GLuint* textures)
+    {
+        names(DELETE_TEXTURES, n, textures);
+        originals().DeleteTextures(n, textures);
+    }
+
+    static void APIENTRY captureCreateFramebuffers(GLsizei n, GLuint* framebuffers)
+    {
+        originals().CreateFramebuffers(n, framebuffers);
+        names(CREATE_FRAMEBUFFERS, n, framebuffers);
+    }
+
+    static void APIENTRY captureDeleteFramebuffers(GLsizei n, const GLuint* framebuffers)
+    {
+        names(DELETE_FRAMEBUFFERS, n, framebuffers);
+        originals().DeleteFramebuffers(n, framebuffers);
+    }
+
+    static GLuint APIENTRY captureCreateShader(GLenum type)
+    {
+        GLuint shader = originals().CreateShader(type);
+        uint32_t args[] = {type, shader};
+        write(CREATE_SHADER, args, 2);
+        return shader;
+    }
+
+    static void APIENTRY captureShaderSource(GLuint shader, GLsizei count, const GLchar* const* strings, const GLint* lengths)
+    {
+        std::string source;
+        for (GLsizei i = 0; i < count; i++)
+        {
+            if (lengths != NULL && lengths[i] >= 0)
+                source.append(strings[i], lengths[i]);
+            else
+                source.append(strings[i]);
+        }
+        uint32_t args[] = {shader};
+        write(SHADER_SOURCE, args, 1, source.data(), source.size());
+        originals().ShaderSource(shader, count, strings, lengths);
+    }
+
+    static void APIENTRY captureCompileShader(GLuint shader)
+    {
+        uint32_t args[] = {shader};
+        write(COMPILE_SHADER, args, 1);
+        originals().CompileShader(shader);
+    }
+
+    static void APIENTRY captureDeleteShader(GLuint shader)
+    {
+        uint32_t args[] = {shader};
+        write(DELETE_SHADER, args, 1);
+        originals().DeleteShader(shader);
+    }
+
+    static GLuint APIENTRY captureCreateProgram()
+    {
+        GLuint program = originals().CreateProgram();
+        uint32_t args[] = {program};
+        write(CREATE_PROGRAM, args, 1);
+        return program;
+    }
+
+    static void APIENTRY captureAttachShader(GLuint program, GLuint shader)
+    {
+        uint32_t args[] = {program, shader};
+        write(ATTACH_SHADER, args, 2);
+        originals().AttachShader(program, shader);
+    }
+
+    static void APIENTRY captureDetachShader(GLuint program, GLuint shader)
+    {
+        uint32_t args[] = {program, shader};
+        write(DETACH_SHADER, args, 2);
+        originals().DetachShader(program, shader);
+    }
+
+    static void APIENTRY captureLinkProgram(GLuint program)
+    {
+        uint32_t args[] = {program};
+        write(LINK_PROGRAM, args, 1);
+        originals().LinkProgram(program);
+    }
+
+    static void APIENTRY captureDeleteProgram(GLuint program)
+    {
+        uint32_t args[] = {program};
+        write(DELETE_PROGRAM, args, 1);
+        originals().DeleteProgram(program);
+    }
+
+    // the replayer asks its driver again and maps the locations the app saw to the ones it gets
+    static GLint APIENTRY captureGetUniformLocation(GLuint program, const GLchar* name)
+    {
+        GLint location = originals().GetUniformLocation(program, name);
+        uint32_t args[] = {program, (uint32_t) location};
+        write(GET_UNIFORM_LOCATION, args, 2, name, std::strlen(name));
+        return location;
+    }
+
+    static GLint APIENTRY captureGetAttribLocation(GLuint program, const GLchar* name)
+    {
+        GLint location = originals().GetAttribLocation(program, name);
+        uint32_t args[] = {program, (uint32_t) location};
+        write(GET_ATTRIB_LOCATION, args, 2, name, std::strlen(name));
+        return location;
+    }
+
+    // uploads
+
+    static void APIENTRY captureBufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage)
+    {
+        uint32_t args[] = {target, low(size), high(size), usage, data != NULL};
+        write(BUFFER_DATA, args, 5, data, data != NULL ? (size_t) size : 0);
+        originals().BufferData(target, size, data, usage);
+    }
+
+    static void APIENTRY captureBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data)
+    {
+        uint32_t args[] = {target, low(offset), high(offset)};
+        write(BUFFER_SUB_DATA, args, 3, data, (size_t) size);
+        originals().BufferSubData(target, offset, size, data);
+    }
+
+    static void APIENTRY captureNamedBufferStorage(GLuint buffer, GLsizeiptr size, const void* data, GLbitfield flags)
+    {
+        uint32_t args[] = {buffer, low(size), high(size), flags, data != NULL};
+        write(NAMED_BUFFER_STORAGE, args, 5, data, data != NULL ? (size_t) size : 0);
+        originals().NamedBufferStorage(buffer, size, data, flags);
+    }
+
+    static void* APIENTRY captureMapNamedBufferRange(GLuint buffer, GLintptr offset, GLsizeiptr length, GLbitfield access)
+    {
+        void* pointer = originals().MapNamedBufferRange(buffer, offset, length, access);
+        uint32_t args[] = {buffer, low(offset), high(offset), low(length), high(length), access};
+        write(MAP_NAMED_BUFFER_RANGE, args, 6);
+        if (pointer != NULL && (access & GL_MAP_WRITE_BIT))
+        {
+            // the shadow starts zeroed, the first diff stores whatever was written
+            Mapping mapping;
+            mapping.Buffer = buffer;
+            mapping.Offset = offset;
+            mapping.Pointer = (char*) pointer;
+            mapping.Persistent = (access & GL_MAP_PERSISTENT_BIT) != 0;
+            mapping.Shadow.assign((size_t) length, 0);
+            capture().Mappings.push_back(mapping);
+        }
+        return pointer;
+    }
+
+    static GLboolean APIENTRY captureUnmapNamedBuffer(GLuint buffer)
+    {
+        std::vector<Mapping> &mappings = capture().Mappings;
+        for (unsigned int i = 0; i < mappings.size(); i++)
+        {
+            if (mappings[i].Buffer == buffer)
+            {
+                diffMapping(mappings[i], capture().Stream);
+                mappings.erase(mappings.begin() + i);
+                break;
+            }
+        }
+        uint32_t args[] = {buffer};
+        write(UNMAP_NAMED_BUFFER, args, 1);
+        return originals().UnmapNamedBuffer(buffer);
+    }
+
+    static void APIENTRY captureTexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border,
+                                           GLenum format, GLenum type, const void* pixels)
+    {
+        // with a pixel unpack buffer bound, pixels is an offset into it
+        bool data = pixels != NULL && capture().UnpackBuffer == 0;
+        uint32_t args[] = {target, (uint32_t) level, (uint32_t) internalformat, (uint32_t) width, (uint32_t) height, (uint32_t) border,
+                           format, type, data};
+        write(TEX_IMAGE_2D, args, 9, pixels, data ? imageSize(width, height, format, type) : 0);
+        originals().TexImage2D(target, level, internalformat, width, height, border, format, type, pixels);
+    }
+
+    static void APIENTRY captureTextureStorage2D(GLuint texture, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height)
+    {
+        uint32_t args[] = {texture, (uint32_t) levels, internalformat, (uint32_t) width, (uint32_t) height};
+        write(TEXTURE_STORAGE_2D, args, 5);
+        originals().TextureStorage2D(texture, levels, internalformat, width, height);
+    }
+
+    static void APIENTRY captureGenerateMipmap(GLenum target)
+    {
+        uint32_t args[] = {target};
+        write(GENERATE_MIPMAP, args, 1);
+        originals().GenerateMipmap(target);
+    }
+
+    static void APIENTRY captureTexParameteri(GLenum target, GLenum pname, GLint param)
+    {
+        uint32_t args[] = {target, pname, (uint32_t) param};
+        write(TEX_PARAMETERI, args, 3);
+        originals().TexParameteri(target, pname, param);
+    }
+
+    static void APIENTRY captureTextureParameteri(GLuint texture, GLenum pname, GLint param)
+    {
+        uint32_t args[] = {texture, pname, (uint32_t) param};
+        write(TEXTURE_PARAMETERI, args, 3);
+        originals().TextureParameteri(texture, pname, param);
+    }
+
+    // vertex and framebuffer setup
+
+    static void APIENTRY captureVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer)
+    {
+        uint64_t offset = (uint64_t) (uintptr_t) pointer;
+        uint32_t args[] = {index, (uint32_t) size, type, normalized, (uint32_t) stride, low(offset), high(offset)};
+        write(VERTEX_ATTRIB_POINTER, args, 7);
+        originals().VertexAttribPointer(index, size, type, normalized, stride, pointer);
+    }
+
+    static void APIENTRY captureEnableVertexAttribArray(GLuint index)
+    {
+        uint32_t args[] = {index};
+        write(ENABLE_VERTEX_ATTRIB_ARRAY, args, 1);
+        originals().EnableVertexAttribArray(index);
+    }
+
+    static void APIENTRY captureVertexAttribDivisor(GLuint index, GLuint divisor)
+    {
+        uint32_t args[] = {index, divisor};
+        write(VERTEX_ATTRIB_DIVISOR, args, 2);
+        originals().VertexAttribDivisor(index, divisor);
+    }
+
+    static void APIENTRY captureNamedFramebufferTexture(GLuint framebuffer, GLenum attachment, GLuint texture, GLint level)
+    {
+        uint32_t args[] = {framebuffer, attachment, texture, (uint32_t) level};
+        write(NAMED_FRAMEBUFFER_TEXTURE, args, 4);
+        originals().NamedFramebufferTexture(framebuffer, attachment, texture, level);
+    }
+
+    static void APIENTRY captureNamedFramebufferDrawBuffer(GLuint framebuffer, GLenum buf)
+    {
+        uint32_t args[] = {framebuffer, buf};
+        write(NAMED_FRAMEBUFFER_DRAW_BUFFER, args, 2);
+        originals().NamedFramebufferDrawBuffer(framebuffer, buf);
+    }
+
+    static void APIENTRY captureNamedFramebufferDrawBuffers(GLuint framebuffer, GLsizei n, const GLenum* bufs)
+    {
+        uint32_t args[] = {framebuffer, (uint32_t) n};
+        write(NAMED_FRAMEBUFFER_DRAW_BUFFERS, args, 2, bufs, n > 0 ? n * sizeof(GLenum) : 0);
+        originals().NamedFramebufferDrawBuffers(framebuffer, n, bufs);
+    }
+
+    // binds
+
+    static void APIENTRY captureUseProgram(GLuint program)
+    {
+        uint32_t args[] = {program};
+        write(USE_PROGRAM, args, 1);
+        originals().UseProgram(program);
+    }
+
+    static void APIENTRY captureBindVertexArray(GLuint array)
+    {
+        uint32_t args[] = {array};
+        write(BIND_VERTEX_ARRAY, args, 1);
+        originals().BindVertexArray(array);
+    }
+
+    static void APIENTRY captureBindBuffer(GLenum target, GLuint buffer)
+    {
+        if (target == GL_PIXEL_UNPACK_BUFFER)
+            capture().UnpackBuffer = buffer;
+        uint32_t args[] = {target, buffer};
+        write(BIND_BUFFER, args, 2);
+        originals().BindBuffer(target, buffer);
+    }
+
+    static void APIENTRY captureBindBufferBase(GLenum target, GLuint index, GLuint buffer)
+    {
+        uint32_t args[] = {target, index, buffer};
+        write(BIND_BUFFER_BASE, args, 3);
+        originals().BindBufferBase(target, index, buffer);
+    }
+
+    static void APIENTRY captureBindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)
+    {
+        uint32_t args[] = {target, index, buffer, low(offset), high(offset), low(size), high(size)};
+        write(BIND_BUFFER_RANGE, args, 7);
+        originals().BindBufferRange(target, index, buffer, offset, size);
+    }
+
+    static void APIENTRY captureActiveTexture(GLenum texture)
+    {
+        uint32_t args[] = {texture};
+        write(ACTIVE_TEXTURE, args, 1);
+        originals().ActiveTexture(texture);
+    }
+
+    static void APIENTRY captureBindTexture(GLenum target, GLuint texture)
+    {
+        uint32_t args[] = {target, texture};
+        write(BIND_TEXTURE, args, 2);
+        originals().BindTexture(target, texture);
+    }
+
+    static void APIENTRY captureBindTextureUnit(GLuint unit, GLuint texture)
+    {
+        uint32_t args[] = {unit, texture};
+        write(BIND_TEXTURE_UNIT, args, 2);
+        originals().BindTextureUnit(unit, texture);
+    }
+
+    static void APIENTRY captureBindTextures(GLuint first, GLsizei count, const GLuint* textures)
+    {
+        uint32_t args[] = {first, (uint32_t) count, textures != NULL};
+        write(BIND_TEXTURES, args, 3, textures, textures != NULL && count > 0 ? count * sizeof(GLuint) : 0);
+        originals().BindTextures(first, count, textures);
+    }
+
+    static void APIENTRY captureBindSampler(GLuint unit, GLuint sampler)
+    {
+        uint32_t args[] = {unit, sampler};
+        write(BIND_SAMPLER, args, 2);
+        originals().BindSampler(unit, sampler);
+    }
+
+    static void APIENTRY captureBindFramebuffer(GLenum target, GLuint framebuffer)
+    {
+        uint32_t args[] = {target, framebuffer};
+        write(BIND_FRAMEBUFFER, args, 2);
+        originals().BindFramebuffer(target, framebuffer);
+    }
+
+    // fixed function state
+
+    static void APIENTRY captureEnable(GLenum cap)
+    {
+        uint32_t args[] = {cap};
+        write(ENABLE, args, 1);
+        originals().Enable(cap);
+    }
+
+    static void APIENTRY captureDisable(GLenum cap)
+    {
+        uint32_t args[] = {cap};
+        write(DISABLE, args, 1);
+        originals().Disable(cap);
+    }
+
+    static void APIENTRY captureBlendFunc(GLenum sfactor, GLenum dfactor)
+    {
+        uint32_t args[] = {sfactor, dfactor};
+        write(BLEND_FUNC, args, 2);
+        originals().BlendFunc(sfactor, dfactor);
+    }
+
+    static void APIENTRY captureBlendFuncSeparate(GLenum sfactorRGB, GLenum dfactorRGB, GLenum sfactorAlpha, GLenum dfactorAlpha)
+    {
+        uint32_t args[] = {sfactorRGB, dfactorRGB, sfactorAlpha, dfactorAlpha};
+        write(BLEND_FUNC_SEPARATE, args, 4);
+        originals().BlendFuncSeparate(sfactorRGB, dfactorRGB, sfactorAlpha, dfactorAlpha);
+    }
+
+    static void APIENTRY captureBlendEquation(GLenum mode)
+    {
+        uint32_t args[] = {mode};
+        write(BLEND_EQUATION, args, 1);
+        originals().BlendEquation(mode);
+    }
+
+    static void APIENTRY captureBlendEquationSeparate(GLenum modeRGB, GLenum modeAlpha)
+    {
+        uint32_t args[] = {modeRGB, modeAlpha};
+        write(BLEND_EQUATION_SEPARATE, args, 2);
+        originals().BlendEquationSeparate(modeRGB, modeAlpha);
+    }
+
+    static void APIENTRY captureDepthFunc(GLenum func)
+    {
+        uint32_t args[] = {func};
+        write(DEPTH_FUNC, args, 1);
+        originals().DepthFunc(func);
+    }
+
+    static void APIENTRY captureDepthMask(GLboolean flag)
+    {
+        uint32_t args[] = {flag};
+        write(DEPTH_MASK, args, 1);
+        originals().DepthMask(flag);
+    }
+
+    static void APIENTRY capturePolygonMode(GLenum face, GLenum mode)
+    {
+        uint32_t args[] = {face, mode};
+        write(POLYGON_MODE, args, 2);
+        originals().PolygonMode(face, mode);
+    }
+
+    static void APIENTRY captureViewport(GLint x, GLint y, GLsizei width, GLsizei height)
+    {
+        uint32_t args[] = {(uint32_t) x, (uint32_t) y, (uint32_t) width, (uint32_t) height};
+        write(VIEWPORT, args, 4);
+        originals().Viewport(x, y, width, height);
+    }
+
+    static void APIENTRY captureScissor(GLint x, GLint y, GLsizei width, GLsizei height)
+    {
+        uint32_t args[] = {(uint32_t) x, (uint32_t) y, (uint32_t) width, (uint32_t) height};
+        write(SCISSOR, args, 4);
+        originals().Scissor(x, y, width, height);
+    }
+
+    static void APIENTRY captureClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
+    {
+        uint32_t args[] = {word(red), word(green), word(blue), word(alpha)};
+        write(CLEAR_COLOR, args, 4);
+        originals().ClearColor(red, green, blue, alpha);
+    }
+
+    static void APIENTRY capturePixelStorei(GLenum pname, GLint param)
+    {
+        if (pname == GL_UNPACK_ALIGNMENT)
+            capture().UnpackAlignment = param;
+        else if (pname == GL_UNPACK_ROW_LENGTH)
+            capture().UnpackRowLength = param;
+        uint32_t args[] = {pname, (uint32_t) param};
+        write(PIXEL_STOREI, args, 2);
+        originals().PixelStorei(pname, param);
+    }
+
+    static void APIENTRY captureMemoryBarrier(GLbitfield barriers)
+    {
+        uint32_t args[] = {barriers};
+        write(MEMORY_BARRIER, args, 1);
+        originals().MemoryBarrier(barriers);
+    }
+
+    // uniforms
+
+    static void APIENTRY captureUniform1i(GLint location, GLint v0)
+    {
+        uint32_t args[] = {(uint32_t) location, (uint32_t) v0};
+        write(UNIFORM_1I, args, 2);
+        originals().Uniform1i(location, v0);
+    }
+
+    static void APIENTRY captureUniform1f(GLint location, GLfloat v0)
+    {
+        uint32_t args[] = {(uint32_t) location, word(v0)};
+        write(UNIFORM_1F, args, 2);
+        originals().Uniform1f(location, v0);
+    }
+
+    static void APIENTRY captureUniform2f(GLint location, GLfloat v0, GLfloat v1)
+    {
+        uint32_t args[] = {(uint32_t) location, word(v0), word(v1)};
+        write(UNIFORM_2F, args, 3);
+        originals().Uniform2f(location, v0, v1);
+    }
+
+    static void APIENTRY captureUniform3f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2)
+    {
+        uint32_t args[] = {(uint32_t) location, word(v0), word(v1), word(v2)};
+        write(UNIFORM_3F, args, 4);
+        originals().Uniform3f(location, v0, v1, v2);
+    }
+
+    static void APIENTRY captureUniform4f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3)
+    {
+        uint32_t args[] = {(uint32_t) location, word(v0), word(v1), word(v2), word(v3)};
+        write(UNIFORM_4F, args, 5);
+        originals().Uniform4f(location, v0, v1, v2, v3);
+    }
+
+    static void uniformArray(unsigned int call, GLint location, GLsizei count, const GLfloat* value, unsigned int components)
+    {
+        uint32_t args[] = {(uint32_t) location, (uint32_t) count};
+        write(call, args, 2, value, count > 0 ? count * components * sizeof(GLfloat) : 0);
+    }
+
+    static void APIENTRY captureUniform2fv(GLint location, GLsizei count, const GLfloat* value)
+    {
+        uniformArray(UNIFORM_2FV, location, count, value, 2);
+        originals().Uniform2fv(location, count, value);
+    }
+
+    static void APIENTRY captureUniform3fv(GLint location, GLsizei count, const GLfloat* value)
+    {
+        uniformArray(UNIFORM_3FV, location, count, value, 3);
+        originals().Uniform3fv(location, count, value);
+    }
+
+    static void APIENTRY captureUniform4fv(GLint location, GLsizei count, const GLfloat* value)
+    {
+        uniformArray(UNIFORM_4FV, location, count, value, 4);
+        originals().Uniform4fv(location, count, value);
+    }
+
+    static void uniformMatrix(unsigned int call, GLint location, GLsizei count, GLboolean transpose, const GLfloat* value, unsigned int components)
+    {
+        uint32_t args[] = {(uint32_t) location, (uint32_t) count, transpose};
+        write(call, args, 3, value, count > 0 ? count * components * sizeof(GLfloat) : 0);
+    }
+
+    static void APIENTRY captureUniformMatrix2fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+    {
+        uniformMatrix(UNIFORM_MATRIX_2FV, location, count, transpose, value, 4);
+        originals().UniformMatrix2fv(location, count, transpose, value);
+    }
+
+    static void APIENTRY captureUniformMatrix3fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+    {
+        uniformMatrix(UNIFORM_MATRIX_3FV, location, count, transpose, value, 9);
+        originals().UniformMatrix3fv(location, count, transpose, value);
+    }
+
+    static void APIENTRY captureUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+    {
+        uniformMatrix(UNIFORM_MATRIX_4FV, location, count, transpose, value, 16);
+        originals().UniformMatrix4fv(location, count, transpose, value);
+    }
+
+    static void APIENTRY captureProgramUniform1i(GLuint program, GLint location, GLint v0)
+    {
+        uint32_t args[] = {program, (uint32_t) location, (uint32_t) v0};
+        write(PROGRAM_UNIFORM_1I, args, 3);
+        originals().ProgramUniform1i(program, location, v0);
+    }
+
+    static void APIENTRY captureProgramUniform1iv(GLuint program, GLint location, GLsizei count, const GLint* value)
+    {
+        uint32_t args[] = {program, (uint32_t) location, (uint32_t) count};
+        write(PROGRAM_UNIFORM_1IV, args, 3, value, count > 0 ? count * sizeof(GLint) : 0);
+        originals().ProgramUniform1iv(program, location, count, value);
+    }
+
+    // work
+
+    static void APIENTRY captureClear(GLbitfield mask)
+    {
+        uint32_t args[] = {mask};
+        write(CLEAR, args, 1);
+        originals().Clear(mask);
+    }
+
+    static void APIENTRY captureDrawArrays(GLenum mode, GLint first, GLsizei count)
+    {
+        uint32_t args[] = {mode, (uint32_t) first, (uint32_t) count};
+        write(DRAW_ARRAYS, args, 3);
+        originals().DrawArrays(mode, first, count);
+    }
+
+    // index pointers are offsets into the bound element buffer (core profile)
+    static void APIENTRY captureDrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices)
+    {
+        uint64_t offset = (uint64_t) (uintptr_t) indices;
+        uint32_t args[] = {mode, (uint32_t) count, type, low(offset), high(offset)};
+        write(DRAW_ELEMENTS, args, 5);
+        originals().DrawElements(mode, count, type, indices);
+    }
+
+    static void APIENTRY captureDrawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type, const void* indices, GLint basevertex)
+    {
+        uint64_t offset = (uint64_t) (uintptr_t) indices;
+        uint32_t args[] = {mode, (uint32_t) count, type, low(offset), high(offset), (uint32_t) basevertex};
+        write(DRAW_ELEMENTS_BASE_VERTEX, args, 6);
+        originals().DrawElementsBaseVertex(mode, count, type, indices, basevertex);
+    }
+
+    static void APIENTRY captureDrawElementsInstancedBaseVertex(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instancecount,
+                                                                GLint basevertex)
+    {
+        uint64_t offset = (uint64_t) (uintptr_t) indices;
+        uint32_t args[] = {mode, (uint32_t) count, type, low(offset), high(offset), (uint32_t) instancecount, (uint32_t) basevertex};
+        write(DRAW_ELEMENTS_INSTANCED_BASE_VERTEX, args, 7);
+        originals().DrawElementsInstancedBaseVertex(mode, count, type, indices, instancecount, basevertex);
+    }
+
+    static void APIENTRY captureDrawElementsInstancedBaseInstance(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instancecount,
+                                                                  GLuint baseinstance)
+    {
+        uint64_t offset = (uint64_t) (uintptr_t) indices;
+        uint32_t args[] = {mode, (uint32_t) count, type, low(offset), high(offset), (uint32_t) instancecount, baseinstance};
+        write(DRAW_ELEMENTS_INSTANCED_BASE_INSTANCE, args, 7);
+        originals().DrawElementsInstancedBaseInstance(mode, count, type, indices, instancecount, baseinstance);
+    }
+
+    static void APIENTRY captureMultiDrawElementsIndirect(GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride)
+    {
+        uint64_t offset = (uint64_t) (uintptr_t) indirect;
+        uint32_t args[] = {mode, type, low(offset), high(offset), (uint32_t) drawcount, (uint32_t) stride};
+        write(MULTI_DRAW_ELEMENTS_INDIRECT, args, 6);
+        originals().MultiDrawElementsIndirect(mode, type, indirect, drawcount, stride);
+    }
+};
+#endif
@@ -0,0 +1,307 @@
+#ifndef GL_CAPTURE_FORMAT_H
+#define GL_CAPTURE_FORMAT_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+// File format of GL command captures (see GLCapture in gl_capture.h). Has no GL dependency so the offline
+// analyser (tools/gl_analyze.cpp) reads captures without a context.
+//
+// A capture is a Header followed by records. A record is a Record header, Words 32 bit arguments and Payload
+// bytes (buffer/texture data, shader source, names arrays...) padded to 4 bytes. 64 bit arguments (offsets,
+// sizes) take two words, low word first, floats are stored bit for bit. The arguments of every call are
+// listed next to it below. Object names are the ones the capturing driver returned, the replayer maps them.
+struct GLCaptureFormat
+{
+    enum
+    {
+        Version = 1
+    };
+
+    enum Call
+    {
+        // markers
+        FRAME_BEGIN,                    // frame
+        FRAME_END,                      // frame
+        MAPPED_WRITE,                   // buffer, offset (2), payload: the bytes written through a mapping
+        // objects
+        GEN_BUFFERS,                    // n, payload: names
+        CREATE_BUFFERS,                 // n, payload: names
+        DELETE_BUFFERS,                 // n, payload: names
+        GEN_VERTEX_ARRAYS,              // n, payload: names
+        DELETE_VERTEX_ARRAYS,           // n, payload: names
+        GEN_TEXTURES,                   // n, payload: names
+        CREATE_TEXTURES,                // target, n, payload: names
+        DELETE_TEXTURES,                // n, payload: names
+        CREATE_FRAMEBUFFERS,            // n, payload: names
+        DELETE_FRAMEBUFFERS,            // n, payload: names
+        CREATE_SHADER,                  // type, shader
+        SHADER_SOURCE,                  // shader, payload: the strings joined
+        COMPILE_SHADER,                 // shader
+        DELETE_SHADER,                  // shader
+        CREATE_PROGRAM,                 // program
+        ATTACH_SHADER,                  // program, shader
+        DETACH_SHADER,                  // program, shader
+        LINK_PROGRAM,                   // program
+        DELETE_PROGRAM,                 // program
+        GET_UNIFORM_LOCATION,           // program, location, payload: name
+        GET_ATTRIB_LOCATION,            // program, location, payload: name
+        // uploads
+        BUFFER_DATA,                    // target, size (2), usage, has data, payload: data
+        BUFFER_SUB_DATA,                // target, offset (2), payload: data
+        NAMED_BUFFER_STORAGE,           // buffer, size (2), flags, has data, payload: data
+        MAP_NAMED_BUFFER_RANGE,         // buffer, offset (2), length (2), access
+        UNMAP_NAMED_BUFFER,             // buffer
+        TEX_IMAGE_2D,                   // target, level, internal format, width, height, border, format, type, has data, payload: pixels
+        TEXTURE_STORAGE_2D,             // texture, levels, internal format, width, height
+        GENERATE_MIPMAP,                // target
+        TEX_PARAMETERI,                 // target, name, value
+        TEXTURE_PARAMETERI,             // texture, name, value
+        // vertex and framebuffer setup
+        VERTEX_ATTRIB_POINTER,          // index, size, type, normalized, stride, offset (2)
+        ENABLE_VERTEX_ATTRIB_ARRAY,     // index
+        VERTEX_ATTRIB_DIVISOR,          // index, divisor
+        NAMED_FRAMEBUFFER_TEXTURE,      // framebuffer, attachment, texture, level
+        NAMED_FRAMEBUFFER_DRAW_BUFFER,  // framebuffer, buffer
+        NAMED_FRAMEBUFFER_DRAW_BUFFERS, // framebuffer, n, payload: buffers
+        // binds
+        USE_PROGRAM,                    // program
+        BIND_VERTEX_ARRAY,              // array
+        BIND_BUFFER,                    // target, buffer
+        BIND_BUFFER_BASE,               // target, index, buffer
+        BIND_BUFFER_RANGE,              // target, index, buffer, offset (2), size (2)
+        ACTIVE_TEXTURE,                 // unit (GL_TEXTURE0 + i)
+        BIND_TEXTURE,                   // target, texture
+        BIND_TEXTURE_UNIT,              // unit, texture
+        BIND_TEXTURES,                  // first, count, has names, payload: names
+        BIND_SAMPLER,                   // unit, sampler
+        BIND_FRAMEBUFFER,               // target, framebuffer
+        // fixed function state
+        ENABLE,                         // capability
+        DISABLE,                        // capability
+        BLEND_FUNC,                     // source, destination
+        BLEND_FUNC_SEPARATE,            // source rgb, destination rgb, source alpha, destination alpha
+        BLEND_EQUATION,                 // mode
+        BLEND_EQUATION_SEPARATE,        // mode rgb, mode alpha
+        DEPTH_FUNC,                     // func
+        DEPTH_MASK,                     // flag
+        POLYGON_MODE,                   // face, mode
+        VIEWPORT,                       // x, y, width, height
+        SCISSOR,                        // x, y, width, height
+        CLEAR_COLOR,                    // r, g, b, a
+        PIXEL_STOREI,                   // name, value
+        MEMORY_BARRIER,                 // barriers
+        // uniforms of the current program (or the named one for PROGRAM_UNIFORM_*)
+        UNIFORM_1I,                     // location, v
+        UNIFORM_1F,                     // location, v
+        UNIFORM_2F,                     // location, x, y
+        UNIFORM_3F,                     // location, x, y, z
+        UNIFORM_4F,                     // location, x, y, z, w
+        UNIFORM_2FV,                    // location, count, payload: values
+        UNIFORM_3FV,                    // location, count, payload: values
+        UNIFORM_4FV,                    // location, count, payload: values
+        UNIFORM_MATRIX_2FV,             // location, count, transpose, payload: values
+        UNIFORM_MATRIX_3FV,             // location, count, transpose, payload: values
+        UNIFORM_MATRIX_4FV,             // location, count, transpose, payload: values
+        PROGRAM_UNIFORM_1I,             // program, location, v
+        PROGRAM_UNIFORM_1IV,            // program, location, count, payload: values
+        // work
+        CLEAR,                          // mask
+        DRAW_ARRAYS,                    // mode, first, count
+        DRAW_ELEMENTS,                  // mode, count, type, offset (2)
+        DRAW_ELEMENTS_BASE_VERTEX,      // mode, count, type, offset (2), base vertex
+        DRAW_ELEMENTS_INSTANCED_BASE_VERTEX,    // mode, count, type, offset (2), instances, base vertex
+        DRAW_ELEMENTS_INSTANCED_BASE_INSTANCE,  // mode, count, type, offset (2), instances, base instance
+        MULTI_DRAW_ELEMENTS_INDIRECT,   // mode, type, offset (2), draw count, stride
+        CALL_COUNT
+    };
+
+    // what a call does, for the analyser
+    enum Kind
+    {
+        MARKER,
+        OBJECT,
+        UPLOAD,
+        SETUP,
+        BIND,
+        STATE,
+        UNIFORM,
+        DRAW
+    };
+
+    struct Header
+    {
+        char Magic[4];          // "GLCP"
+        uint32_t Version;
+        uint32_t Width;         // size of the default framebuffer while capturing
+        uint32_t Height;
+    };
+
+    struct Record
+    {
+        uint16_t Call;
+        uint16_t Words;
+        uint32_t Payload;       // bytes, without the padding
+    };
+
+    struct CallInfo
+    {
+        const char* Name;
+        Kind Type;
+    };
+
+    static const CallInfo &Info(unsigned int call)
+    {
+        static const CallInfo calls[CALL_COUNT] = {
+                {"FrameBegin", MARKER}, {"FrameEnd", MARKER}, {"MappedWrite", UPLOAD},
+                {"glGenBuffers", OBJECT}, {"glCreateBuffers", OBJECT}, {"glDeleteBuffers", OBJECT},
+                {"glGenVertexArrays", OBJECT}, {"glDeleteVertexArrays", OBJECT}, {"glGenTextures", OBJECT},
+                {"glCreateTextures", OBJECT}, {"glDeleteTextures", OBJECT}, {"glCreateFramebuffers", OBJECT},
+                {"glDeleteFramebuffers", OBJECT}, {"glCreateShader", OBJECT}, {"glShaderSource", OBJECT},
+                {"glCompileShader", OBJECT}, {"glDeleteShader", OBJECT}, {"glCreateProgram", OBJECT},
+                {"glAttachShader", OBJECT}, {"glDetachShader", OBJECT}, {"glLinkProgram", OBJECT},
+                {"glDeleteProgram", OBJECT}, {"glGetUniformLocation", OBJECT}, {"glGetAttribLocation", OBJECT},
+                {"glBufferData", UPLOAD}, {"glBufferSubData", UPLOAD}, {"glNamedBufferStorage", UPLOAD},
+                {"glMapNamedBufferRange", UPLOAD}, {"glUnmapNamedBuffer", UPLOAD}, {"glTexImage2D", UPLOAD},
+                {"glTextureStorage2D", UPLOAD}, {"glGenerateMipmap", UPLOAD}, {"glTexParameteri", SETUP},
+                {"glTextureParameteri", SETUP},
+                {"glVertexAttribPointer", SETUP}, {"glEnableVertexAttribArray", SETUP}, {"glVertexAttribDivisor", SETUP},
+                {"glNamedFramebufferTexture", SETUP}, {"glNamedFramebufferDrawBuffer", SETUP},
+                {"glNamedFramebufferDrawBuffers", SETUP},
+                {"glUseProgram", BIND}, {"glBindVertexArray", BIND}, {"glBindBuffer", BIND}, {"glBindBufferBase", BIND},
+                {"glBindBufferRange", BIND}, {"glActiveTexture", BIND}, {"glBindTexture", BIND},
+                {"glBindTextureUnit", BIND}, {"glBindTextures", BIND}, {"glBindSampler", BIND},
+                {"glBindFramebuffer", BIND},
+                {"glEnable", STATE}, {"glDisable", STATE}, {"glBlendFunc", STATE}, {"glBlendFuncSeparate", STATE},
+                {"glBlendEquation", STATE}, {"glBlendEquationSeparate", STATE}, {"glDepthFunc", STATE},
+                {"glDepthMask", STATE}, {"glPolygonMode", STATE}, {"glViewport", STATE}, {"glScissor", STATE},
+                {"glClearColor", STATE}, {"glPixelStorei", STATE}, {"glMemoryBarrier", STATE},
+                {"glUniform1i", UNIFORM}, {"glUniform1f", UNIFORM}, {"glUniform2f", UNIFORM}, {"glUniform3f", UNIFORM},
+                {"glUniform4f", UNIFORM}, {"glUniform2fv", UNIFORM}, {"glUniform3fv", UNIFORM}, {"glUniform4fv", UNIFORM},
+                {"glUniformMatrix2fv", UNIFORM}, {"glUniformMatrix3fv", UNIFORM}, {"glUniformMatrix4fv", UNIFORM},
+                {"glProgramUniform1i", UNIFORM}, {"glProgramUniform1iv", UNIFORM},
+                {"glClear", DRAW}, {"glDrawArrays", DRAW}, {"glDrawElements", DRAW}, {"glDrawElementsBaseVertex", DRAW},
+                {"glDrawElementsInstancedBaseVertex", DRAW}, {"glDrawElementsInstancedBaseInstance", DRAW},
+                {"glMultiDrawElementsIndirect", DRAW}
+        };
+        static const CallInfo unknown = {"unknown", MARKER};
+        return call < CALL_COUNT ? calls[call] : unknown;
+    }
+};
+
+// One decoded record, pointing into the capture's memory.
+struct GLCaptureCommand
+{
+    unsigned int Call;
+    unsigned int Words;
+    const uint32_t* Args;
+    const char* Payload;
+    uint32_t PayloadSize;
+
+    uint32_t U32(unsigned int i) const
+    {
+        return i < Words ? Args[i] : 0;
+    }
+
+    int32_t I32(unsigned int i) const
+    {
+        return (int32_t) U32(i);
+    }
+
+    float F32(unsigned int i) const
+    {
+        uint32_t word = U32(i);
+        float value;
+        std::memcpy(&value, &word, sizeof(value));
+        return value;
+    }
+
+    // a 64 bit argument starting at word i
+    uint64_t U64(unsigned int i) const
+    {
+        return (uint64_t) U32(i) | ((uint64_t) U32(i + 1) << 32);
+    }
+};
+
+// Reads a whole capture into memory and walks its records.
+class GLCaptureReader
+{
+public:
+    GLCaptureReader() : offset(0)
+    {
+        std::memset(&header, 0, sizeof(header));
+    }
+
+    bool Open(const char* path)
+    {
+        FILE* file = std::fopen(path, "rb");
+        if (file == NULL)
+        {
+            std::cout << "ERROR::GL_CAPTURE::FAILED_TO_OPEN " << path << std::endl;
+            return false;
+        }
+        std::fseek(file, 0, SEEK_END);
+        long size = std::ftell(file);
+        std::fseek(file, 0, SEEK_SET);
+        data.resize(size > 0 ? (size_t) size : 0);
+        size_t read = data.empty() ? 0 : std::fread(&data[0], 1, data.size(), file);
+        std::fclose(file);
+
+        if (read != data.size() || data.size() < sizeof(header))
+        {
+            std::cout << "ERROR::GL_CAPTURE::TRUNCATED " << path << std::endl;
+            return false;
+        }
+        std::memcpy(&header, &data[0], sizeof(header));
+        if (std::memcmp(header.Magic, "GLCP", 4) != 0 || header.Version != GLCaptureFormat::Version)
+        {
+            std::cout << "ERROR::GL_CAPTURE::NOT_A_CAPTURE " << path << std::endl;
+            return false;
+        }
+        Rewind();
+        return true;
+    }
+
+    const GLCaptureFormat::Header &Header() const
+    {
+        return header;
+    }
+
+    void Rewind()
+    {
+        offset = sizeof(GLCaptureFormat::Header);
+    }
+
+    // the next record, false at the end (or at a record cut short).
+    bool Next(GLCaptureCommand &command)
+    {
+        if (offset + sizeof(GLCaptureFormat::Record) > data.size())
+            return false;
+        GLCaptureFormat::Record record;
+        std::memcpy(&record, &data[offset], sizeof(record));
+        size_t arguments = offset + sizeof(record);
+        size_t payload = arguments + record.Words * sizeof(uint32_t);
+        size_t end = payload + ((record.Payload + 3) & ~3u);
+        if (end > data.size())
+        {
+            std::cout << "ERROR::GL_CAPTURE::TRUNCATED_RECORD at " << offset << std::endl;
+            return false;
+        }
+        command.Call = record.Call;
+        command.Words = record.Words;
+        command.Args = (const uint32_t*) &data[arguments];
+        command.Payload = &data[payload];
+        command.PayloadSize = record.Payload;
+        offset = end;
+        return true;
+    }
+
+private:
+    std::vector<char> data;
+    size_t offset;
+    GLCaptureFormat::Header header;
+};
+#endif
@@ -0,0 +1,513 @@
+#ifndef GL_STATE_CACHE_H
+#define GL_STATE_CACHE_H
+
+#include <glad/glad.h>
+
+#include <cstring>
+#include <unordered_map>
+
+// Redundant state elimination between our code and glad. Install() swaps the glad function pointers of the
+// binding/state calls for wrappers that remember the current value and only forward a call to the driver
+// when it actually changes something, so none of the call sites have to change. Every wrapped call is
+// counted as issued or elided.
+//
+// The cache only sees calls made through glad. Code that changes state behind its back (another loader,
+// a query that resets bindings...) must call Invalidate() afterwards.
+class GLStateCache
+{
+public:
+    enum Call
+    {
+        USE_PROGRAM,
+        BIND_VERTEX_ARRAY,
+        BIND_BUFFER,
+        ACTIVE_TEXTURE,
+        BIND_TEXTURE,
+        BIND_TEXTURE_UNIT,
+        ENABLE,
+        DISABLE,
+        BLEND_FUNC,
+        DEPTH_FUNC,
+        DEPTH_MASK,
+        CALL_COUNT
+    };
+
+    struct Counter
+    {
+        unsigned int Issued;
+        unsigned int Elided;
+    };
+
+    struct Counters
+    {
+        Counter Calls[CALL_COUNT];
+
+        unsigned int Issued() const
+        {
+            unsigned int total = 0;
+            for (int i = 0; i < CALL_COUNT; i++)
+                total += Calls[i].Issued;
+            return total;
+        }
+        unsigned int Elided() const
+        {
+            unsigned int total = 0;
+            for (int i = 0; i < CALL_COUNT; i++)
+                total += Calls[i].Elided;
+            return total;
+        }
+    };
+
+    // call once after gladLoadGLLoader, with the context current.
+    static void Install()
+    {
+        Originals &gl = originals();
+        if (gl.installed)
+            return;
+        gl.useProgram = glad_glUseProgram;
+        gl.bindVertexArray = glad_glBindVertexArray;
+        gl.bindBuffer = glad_glBindBuffer;
+        gl.bindBufferBase = glad_glBindBufferBase;
+        gl.bindBufferRange = glad_glBindBufferRange;
+        gl.activeTexture = glad_glActiveTexture;
+        gl.bindTexture = glad_glBindTexture;
+        gl.bindTextureUnit = glad_glBindTextureUnit;
+        gl.enable = glad_glEnable;
+        gl.disable = glad_glDisable;
+        gl.blendFunc = glad_glBlendFunc;
+        gl.blendFuncSeparate = glad_glBlendFuncSeparate;
+        gl.depthFunc = glad_glDepthFunc;
+        gl.depthMask = glad_glDepthMask;
+        gl.deleteVertexArrays = glad_glDeleteVertexArrays;
+        gl.deleteBuffers = glad_glDeleteBuffers;
+        gl.deleteTextures = glad_glDeleteTextures;
+        gl.createTextures = glad_glCreateTextures;
+
+        glad_glUseProgram = useProgram;
+        glad_glBindVertexArray = bindVertexArray;
+        glad_glBindBuffer = bindBuffer;
+        glad_glBindBufferBase = bindBufferBase;
+        glad_glBindBufferRange = bindBufferRange;
+        glad_glActiveTexture = activeTexture;
+        glad_glBindTexture = bindTexture;
+        glad_glBindTextureUnit = bindTextureUnit;
+        glad_glEnable = enable;
+        glad_glDisable = disable;
+        glad_glBlendFunc = blendFunc;
+        glad_glBlendFuncSeparate = blendFuncSeparate;
+        glad_glDepthFunc = depthFunc;
+        glad_glDepthMask = depthMask;
+        glad_glDeleteVertexArrays = deleteVertexArrays;
+        glad_glDeleteBuffers = deleteBuffers;
+        glad_glDeleteTextures = deleteTextures;
+        glad_glCreateTextures = createTextures;
+        gl.installed = true;
+        Invalidate();
+    }
+
+    // puts the original glad pointers back.
+    static void Uninstall()
+    {
+        Originals &gl = originals();
+        if (!gl.installed)
+            return;
+        glad_glUseProgram = gl.useProgram;
+        glad_glBindVertexArray = gl.bindVertexArray;
+        glad_glBindBuffer = gl.bindBuffer;
+        glad_glBindBufferBase = gl.bindBufferBase;
+        glad_glBindBufferRange = gl.bindBufferRange;
+        glad_glActiveTexture = gl.activeTexture;
+        glad_glBindTexture = gl.bindTexture;
+        glad_glBindTextureUnit = gl.bindTextureUnit;
+        glad_glEnable = gl.enable;
+        glad_glDisable = gl.disable;
+        glad_glBlendFunc = gl.blendFunc;
+        glad_glBlendFuncSeparate = gl.blendFuncSeparate;
+        glad_glDepthFunc = gl.depthFunc;
+        glad_glDepthMask = gl.depthMask;
+        glad_glDeleteVertexArrays = gl.deleteVertexArrays;
+        glad_glDeleteBuffers = gl.deleteBuffers;
+        glad_glDeleteTextures = gl.deleteTextures;
+        glad_glCreateTextures = gl.createTextures;
+        gl.installed = false;
+    }
+
+    // forgets everything, the next call of each kind goes to the driver.
+    static void Invalidate()
+    {
+        State &state = current();
+        std::memset(&state, 0xFF, sizeof(state));
+    }
+
+    // closes the frame: the counters move to LastFrame() and start again from zero.
+    static void EndFrame()
+    {
+        lastFrame() = frame();
+        std::memset(&frame(), 0, sizeof(Counters));
+    }
+
+    // counters of the frame in progress
+    static const Counters &Frame()
+    {
+        return frame();
+    }
+
+    // counters of the last frame closed with EndFrame()
+    static const Counters &LastFrame()
+    {
+        return lastFrame();
+    }
+
+    static const char* CallName(Call call)
+    {
+        static const char* names[CALL_COUNT] = {
+                "glUseProgram", "glBindVertexArray", "glBindBuffer", "glActiveTexture", "glBindTexture",
+                "glBindTextureUnit", "glEnable", "glDisable", "glBlendFunc", "glDepthFunc", "glDepthMask"
+        };
+        return names[call];
+    }
+
+private:
+    static const GLuint UNKNOWN = 0xFFFFFFFFu;
+    static const int MAX_UNITS = 32;
+
+    enum BufferTarget { ARRAY, ELEMENT_ARRAY, UNIFORM, SHADER_STORAGE, DRAW_INDIRECT, COPY_READ, COPY_WRITE, PIXEL_UNPACK, PIXEL_PACK, BUFFER_TARGETS };
+    enum TextureTarget { TEXTURE_2D, TEXTURE_CUBE_MAP, TEXTURE_2D_ARRAY, TEXTURE_3D, TEXTURE_TARGETS };
+    enum Capability { BLEND, DEPTH_TEST, CULL_FACE, SCISSOR_TEST, STENCIL_TEST, CAPABILITIES };
+
+    // every field is UNKNOWN after Invalidate()
+    struct State
+    {
+        GLuint program;
+        GLuint vertexArray;
+        GLuint buffers[BUFFER_TARGETS];
+        GLuint activeTexture;
+        GLuint textures[MAX_UNITS][TEXTURE_TARGETS];
+        GLuint capabilities[CAPABILITIES];
+        GLuint blendSource, blendDestination;
+        GLuint depthFunc;
+        GLuint depthMask;
+    };
+
+    struct Originals
+    {
+        bool installed;
+        PFNGLUSEPROGRAMPROC useProgram;
+        PFNGLBINDVERTEXARRAYPROC bindVertexArray;
+        PFNGLBINDBUFFERPROC bindBuffer;
+        PFNGLBINDBUFFERBASEPROC bindBufferBase;
+        PFNGLBINDBUFFERRANGEPROC bindBufferRange;
+        PFNGLACTIVETEXTUREPROC activeTexture;
+        PFNGLBINDTEXTUREPROC bindTexture;
+        PFNGLBINDTEXTUREUNITPROC bindTextureUnit;
+        PFNGLENABLEPROC enable;
+        PFNGLDISABLEPROC disable;
+        PFNGLBLENDFUNCPROC blendFunc;
+        PFNGLBLENDFUNCSEPARATEPROC blendFuncSeparate;
+        PFNGLDEPTHFUNCPROC depthFunc;
+        PFNGLDEPTHMASKPROC depthMask;
+        PFNGLDELETEVERTEXARRAYSPROC deleteVertexArrays;
+        PFNGLDELETEBUFFERSPROC deleteBuffers;
+        PFNGLDELETETEXTURESPROC deleteTextures;
+        PFNGLCREATETEXTURESPROC createTextures;
+    };
+
+    static Originals &originals()
+    {
+        static Originals gl = Originals();
+        return gl;
+    }
+
+    static State &current()
+    {
+        static State state;
+        return state;
+    }
+
+    static Counters &frame()
+    {
+        static Counters counters = {};
+        return counters;
+    }
+
+    static Counters &lastFrame()
+    {
+        static Counters counters = {};
+        return counters;
+    }
+
+    // the target each texture was first bound to, glBindTextureUnit needs it to find the cache slot
+    static std::unordered_map<GLuint, int> &textureTargets()
+    {
+        static std::unordered_map<GLuint, int> targets;
+        return targets;
+    }
+
+    // updates a cached value, returns true if the call has to reach the driver.
+    static bool change(GLuint &cached, GLuint value, Call call)
+    {
+        if (cached == value)
+        {
+            frame().Calls[call].Elided++;
+            return false;
+        }
+        cached = value;
+        frame().Calls[call].Issued++;
+        return true;
+    }
+
+    static int bufferTarget(GLenum target)
+    {
+        switch (target)
+        {
+            case GL_ARRAY_BUFFER: return ARRAY;
+            case GL_ELEMENT_ARRAY_BUFFER: return ELEMENT_ARRAY;
+            case GL_UNIFORM_BUFFER: return UNIFORM;
+            case GL_SHADER_STORAGE_BUFFER: return SHADER_STORAGE;
+            case GL_DRAW_INDIRECT_BUFFER: return DRAW_INDIRECT;
+            case GL_COPY_READ_BUFFER: return COPY_READ;
+            case GL_COPY_WRITE_BUFFER: return COPY_WRITE;
+            case GL_PIXEL_UNPACK_BUFFER: return PIXEL_UNPACK;
+            case GL_PIXEL_PACK_BUFFER: return PIXEL_PACK;
+            default: return -1;
+        }
+    }
+
+    static int textureTarget(GLenum target)
+    {
+        switch (target)
+        {
+            case GL_TEXTURE_2D: return TEXTURE_2D;
+            case GL_TEXTURE_CUBE_MAP: return TEXTURE_CUBE_MAP;
+            case GL_TEXTURE_2D_ARRAY: return TEXTURE_2D_ARRAY;
+            case GL_TEXTURE_3D: return TEXTURE_3D;
+            default: return -1;
+        }
+    }
+
+    static int capability(GLenum cap)
+    {
+        switch (cap)
+        {
+            case GL_BLEND: return BLEND;
+            case GL_DEPTH_TEST: return DEPTH_TEST;
+            case GL_CULL_FACE: return CULL_FACE;
+            case GL_SCISSOR_TEST: return SCISSOR_TEST;
+            case GL_STENCIL_TEST: return STENCIL_TEST;
+            default: return -1;
+        }
+    }
+
+    static void APIENTRY useProgram(GLuint program)
+    {
+        if (change(current().program, program, USE_PROGRAM))
+            originals().useProgram(program);
+    }
+
+    static void APIENTRY bindVertexArray(GLuint array)
+    {
+        if (change(current().vertexArray, array, BIND_VERTEX_ARRAY))
+        {
+            // the element array binding is part of the VAO
+            current().buffers[ELEMENT_ARRAY] = UNKNOWN;
+            originals().bindVertexArray(array);
+        }
+    }
+
+    static void APIENTRY bindBuffer(GLenum target, GLuint buffer)
+    {
+        int slot = bufferTarget(target);
+        if (slot < 0)
+        {
+            frame().Calls[BIND_BUFFER].Issued++;
+            originals().bindBuffer(target, buffer);
+        }
+        else if (change(current().buffers[slot], buffer, BIND_BUFFER))
+            originals().bindBuffer(target, buffer);
+    }
+
+    // indexed binds are always forwarded, they also change the generic binding of the target
+    static void APIENTRY bindBufferBase(GLenum target, GLuint index, GLuint buffer)
+    {
+        int slot = bufferTarget(target);
+        if (slot >= 0)
+            current().buffers[slot] = buffer;
+        originals().bindBufferBase(target, index, buffer);
+    }
+
+    static void APIENTRY bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)
+    {
+        int slot = bufferTarget(target);
+        if (slot >= 0)
+            current().buffers[slot] = buffer;
+        originals().bindBufferRange(target, index, buffer, offset, size);
+    }
+
+    static void APIENTRY activeTexture(GLenum texture)
+    {
+        if (change(current().activeTexture, texture, ACTIVE_TEXTURE))
+            originals().activeTexture(texture);
+    }
+
+    static void APIENTRY bindTexture(GLenum target, GLuint texture)
+    {
+        int slot = textureTarget(target);
+        GLuint unit = current().activeTexture - GL_TEXTURE0;
+        // find before insert: libstdc++ builds the node (a heap allocation) even when the key exists
+        if (texture != 0 && slot >= 0 && textureTargets().find(texture) == textureTargets().end())
+            textureTargets().insert(std::make_pair(texture, slot));
+        if (slot < 0 || unit >= MAX_UNITS)
+        {
+            frame().Calls[BIND_TEXTURE].Issued++;
+            originals().bindTexture(target, texture);
+        }
+        else if (change(current().textures[unit][slot], texture, BIND_TEXTURE))
+            originals().bindTexture(target, texture);
+    }
+
+    static void APIENTRY bindTextureUnit(GLuint unit, GLuint texture)
+    {
+        std::unordered_map<GLuint, int>::iterator target = textureTargets().find(texture);
+        if (unit >= MAX_UNITS || target == textureTargets().end())
+        {
+            // target unknown (or unbinding every target): forward and forget the unit
+            frame().Calls[BIND_TEXTURE_UNIT].Issued++;
+            if (unit < MAX_UNITS)
+            {
+                for (int i = 0; i < TEXTURE_TARGETS; i++)
+                    current().textures[unit][i] = texture == 0 ? 0 : UNKNOWN;
+            }
+            originals().bindTextureUnit(unit, texture);
+        }
+        else if (change(current().textures[unit][target->second], texture, BIND_TEXTURE_UNIT))
+            originals().bindTextureUnit(unit, texture);
+    }
+
+    static void APIENTRY enable(GLenum cap)
+    {
+        int slot = capability(cap);
+        if (slot < 0)
+        {
+            frame().Calls[ENABLE].Issued++;
+            originals().enable(cap);
+        }
+        else if (change(current().capabilities[slot], GL_TRUE, ENABLE))
+            originals().enable(cap);
+    }
+
+    static void APIENTRY disable(GLenum cap)
+    {
+        int slot = capability(cap);
+        if (slot < 0)
+        {
+            frame().Calls[DISABLE].Issued++;
+            originals().disable(cap);
+        }
+        else if (change(current().capabilities[slot], GL_FALSE, DISABLE))
+            originals().disable(cap);
+    }
+
+    static void APIENTRY blendFunc(GLenum sfactor, GLenum dfactor)
+    {
+        State &state = current();
+        if (state.blendSource == sfactor && state.blendDestination == dfactor)
+        {
+            frame().Calls[BLEND_FUNC].Elided++;
+            return;
+        }
+        state.blendSource = sfactor;
+        state.blendDestination = dfactor;
+        frame().Calls[BLEND_FUNC].Issued++;
+        originals().blendFunc(sfactor, dfactor);
+    }
+
+    // the cache only holds factors shared by color and alpha (what glBlendFunc sets), anything else forgets them
+    static void APIENTRY blendFuncSeparate(GLenum sfactorRGB, GLenum dfactorRGB, GLenum sfactorAlpha, GLenum dfactorAlpha)
+    {
+        if (sfactorRGB == sfactorAlpha && dfactorRGB == dfactorAlpha)
+        {
+            State &state = current();
+            if (state.blendSource == sfactorRGB && state.blendDestination == dfactorRGB)
+            {
+                frame().Calls[BLEND_FUNC].Elided++;
+                return;
+            }
+            state.blendSource = sfactorRGB;
+            state.blendDestination = dfactorRGB;
+        }
+        else
+            current().blendSource = current().blendDestination = UNKNOWN;
+        frame().Calls[BLEND_FUNC].Issued++;
+        originals().blendFuncSeparate(sfactorRGB, dfactorRGB, sfactorAlpha, dfactorAlpha);
+    }
+
+    static void APIENTRY depthFunc(GLenum func)
+    {
+        if (change(current().depthFunc, func, DEPTH_FUNC))
+            originals().depthFunc(func);
+    }
+
+    static void APIENTRY depthMask(GLboolean flag)
+    {
+        if (change(current().depthMask, flag, DEPTH_MASK))
+            originals().depthMask(flag);
+    }
+
+    // deleting a bound object reverts its binding to 0, keep the cache in sync with that
+    static void APIENTRY deleteVertexArrays(GLsizei n, const GLuint* arrays)
+    {
+        for (GLsizei i = 0; i < n; i++)
+        {
+            if (current().vertexArray == arrays[i])
+            {
+                current().vertexArray = 0;
+                current().buffers[ELEMENT_ARRAY] = UNKNOWN;
+            }
+        }
+        originals().deleteVertexArrays(n, arrays);
+    }
+
+    static void APIENTRY deleteBuffers(GLsizei n, const GLuint* buffers)
+    {
+        State &state = current();
+        for (GLsizei i = 0; i < n; i++)
+        {
+            for (int t = 0; t < BUFFER_TARGETS; t++)
+            {
+                if (state.buffers[t] == buffers[i])
+                    state.buffers[t] = 0;
+            }
+        }
+        originals().deleteBuffers(n, buffers);
+    }
+
+    // DSA textures are never bound with glBindTexture, their target has to be known from creation
+    static void APIENTRY createTextures(GLenum target, GLsizei n, GLuint* textures)
+    {
+        originals().createTextures(target, n, textures);
+        int slot = textureTarget(target);
+        if (slot < 0)
+            return;
+        for (GLsizei i = 0; i < n; i++)
+            textureTargets()[textures[i]] = slot;
+    }
+
+    static void APIENTRY deleteTextures(GLsizei n, const GLuint* textures)
+    {
+        State &state = current();
+        for (GLsizei i = 0; i < n; i++)
+        {
+            textureTargets().erase(textures[i]);
+            for (int unit = 0; unit < MAX_UNITS; unit++)
+            {
+                for (int t = 0; t < TEXTURE_TARGETS; t++)
+                {
+                    if (state.textures[unit][t] == textures[i])
+                        state.textures[unit][t] = 0;
+                }
+            }
+        }
+        originals().deleteTextures(n, textures);
+    }
+};
+#endif
@@ -0,0 +1,202 @@
+#ifndef GPU_PROFILER_H
+#define GPU_PROFILER_H
+
+#include <glad/glad.h>
+
+#include <learnopengl/profile_tree.h>
+
+#include <iostream>
+#include <vector>
+
+// Scoped GPU timings from GL_TIMESTAMP queries. A scope issues a timestamp when it opens and one when it
+// closes, so scopes nest freely (GL_TIME_ELAPSED queries can't). Each frame records into its own slot of a
+// ring Latency frames deep, and a slot is only read back when it comes around again, by which point the GPU
+// has normally finished it. Reading never waits: a slot still unfinished when it is needed again is dropped
+// and counted in Dropped().
+//
+//     profiler.BeginFrame();
+//     {
+//         GpuZone zone(profiler, "scene");
+//         ...
+//     }
+//     profiler.EndFrame();
+//
+// Names must outlive the profiler (string literals). Results land in Tree(), Latency - 1 frames late.
+class GpuProfiler
+{
+public:
+    explicit GpuProfiler(unsigned int latency = 4) : current(0), open(-1), dropped(0), recording(false)
+    {
+        frames.resize(latency < 2 ? 2 : latency);
+    }
+
+    ~GpuProfiler()
+    {
+        for (unsigned int i = 0; i < frames.size(); i++)
+        {
+            if (!frames[i].Queries.empty())
+                glDeleteQueries((GLsizei) frames[i].Queries.size(), &frames[i].Queries[0]);
+        }
+    }
+
+    unsigned int Latency() const
+    {
+        return (unsigned int) frames.size();
+    }
+
+    void BeginFrame()
+    {
+        current = (current + 1) % frames.size();
+        Frame &frame = frames[current];
+        if (frame.Pending && !resolve(frame))
+            dropped++;
+        frame.Scopes.clear();
+        frame.Used = 0;
+        frame.Pending = false;
+        open = -1;
+        recording = true;
+    }
+
+    void Push(const char* name)
+    {
+        if (!recording)
+            return;
+        Frame &frame = frames[current];
+        Scope scope = {name, open, query(frame), 0};
+        glQueryCounter(frame.Queries[scope.Begin], GL_TIMESTAMP);
+        frame.Scopes.push_back(scope);
+        open = (int) frame.Scopes.size() - 1;
+    }
+
+    void Pop()
+    {
+        if (!recording || open < 0)
+            return;
+        Frame &frame = frames[current];
+        Scope &scope = frame.Scopes[open];
+        scope.End = query(frame);
+        glQueryCounter(frame.Queries[scope.End], GL_TIMESTAMP);
+        open = scope.Parent;
+    }
+
+    void EndFrame()
+    {
+        if (!recording)
+            return;
+        if (open >= 0)
+        {
+            std::cout << "ERROR::GPU_PROFILER::UNBALANCED_SCOPES" << std::endl;
+            while (open >= 0)
+                Pop();
+        }
+        frames[current].Pending = !frames[current].Scopes.empty();
+        recording = false;
+    }
+
+    // frames whose queries weren't ready when their slot was reused.
+    unsigned int Dropped() const
+    {
+        return dropped;
+    }
+
+    const ProfileTree &Tree() const
+    {
+        return tree;
+    }
+
+    std::string ToJSON() const
+    {
+        return tree.ToJSON();
+    }
+
+private:
+    struct Scope
+    {
+        const char* Name;
+        int Parent;
+        unsigned int Begin;     // query indices in the frame
+        unsigned int End;
+    };
+
+    struct Frame
+    {
+        Frame() : Used(0), Pending(false)
+        {
+        }
+
+        std::vector<Scope> Scopes;
+        std::vector<GLuint> Queries;
+        unsigned int Used;
+        bool Pending;
+    };
+
+    std::vector<Frame> frames;
+    unsigned int current;
+    int open;
+    unsigned int dropped;
+    bool recording;
+    ProfileTree tree;
+    std::vector<int> nodes;     // tree node of every scope while resolving
+
+    // the next free query of the frame, more are created when the frame has more scopes than ever before.
+    unsigned int query(Frame &frame)
+    {
+        if (frame.Used == frame.Queries.size())
+        {
+            size_t previous = frame.Queries.size();
+            frame.Queries.resize(previous + 16);
+            glGenQueries(16, &frame.Queries[previous]);
+        }
+        return frame.Used++;
+    }
+
+    // reads the frame's timestamps into the tree, false when the GPU hasn't finished them yet.
+    bool resolve(Frame &frame)
+    {
+        // timestamps complete in order, the last one being there means all are
+        GLuint available = 0;
+        glGetQueryObjectuiv(frame.Queries[frame.Used - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            return false;
+
+        tree.BeginFrame();
+        nodes.resize(frame.Scopes.size());
+        for (unsigned int i = 0; i < frame.Scopes.size(); i++)
+        {
+            const Scope &scope = frame.Scopes[i];
+            GLuint64 begin = 0, end = 0;
+            glGetQueryObjectui64v(frame.Queries[scope.Begin], GL_QUERY_RESULT, &begin);
+            glGetQueryObjectui64v(frame.Queries[scope.End], GL_QUERY_RESULT, &end);
+            nodes[i] = tree.Node(scope.Parent >= 0 ? nodes[scope.Parent] : -1, scope.Name);
+            tree.Add(nodes[i], end > begin ? (end - begin) / 1000000.0 : 0.0);
+        }
+        tree.EndFrame();
+        return true;
+    }
+
+    // owns GL objects, not copyable
+    GpuProfiler(const GpuProfiler &);
+    GpuProfiler &operator=(const GpuProfiler &);
+};
+
+// opens a GPU scope for the lifetime of the object.
+class GpuZone
+{
+public:
+    GpuZone(GpuProfiler &profiler, const char* name) : profiler(profiler)
+    {
+        profiler.Push(name);
+    }
+
+    ~GpuZone()
+    {
+        profiler.Pop();
+    }
+
+private:
+    GpuProfiler &profiler;
+
+    GpuZone(const GpuZone &);
+    GpuZone &operator=(const GpuZone &);
+};
+#endif
@@ -0,0 +1,79 @@
+#ifndef INSTANCE_BUFFER_H
+#define INSTANCE_BUFFER_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <learnopengl/stream_buffer.h>
+
+// vertex attribute locations used by the per instance model matrix (one vec4 column each).
+const unsigned int INSTANCE_MATRIX_LOCATION = 5;
+
+// Per instance model matrices for instanced draws, streamed through a StreamBuffer (persistently mapped,
+// fenced per region) so updates are plain writes, no glBufferSubData.
+//
+// Every Map() starts a new frame of the stream and hands out room for Capacity matrices in it. Draws pick the
+// current block through their base instance (see BaseInstance()), so the vertex attribute setup never changes.
+// Use one region for data written once.
+class InstanceBuffer
+{
+public:
+    unsigned int ID;
+    unsigned int Capacity;
+    unsigned int Regions;
+
+    InstanceBuffer(unsigned int capacity, unsigned int regions = 3) : stream((GLsizeiptr) capacity * sizeof(glm::mat4), regions), count(0)
+    {
+        ID = stream.ID;
+        Capacity = capacity;
+        Regions = regions;
+        allocation.Data = nullptr;
+        allocation.Offset = 0;
+    }
+
+    // moves to the next region and returns where to write its Capacity matrices.
+    glm::mat4* Map()
+    {
+        stream.BeginFrame();
+        // matrix aligned so the offset is a whole number of instances
+        allocation = stream.Allocate((GLsizeiptr) Capacity * sizeof(glm::mat4), sizeof(glm::mat4));
+        return (glm::mat4*) allocation.Data;
+    }
+
+    // number of matrices written in the current region.
+    void Commit(unsigned int count)
+    {
+        this->count = count < Capacity ? count : Capacity;
+    }
+
+    // call after the draws reading the current region have been issued.
+    void Fence()
+    {
+        stream.EndFrame();
+    }
+
+    unsigned int Count() const
+    {
+        return count;
+    }
+
+    unsigned int BaseInstance() const
+    {
+        return (unsigned int) (allocation.Offset / sizeof(glm::mat4));
+    }
+
+    const StreamBufferStats &Stats() const
+    {
+        return stream.Stats();
+    }
+
+private:
+    StreamBuffer stream;
+    StreamAllocation allocation;
+    unsigned int count;
+
+    // owns GL objects, not copyable
+    InstanceBuffer(const InstanceBuffer &);
+    InstanceBuffer &operator=(const InstanceBuffer &);
+};
+#endif
@@ -0,0 +1,237 @@
+#ifndef LINEAR_ARENA_H
+#define LINEAR_ARENA_H
+
+#include <learnopengl/memory_tracker.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+// Bump allocator for scratch memory that dies all at once, like the staging data of a model import.
+// Allocations are carved out of large blocks and never freed one by one; Rewind() gives back everything
+// allocated since a Mark() (LinearArenaScope does it for a scope), Reset() makes the whole arena available
+// again. The blocks stay allocated between resets, so a loader that runs load after load doesn't leave holes
+// of every vertex and index array it ever staged in the heap.
+//
+// Not thread safe: every thread uses its own arena, ThreadScratch() gives the calling thread's one.
+class LinearArena
+{
+public:
+    explicit LinearArena(size_t blockSize = 1 << 20) : blockSize(blockSize), current(0), offset(0), used(0), peak(0)
+    {
+    }
+
+    ~LinearArena()
+    {
+        Release();
+    }
+
+    // the arena of the calling thread, for loaders running on workers
+    static LinearArena &ThreadScratch()
+    {
+        static thread_local LinearArena arena;
+        return arena;
+    }
+
+    // size bytes aligned to align (a power of two), never null: throws std::bad_alloc like operator new.
+    void* Allocate(size_t size, size_t align = alignof(std::max_align_t))
+    {
+        while (current < blocks.size())
+        {
+            uintptr_t base = (uintptr_t) blocks[current].Data;
+            uintptr_t start = (base + offset + align - 1) & ~(uintptr_t) (align - 1);
+            if (start + size <= base + blocks[current].Size)
+            {
+                used += start + size - (base + offset);
+                peak = used > peak ? used : peak;
+                offset = start + size - base;
+                return (void*) start;
+            }
+            // the rest of this block is wasted until a rewind before it
+            current++;
+            offset = 0;
+        }
+        addBlock(size + align);
+        return Allocate(size, align);
+    }
+
+    // position of the next allocation, to rewind to
+    struct Marker
+    {
+        unsigned int Block;
+        size_t Offset;
+        size_t Used;
+    };
+
+    Marker Mark() const
+    {
+        Marker marker;
+        marker.Block = current;
+        marker.Offset = offset;
+        marker.Used = used;
+        return marker;
+    }
+
+    // makes the allocations made since marker invalid, the ones before it stay. Markers have to be rewound to
+    // in reverse order; a rewind to an empty arena is a Reset().
+    void Rewind(const Marker &marker)
+    {
+        if (marker.Used == 0)
+        {
+            Reset();
+            return;
+        }
+        current = marker.Block;
+        offset = marker.Offset;
+        used = marker.Used;
+    }
+
+    // makes every allocation invalid. Blocks are kept for the next use, merged into a single one so a load of
+    // the same size fits in it next time.
+    void Reset()
+    {
+        if (blocks.size() > 1)
+        {
+            size_t total = Capacity();
+            Release();
+            addBlock(total);
+        }
+        current = 0;
+        offset = 0;
+        used = 0;
+    }
+
+    // gives every block back to the heap.
+    void Release()
+    {
+        for (unsigned int i = 0; i < blocks.size(); i++)
+            std::free(blocks[i].Data);
+        blocks.clear();
+        current = 0;
+        offset = 0;
+        used = 0;
+        MemoryTracker::Instance().Release(MemoryTracker::LOADER, (uintptr_t) this);
+    }
+
+    // bytes handed out since the last reset or rewound to, alignment padding and skipped block ends included
+    size_t Used() const
+    {
+        return used;
+    }
+
+    // highest Used() ever reached
+    size_t Peak() const
+    {
+        return peak;
+    }
+
+    size_t Capacity() const
+    {
+        size_t capacity = 0;
+        for (unsigned int i = 0; i < blocks.size(); i++)
+            capacity += blocks[i].Size;
+        return capacity;
+    }
+
+private:
+    struct Block
+    {
+        char* Data;
+        size_t Size;
+    };
+
+    size_t blockSize;
+    std::vector<Block> blocks;
+    unsigned int current;   // block allocations come from, the ones before it are full
+    size_t offset;          // first free byte of the current block
+    size_t used;
+    size_t peak;
+
+    void addBlock(size_t minimum)
+    {
+        Block block;
+        block.Size = minimum > blockSize ? minimum : blockSize;
+        block.Data = (char*) std::malloc(block.Size);
+        if (block.Data == nullptr)
+            throw std::bad_alloc();
+        blocks.push_back(block);
+        current = (unsigned int) blocks.size() - 1;
+        offset = 0;
+        MemoryTracker::Instance().SetCpu(MemoryTracker::LOADER, (uintptr_t) this, Capacity(), "scratch arena");
+    }
+
+    LinearArena(const LinearArena &);
+    LinearArena &operator=(const LinearArena &);
+};
+
+// rewinds an arena to where it was when the scope started, so nested users of the same thread arena only give
+// back their own allocations.
+class LinearArenaScope
+{
+public:
+    explicit LinearArenaScope(LinearArena &arena) : arena(arena), marker(arena.Mark())
+    {
+    }
+
+    ~LinearArenaScope()
+    {
+        arena.Rewind(marker);
+    }
+
+private:
+    LinearArena &arena;
+    LinearArena::Marker marker;
+
+    LinearArenaScope(const LinearArenaScope &);
+    LinearArenaScope &operator=(const LinearArenaScope &);
+};
+
+// std allocator over a LinearArena, deallocate does nothing. Reserve containers up front: a vector that grows
+// leaves every smaller array it outgrew in the arena until the rewind.
+template<typename T>
+class ArenaAllocator
+{
+public:
+    typedef T value_type;
+
+    explicit ArenaAllocator(LinearArena &arena) : arena(&arena)
+    {
+    }
+
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U> &other) : arena(other.Arena())
+    {
+    }
+
+    T* allocate(size_t count)
+    {
+        return (T*) arena->Allocate(count * sizeof(T), alignof(T));
+    }
+
+    void deallocate(T*, size_t)
+    {
+    }
+
+    LinearArena* Arena() const
+    {
+        return arena;
+    }
+
+private:
+    LinearArena* arena;
+};
+
+template<typename T, typename U>
+bool operator==(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b)
+{
+    return a.Arena() == b.Arena();
+}
+
+template<typename T, typename U>
+bool operator!=(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b)
+{
+    return a.Arena() != b.Arena();
+}
+#endif
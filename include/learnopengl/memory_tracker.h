@@ -0,0 +1,221 @@
+#ifndef MEMORY_TRACKER_H
+#define MEMORY_TRACKER_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Memory accounting by subsystem. Every consumer (a mesh, a texture, a program, a render target...) is an entry
+// keyed by its category and an id, usually its GL name. An entry holds the CPU bytes the consumer keeps and the
+// GPU bytes it is estimated to take from the size and format it was created with. SetCpu()/SetGpu() replace the
+// value of an entry, so callers report what they hold now instead of pairing every allocation with its free.
+//
+// GPU numbers are estimates (drivers pad, align and often store RGB as RGBA), good enough to spot regressions.
+// Categories and the whole process keep their high-water marks. Thread safe, loaders may report from workers.
+class MemoryTracker
+{
+public:
+    enum Category
+    {
+        MESHES,
+        TEXTURES,
+        SHADERS,
+        UI,
+        LOADER,             // scratch memory of model/texture loading, released when the load is done
+        RENDER_TARGETS,
+        BUFFERS,            // stream and instance buffers
+        CATEGORY_COUNT
+    };
+
+    struct Usage
+    {
+        int64_t Cpu;
+        int64_t Gpu;
+        int64_t PeakCpu;
+        int64_t PeakGpu;
+        unsigned int Entries;
+    };
+
+    // names are copied into the entry (truncated), so reporting and listing entries never allocates
+    struct Consumer
+    {
+        char Name[64];
+        Category Type;
+        int64_t Cpu;
+        int64_t Gpu;
+    };
+
+    static MemoryTracker &Instance()
+    {
+        static MemoryTracker tracker;
+        return tracker;
+    }
+
+    static const char* CategoryName(Category category)
+    {
+        static const char* names[CATEGORY_COUNT] = {"meshes", "textures", "shaders", "ui", "loader scratch", "render targets", "buffers"};
+        return category < CATEGORY_COUNT ? names[category] : "?";
+    }
+
+    // bytes of a 2D texture, with its whole mip chain when mipmaps is set.
+    static int64_t TextureBytes(int width, int height, int bytesPerTexel, bool mipmaps)
+    {
+        int64_t bytes = 0;
+        while (true)
+        {
+            bytes += (int64_t) width * height * bytesPerTexel;
+            if (!mipmaps || (width == 1 && height == 1))
+                return bytes;
+            width = width > 1 ? width / 2 : 1;
+            height = height > 1 ? height / 2 : 1;
+        }
+    }
+
+    // sets the CPU bytes of an entry, creating it if needed. No name keeps the current one.
+    void SetCpu(Category category, uint64_t id, int64_t bytes, const char* name = nullptr)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Consumer &consumer = entry(category, id, name);
+        add(category, bytes - consumer.Cpu, 0);
+        consumer.Cpu = bytes;
+    }
+
+    // sets the estimated GPU bytes of an entry, creating it if needed.
+    void SetGpu(Category category, uint64_t id, int64_t bytes, const char* name = nullptr)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Consumer &consumer = entry(category, id, name);
+        add(category, 0, bytes - consumer.Gpu);
+        consumer.Gpu = bytes;
+    }
+
+    void Rename(Category category, uint64_t id, const char* name)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::map<Key, Consumer>::iterator it = entries.find(Key(category, id));
+        if (it != entries.end())
+            std::snprintf(it->second.Name, sizeof(it->second.Name), "%s", name);
+    }
+
+    // drops the entry, its bytes are no longer counted (the peaks stay).
+    void Release(Category category, uint64_t id)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::map<Key, Consumer>::iterator it = entries.find(Key(category, id));
+        if (it == entries.end())
+            return;
+        add(category, -it->second.Cpu, -it->second.Gpu);
+        usage[category].Entries--;
+        total.Entries--;
+        entries.erase(it);
+    }
+
+    Usage CategoryUsage(Category category)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return usage[category];
+    }
+
+    // sums of every category, the peaks are those of the sums (not the sum of the category peaks).
+    Usage Total()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return total;
+    }
+
+    // replaces out with the count largest consumers by CPU + GPU bytes, largest first. out keeps its capacity, a
+    // vector reused every frame stops allocating once it held every entry.
+    void TopConsumers(unsigned int count, std::vector<Consumer> &out)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        out.clear();
+        for (std::map<Key, Consumer>::const_iterator it = entries.begin(); it != entries.end(); ++it)
+            out.push_back(it->second);
+        count = std::min(count, (unsigned int) out.size());
+        std::partial_sort(out.begin(), out.begin() + count, out.end(), largerThan);
+        out.resize(count);
+    }
+
+    // one line per category and the total, in MB.
+    void Print()
+    {
+        std::printf("%-16s %10s %10s %10s %10s %8s\n", "memory (MB)", "cpu", "cpu peak", "gpu est", "gpu peak", "entries");
+        for (int c = 0; c < CATEGORY_COUNT; c++)
+        {
+            Usage used = CategoryUsage((Category) c);
+            std::printf("%-16s %10.2f %10.2f %10.2f %10.2f %8u\n", CategoryName((Category) c), megabytes(used.Cpu), megabytes(used.PeakCpu),
+                        megabytes(used.Gpu), megabytes(used.PeakGpu), used.Entries);
+        }
+        Usage sum = Total();
+        std::printf("%-16s %10.2f %10.2f %10.2f %10.2f %8u\n", "total", megabytes(sum.Cpu), megabytes(sum.PeakCpu), megabytes(sum.Gpu),
+                    megabytes(sum.PeakGpu), sum.Entries);
+    }
+
+private:
+    typedef std::pair<int, uint64_t> Key;
+
+    std::mutex mutex;
+    std::map<Key, Consumer> entries;
+    Usage usage[CATEGORY_COUNT];
+    Usage total;
+
+    MemoryTracker()
+    {
+        std::fill(usage, usage + CATEGORY_COUNT, Usage());
+        total = Usage();
+    }
+
+    static double megabytes(int64_t bytes)
+    {
+        return bytes / (1024.0 * 1024.0);
+    }
+
+    static bool largerThan(const Consumer &a, const Consumer &b)
+    {
+        return a.Cpu + a.Gpu > b.Cpu + b.Gpu;
+    }
+
+    Consumer &entry(Category category, uint64_t id, const char* name)
+    {
+        bool named = name != nullptr && name[0] != 0;
+        std::map<Key, Consumer>::iterator it = entries.find(Key(category, id));
+        if (it == entries.end())
+        {
+            Consumer consumer;
+            if (named)
+                std::snprintf(consumer.Name, sizeof(consumer.Name), "%s", name);
+            else
+                std::snprintf(consumer.Name, sizeof(consumer.Name), "%s %llu", CategoryName(category), (unsigned long long) id);
+            consumer.Type = category;
+            consumer.Cpu = 0;
+            consumer.Gpu = 0;
+            it = entries.insert(std::make_pair(Key(category, id), consumer)).first;
+            usage[category].Entries++;
+            total.Entries++;
+        }
+        else if (named)
+            std::snprintf(it->second.Name, sizeof(it->second.Name), "%s", name);
+        return it->second;
+    }
+
+    void add(Category category, int64_t cpu, int64_t gpu)
+    {
+        Usage* targets[2] = {&usage[category], &total};
+        for (int i = 0; i < 2; i++)
+        {
+            targets[i]->Cpu += cpu;
+            targets[i]->Gpu += gpu;
+            targets[i]->PeakCpu = std::max(targets[i]->PeakCpu, targets[i]->Cpu);
+            targets[i]->PeakGpu = std::max(targets[i]->PeakGpu, targets[i]->Gpu);
+        }
+    }
+
+    MemoryTracker(const MemoryTracker &);
+    MemoryTracker &operator=(const MemoryTracker &);
+};
+#endif
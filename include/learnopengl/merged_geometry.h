@@ -0,0 +1,282 @@
+#ifndef MERGED_GEOMETRY_H
+#define MERGED_GEOMETRY_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <learnopengl/mesh.h>
+#include <learnopengl/shader.h>
+#include <learnopengl/memory_tracker.h>
+
+#include <string>
+#include <vector>
+
+// shader storage binding of the per draw records (see res/shaders/merged.vs)
+const unsigned int MERGED_DRAW_DATA_BINDING = 0;
+// layers of the materialTextures texture array of one batch (see res/shaders/merged.fs)
+const unsigned int MERGED_MAX_TEXTURES = 16;
+
+// Packs the meshes of one or more models in a single vertex/index buffer pair and draws all of them with
+// glMultiDrawElementsIndirect: one VAO bind and one draw call per batch instead of one per mesh.
+//
+// Every mesh becomes an indirect command (its index range plus base vertex) and a DrawRecord in a shader
+// storage buffer, found in the shader through gl_DrawID. The textures of a batch are copied into the layers
+// of one texture array and the record stores layer numbers, so the shader never indexes a sampler array
+// with a value that differs between draws. A batch holds at most MERGED_MAX_TEXTURES distinct textures,
+// a new batch (one more multi draw) starts when the array is full.
+class MergedGeometry
+{
+public:
+    // std430 layout, must match DrawRecord in res/shaders/merged.vs
+    struct DrawRecord
+    {
+        glm::mat4 model;
+        glm::ivec4 textures;
+    };
+
+    struct Batch
+    {
+        unsigned int FirstDraw;
+        unsigned int DrawCount;
+        vector<unsigned int> Textures;  // source texture of every layer
+        unsigned int Array;             // GL_TEXTURE_2D_ARRAY the layers are copied to, 0 if the batch has no textures
+    };
+
+    unsigned int VAO;
+
+    MergedGeometry() : VAO(0), VBO(0), EBO(0), commandBuffer(0), drawBuffer(0), firstDrawLocation(-1), program(0), drawCount(0)
+    {
+    }
+
+    // adds every mesh of model, placed with transform. Call Build() once everything is added.
+    template<typename ModelType>
+    void Add(const ModelType &model, const glm::mat4 &transform = glm::mat4(1.0f))
+    {
+        for(unsigned int i = 0; i < model.meshes.size(); i++)
+            Add(model.meshes[i], transform);
+    }
+
+    // needs the full vertices, the mesh must have been created with Mesh::KEEP_ALL.
+    void Add(const Mesh &mesh, const glm::mat4 &transform = glm::mat4(1.0f))
+    {
+        if(mesh.vertices.empty() && mesh.indexCount > 0)
+        {
+            cout << "ERROR::MERGED_GEOMETRY::MESH_CPU_DATA_RELEASED" << endl;
+            return;
+        }
+        // the texture array of the current batch must have room for every texture of this mesh
+        if(batches.empty() || !fits(batches.back(), mesh))
+        {
+            Batch batch;
+            batch.FirstDraw = (unsigned int) commands.size();
+            batch.DrawCount = 0;
+            batch.Array = 0;
+            batches.push_back(batch);
+        }
+        Batch &batch = batches.back();
+
+        DrawElementsIndirectCommand command;
+        command.count = (GLuint) mesh.indices.size();
+        command.instanceCount = 1;
+        command.firstIndex = (GLuint) indices.size();
+        command.baseVertex = (GLint) vertices.size();
+        command.baseInstance = 0;
+        commands.push_back(command);
+
+        DrawRecord record;
+        record.model = transform;
+        record.textures = glm::ivec4(textureSlot(batch, mesh, "texture_diffuse"), textureSlot(batch, mesh, "texture_specular"),
+                                     textureSlot(batch, mesh, "texture_normal"), textureSlot(batch, mesh, "texture_height"));
+        records.push_back(record);
+        batch.DrawCount++;
+
+        vertices.insert(vertices.end(), mesh.vertices.begin(), mesh.vertices.end());
+        indices.insert(indices.end(), mesh.indices.begin(), mesh.indices.end());
+    }
+
+    // uploads everything added so far and releases the CPU copies.
+    void Build()
+    {
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glGenBuffers(1, &EBO);
+        glGenBuffers(1, &commandBuffer);
+        glGenBuffers(1, &drawBuffer);
+
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), vertices.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+
+        // same vertex layout as Mesh
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Normal));
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, TexCoords));
+        glEnableVertexAttribArray(3);
+        glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Tangent));
+        glEnableVertexAttribArray(4);
+        glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Bitangent));
+        glBindVertexArray(0);
+
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, commands.size() * sizeof(DrawElementsIndirectCommand), commands.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, drawBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, records.size() * sizeof(DrawRecord), records.data(), GL_STATIC_DRAW);
+
+        GLuint framebuffers[2];
+        glCreateFramebuffers(2, framebuffers);
+        for(unsigned int b = 0; b < batches.size(); b++)
+            buildArray(batches[b], framebuffers[0], framebuffers[1]);
+        glDeleteFramebuffers(2, framebuffers);
+
+        drawCount = (unsigned int) commands.size();
+        MemoryTracker::Instance().SetGpu(MemoryTracker::MESHES, VAO, vertices.size() * sizeof(Vertex) + indices.size() * sizeof(unsigned int) +
+                                         commands.size() * sizeof(DrawElementsIndirectCommand) + records.size() * sizeof(DrawRecord), "merged geometry");
+        vector<Vertex>().swap(vertices);
+        vector<unsigned int>().swap(indices);
+        vector<DrawElementsIndirectCommand>().swap(commands);
+        vector<DrawRecord>().swap(records);
+    }
+
+    // draws every mesh, one glMultiDrawElementsIndirect per batch. shader is expected to be in use.
+    void Draw(const Shader &shader)
+    {
+        if(shader.ID != program)
+        {
+            program = shader.ID;
+            firstDrawLocation = glGetUniformLocation(program, "firstDraw");
+            glProgramUniform1i(program, glGetUniformLocation(program, "materialTextures"), 0);
+        }
+
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, MERGED_DRAW_DATA_BINDING, drawBuffer);
+        for(unsigned int b = 0; b < batches.size(); b++)
+        {
+            const Batch &batch = batches[b];
+            if(batch.Array != 0)
+                glBindTextureUnit(0, batch.Array);
+            glUniform1i(firstDrawLocation, batch.FirstDraw);
+            glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)(batch.FirstDraw * sizeof(DrawElementsIndirectCommand)),
+                                        batch.DrawCount, 0);
+        }
+    }
+
+    const vector<Batch> &Batches() const
+    {
+        return batches;
+    }
+
+    unsigned int DrawCount() const
+    {
+        return drawCount;
+    }
+
+private:
+    // layout defined by the GL spec for indirect indexed draws
+    struct DrawElementsIndirectCommand
+    {
+        GLuint count;
+        GLuint instanceCount;
+        GLuint firstIndex;
+        GLint baseVertex;
+        GLuint baseInstance;
+    };
+
+    unsigned int VBO, EBO;
+    unsigned int commandBuffer, drawBuffer;
+    GLint firstDrawLocation;
+    unsigned int program;
+    unsigned int drawCount;
+
+    vector<Batch> batches;
+    // staging, released by Build()
+    vector<Vertex> vertices;
+    vector<unsigned int> indices;
+    vector<DrawElementsIndirectCommand> commands;
+    vector<DrawRecord> records;
+
+    static bool contains(const Batch &batch, unsigned int texture)
+    {
+        for(unsigned int i = 0; i < batch.Textures.size(); i++)
+        {
+            if(batch.Textures[i] == texture)
+                return true;
+        }
+        return false;
+    }
+
+    static bool fits(const Batch &batch, const Mesh &mesh)
+    {
+        unsigned int missing = 0;
+        for(unsigned int i = 0; i < mesh.textures.size(); i++)
+        {
+            if(!contains(batch, mesh.textures[i].id))
+                missing++;
+        }
+        return batch.Textures.size() + missing <= MERGED_MAX_TEXTURES;
+    }
+
+    // copies the textures of batch into the layers of a new texture array, at the size of the largest one (the
+    // blit scales the others) with a full mip chain.
+    static void buildArray(Batch &batch, GLuint readFramebuffer, GLuint drawFramebuffer)
+    {
+        if(batch.Textures.empty())
+            return;
+        GLint width = 1, height = 1;
+        for(unsigned int i = 0; i < batch.Textures.size(); i++)
+        {
+            GLint size;
+            glGetTextureLevelParameteriv(batch.Textures[i], 0, GL_TEXTURE_WIDTH, &size);
+            width = size > width ? size : width;
+            glGetTextureLevelParameteriv(batch.Textures[i], 0, GL_TEXTURE_HEIGHT, &size);
+            height = size > height ? size : height;
+        }
+        GLsizei levels = 1;
+        while(((width > height ? width : height) >> levels) > 0)
+            levels++;
+
+        glCreateTextures(GL_TEXTURE_2D_ARRAY, 1, &batch.Array);
+        glTextureStorage3D(batch.Array, levels, GL_RGBA8, width, height, (GLsizei) batch.Textures.size());
+        glTextureParameteri(batch.Array, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTextureParameteri(batch.Array, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTextureParameteri(batch.Array, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTextureParameteri(batch.Array, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        for(unsigned int layer = 0; layer < batch.Textures.size(); layer++)
+        {
+            GLint sourceWidth, sourceHeight;
+            glGetTextureLevelParameteriv(batch.Textures[layer], 0, GL_TEXTURE_WIDTH, &sourceWidth);
+            glGetTextureLevelParameteriv(batch.Textures[layer], 0, GL_TEXTURE_HEIGHT, &sourceHeight);
+            glNamedFramebufferTexture(readFramebuffer, GL_COLOR_ATTACHMENT0, batch.Textures[layer], 0);
+            glNamedFramebufferTextureLayer(drawFramebuffer, GL_COLOR_ATTACHMENT0, batch.Array, 0, layer);
+            glBlitNamedFramebuffer(readFramebuffer, drawFramebuffer, 0, 0, sourceWidth, sourceHeight, 0, 0, width, height,
+                                   GL_COLOR_BUFFER_BIT, GL_LINEAR);
+        }
+        glGenerateTextureMipmap(batch.Array);
+        MemoryTracker::Instance().SetGpu(MemoryTracker::TEXTURES, batch.Array,
+                                         MemoryTracker::TextureBytes(width, height, 4, true) * batch.Textures.size(), "merged texture array");
+    }
+
+    // layer in the batch texture array of the first texture of the given type, -1 if the mesh has none.
+    static int textureSlot(Batch &batch, const Mesh &mesh, const string &type)
+    {
+        for(unsigned int i = 0; i < mesh.textures.size(); i++)
+        {
+            if(mesh.textures[i].type != type)
+                continue;
+            for(unsigned int slot = 0; slot < batch.Textures.size(); slot++)
+            {
+                if(batch.Textures[slot] == mesh.textures[i].id)
+                    return (int) slot;
+            }
+            batch.Textures.push_back(mesh.textures[i].id);
+            return (int) batch.Textures.size() - 1;
+        }
+        return -1;
+    }
+};
+#endif
@@ -7,12 +7,18 @@
 #include <glm/gtc/matrix_transform.hpp>
 
 #include <learnopengl/shader.h>
+#include <learnopengl/instance_buffer.h>
+#include <learnopengl/memory_tracker.h>
+#include <learnopengl/program_samplers.h>
 
 #include <string>
 #include <fstream>
 #include <sstream>
 #include <iostream>
 #include <vector>
+#include <utility>
+#include <map>
+#include <deque>
 using namespace std;
 
 struct Vertex {
@@ -28,77 +34,248 @@ struct Vertex {
     glm::vec3 Bitangent;
 };
 
+// bounding volumes in model space: an axis aligned box and a sphere around it.
+struct Bounds {
+    glm::vec3 Min;
+    glm::vec3 Max;
+    glm::vec3 Center;
+    float Radius;
+};
+
 struct Texture {
     unsigned int id;
     string type;
     string path;
 };
 
+// maximum number of textures a single mesh can bind per draw.
+const unsigned int MAX_MATERIAL_TEXTURES = 16;
+
+// Textures a mesh binds when drawn with a given program: the sampler names are resolved once,
+// each draw only walks these arrays.
+struct MaterialBinding {
+    unsigned int program;
+    unsigned int generation;    // ProgramSamplers::Generation() the units were resolved at
+    unsigned int count;
+    GLuint units[MAX_MATERIAL_TEXTURES];
+    GLuint textures[MAX_MATERIAL_TEXTURES];
+};
+
 class Mesh {
 public:
+    // what stays in memory on the CPU once the mesh is uploaded
+    enum CpuData {
+        KEEP_ALL,           // vertices and indices, for MergedGeometry and the software rasterizer
+        KEEP_POSITIONS,     // positions and indices only, enough for culling and picking
+        KEEP_NONE
+    };
+
     /*  Mesh Data  */
     vector<Vertex> vertices;
+    vector<glm::vec3> positions;    // only filled with KEEP_POSITIONS, vertices are empty then
     vector<unsigned int> indices;
     vector<Texture> textures;
     unsigned int VAO;
+    unsigned int indexCount;        // the number of indices uploaded, indices may have been released
+    Bounds bounds;
 
     /*  Functions  */
-    // constructor
-    Mesh(vector<Vertex> vertices, vector<unsigned int> indices, vector<Texture> textures)
+    // constructor, takes the data over (pass std::move'd vectors, the loader never copies vertices).
+    Mesh(vector<Vertex> &&vertices, vector<unsigned int> &&indices, vector<Texture> &&textures, CpuData keep = KEEP_ALL)
+        : vertices(std::move(vertices)), indices(std::move(indices)), textures(std::move(textures))
     {
-        this->vertices = vertices;
-        this->indices = indices;
-        this->textures = textures;
+        this->indexCount = (unsigned int) this->indices.size();
+        this->instanceBuffer = 0;
 
         // now that we have all the required data, set the vertex buffers and its attribute pointers.
-        setupMesh();
+        computeBounds(this->vertices.data(), this->vertices.size());
+        setupMesh(this->vertices.data(), this->vertices.size(), this->indices.data(), this->indices.size());
+        releaseCpuData(keep);
+    }
+
+    // constructor for data staged elsewhere (a LinearArena during import): uploads it and copies only what keep
+    // asks for, the staging memory can go as soon as this returns.
+    Mesh(const Vertex* vertexData, size_t vertexCount, const unsigned int* indexData, size_t count, vector<Texture> &&textures,
+         CpuData keep = KEEP_ALL)
+        : textures(std::move(textures))
+    {
+        this->indexCount = (unsigned int) count;
+        this->instanceBuffer = 0;
+
+        computeBounds(vertexData, vertexCount);
+        setupMesh(vertexData, vertexCount, indexData, count);
+        if(keep == KEEP_ALL)
+            vertices.assign(vertexData, vertexData + vertexCount);
+        if(keep == KEEP_POSITIONS)
+        {
+            positions.resize(vertexCount);
+            for(size_t i = 0; i < vertexCount; i++)
+                positions[i] = vertexData[i].Position;
+        }
+        if(keep != KEEP_NONE)
+            indices.assign(indexData, indexData + count);
+        trackCpuData();
+    }
+
+    // meshes are moved, never copied: the vertex data can be large and copies would share the GL objects.
+    Mesh(Mesh &&other)
+        : vertices(std::move(other.vertices)), positions(std::move(other.positions)), indices(std::move(other.indices)),
+          textures(std::move(other.textures)), VAO(other.VAO), indexCount(other.indexCount), bounds(other.bounds),
+          VBO(other.VBO), EBO(other.EBO), instanceBuffer(other.instanceBuffer), bindings(std::move(other.bindings))
+    {
+    }
+
+    Mesh &operator=(Mesh &&other)
+    {
+        vertices = std::move(other.vertices);
+        positions = std::move(other.positions);
+        indices = std::move(other.indices);
+        textures = std::move(other.textures);
+        VAO = other.VAO;
+        indexCount = other.indexCount;
+        bounds = other.bounds;
+        VBO = other.VBO;
+        EBO = other.EBO;
+        instanceBuffer = other.instanceBuffer;
+        bindings = std::move(other.bindings);
+        return *this;
+    }
+
+    // position of vertex i, from whichever stream was kept
+    const glm::vec3 &Position(unsigned int i) const
+    {
+        return vertices.empty() ? positions[i] : vertices[i].Position;
+    }
+
+    // number of vertices still available on the CPU (0 with KEEP_NONE)
+    unsigned int CpuVertexCount() const
+    {
+        return (unsigned int) (vertices.empty() ? positions.size() : vertices.size());
     }
 
     // render the mesh
-    void Draw(Shader shader) 
+    void Draw(const Shader &shader)
+    {
+        // bind appropriate textures, the units were assigned when the binding got resolved
+        const MaterialBinding &binding = GetBinding(shader.ID);
+        for(unsigned int i = 0; i < binding.count; i++)
+            glBindTextureUnit(binding.units[i], binding.textures[i]);
+
+        // draw mesh, every draw binds its own VAO so there's no need to unbind it afterwards
+        glBindVertexArray(VAO);
+        glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0);
+    }
+
+    // render instances.Count() copies of the mesh, each with its own model matrix from the instance buffer
+    void DrawInstanced(const Shader &shader, const InstanceBuffer &instances)
+    {
+        const MaterialBinding &binding = GetBinding(shader.ID);
+        for(unsigned int i = 0; i < binding.count; i++)
+            glBindTextureUnit(binding.units[i], binding.textures[i]);
+
+        glBindVertexArray(VAO);
+        if(instanceBuffer != instances.ID)
+            setupInstancing(instances.ID);
+        glDrawElementsInstancedBaseInstance(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0, instances.Count(), instances.BaseInstance());
+    }
+
+    // returns the material binding of program, resolving it on first use and again once a program was deleted or
+    // got its units assigned again (the program name may now stand for another program). A binding is updated in
+    // place, pointers to it stay valid.
+    const MaterialBinding &GetBinding(unsigned int program)
+    {
+        for(unsigned int i = 0; i < bindings.size(); i++)
+        {
+            if(bindings[i].program != program)
+                continue;
+            if(bindings[i].generation != ProgramSamplers::Generation())
+                resolveBinding(bindings[i]);
+            return bindings[i];
+        }
+
+        MaterialBinding binding;
+        binding.program = program;
+        resolveBinding(binding);
+        bindings.push_back(binding);
+        return bindings.back();
+    }
+
+private:
+    /*  Render data  */
+    unsigned int VBO, EBO;
+    // instance buffer the instance matrix attributes currently read from
+    unsigned int instanceBuffer;
+    // one binding per program this mesh has been drawn with (a deque so references stay valid when it grows)
+    deque<MaterialBinding> bindings;
+
+    /*  Functions    */
+    // looks up the unit of every texture in binding.program
+    void resolveBinding(MaterialBinding &binding)
     {
-        // bind appropriate textures
+        binding.generation = ProgramSamplers::Generation();
+        binding.count = 0;
         unsigned int diffuseNr  = 1;
         unsigned int specularNr = 1;
         unsigned int normalNr   = 1;
         unsigned int heightNr   = 1;
-        for(unsigned int i = 0; i < textures.size(); i++)
+        for(unsigned int i = 0; i < textures.size() && binding.count < MAX_MATERIAL_TEXTURES; i++)
         {
-            glActiveTexture(GL_TEXTURE0 + i); // active proper texture unit before binding
             // retrieve texture number (the N in diffuse_textureN)
             string number;
             string name = textures[i].type;
             if(name == "texture_diffuse")
-				number = std::to_string(diffuseNr++);
-			else if(name == "texture_specular")
-				number = std::to_string(specularNr++); // transfer unsigned int to stream
+                number = std::to_string(diffuseNr++);
+            else if(name == "texture_specular")
+                number = std::to_string(specularNr++);
             else if(name == "texture_normal")
-				number = std::to_string(normalNr++); // transfer unsigned int to stream
-             else if(name == "texture_height")
-			    number = std::to_string(heightNr++); // transfer unsigned int to stream
-
-													 // now set the sampler to the correct texture unit
-            glUniform1i(glGetUniformLocation(shader.ID, (name + number).c_str()), i);
-            // and finally bind the texture
-            glBindTexture(GL_TEXTURE_2D, textures[i].id);
+                number = std::to_string(normalNr++);
+            else if(name == "texture_height")
+                number = std::to_string(heightNr++);
+
+            // textures the program doesn't sample are never bound
+            GLint unit = ProgramSamplers::UnitOf(binding.program, name + number);
+            if(unit < 0)
+                continue;
+            binding.units[binding.count] = unit;
+            binding.textures[binding.count] = textures[i].id;
+            binding.count++;
         }
-        
-        // draw mesh
-        glBindVertexArray(VAO);
-        glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
-        glBindVertexArray(0);
+    }
 
-        // always good practice to set everything back to defaults once configured.
-        glActiveTexture(GL_TEXTURE0);
+    // points the instance matrix attributes (a mat4 takes 4 vec4 locations) at buffer, expects the VAO to be bound
+    void setupInstancing(unsigned int buffer)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+        for(unsigned int i = 0; i < 4; i++)
+        {
+            glEnableVertexAttribArray(INSTANCE_MATRIX_LOCATION + i);
+            glVertexAttribPointer(INSTANCE_MATRIX_LOCATION + i, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(i * sizeof(glm::vec4)));
+            glVertexAttribDivisor(INSTANCE_MATRIX_LOCATION + i, 1);
+        }
+        instanceBuffer = buffer;
     }
 
-private:
-    /*  Render data  */
-    unsigned int VBO, EBO;
+    // computes the box around every vertex, the sphere is centered on the box and reaches its farthest vertex.
+    void computeBounds(const Vertex* vertexData, size_t count)
+    {
+        bounds.Min = bounds.Max = count == 0 ? glm::vec3(0.0f) : vertexData[0].Position;
+        for(unsigned int i = 1; i < count; i++)
+        {
+            bounds.Min = glm::min(bounds.Min, vertexData[i].Position);
+            bounds.Max = glm::max(bounds.Max, vertexData[i].Position);
+        }
+        bounds.Center = (bounds.Min + bounds.Max) * 0.5f;
+        float radius2 = 0.0f;
+        for(unsigned int i = 0; i < count; i++)
+        {
+            glm::vec3 offset = vertexData[i].Position - bounds.Center;
+            radius2 = glm::max(radius2, glm::dot(offset, offset));
+        }
+        bounds.Radius = glm::sqrt(radius2);
+    }
 
-    /*  Functions    */
     // initializes all the buffer objects/arrays
-    void setupMesh()
+    void setupMesh(const Vertex* vertexData, size_t vertexCount, const unsigned int* indexData, size_t count)
     {
         // create buffers/arrays
         glGenVertexArrays(1, &VAO);
@@ -111,10 +288,10 @@ private:
         // A great thing about structs is that their memory layout is sequential for all its items.
         // The effect is that we can simply pass a pointer to the struct and it translates perfectly to a glm::vec3/2 array which
         // again translates to 3/2 floats which translates to a byte array.
-        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);  
+        glBufferData(GL_ARRAY_BUFFER, vertexCount * sizeof(Vertex), vertexData, GL_STATIC_DRAW);  
 
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(unsigned int), indexData, GL_STATIC_DRAW);
 
         // set the vertex attribute pointers
         // vertex Positions
@@ -134,6 +311,34 @@ private:
         glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Bitangent));
 
         glBindVertexArray(0);
+
+        MemoryTracker::Instance().SetGpu(MemoryTracker::MESHES, VAO, vertexCount * sizeof(Vertex) + count * sizeof(unsigned int));
     }
+
+    // drops what keep doesn't ask for, swapping with empty vectors so the memory really goes back to the heap
+    void releaseCpuData(CpuData keep)
+    {
+        if(keep == KEEP_POSITIONS)
+        {
+            positions.resize(vertices.size());
+            for(unsigned int i = 0; i < vertices.size(); i++)
+                positions[i] = vertices[i].Position;
+        }
+        if(keep != KEEP_ALL)
+            vector<Vertex>().swap(vertices);
+        if(keep == KEEP_NONE)
+            vector<unsigned int>().swap(indices);
+        trackCpuData();
+    }
+
+    void trackCpuData()
+    {
+        MemoryTracker::Instance().SetCpu(MemoryTracker::MESHES, VAO, vertices.capacity() * sizeof(Vertex) +
+                                         positions.capacity() * sizeof(glm::vec3) + indices.capacity() * sizeof(unsigned int));
+    }
+
+    // owns GL objects, moved only
+    Mesh(const Mesh &);
+    Mesh &operator=(const Mesh &);
 };
 #endif
@@ -12,6 +12,10 @@
 
 #include <learnopengl/mesh.h>
 #include <learnopengl/shader.h>
+#include <learnopengl/render_queue.h>
+#include <learnopengl/cpu_profiler.h>
+#include <learnopengl/memory_tracker.h>
+#include <learnopengl/linear_arena.h>
 
 #include <string>
 #include <fstream>
@@ -31,68 +35,63 @@ public:
     vector<Mesh> meshes;
     string directory;
     bool gammaCorrection;
+    Mesh::CpuData cpuData;    // what the meshes keep on the CPU after upload
+    Bounds bounds;    // union of the mesh bounds
 
     /*  Functions   */
-    // constructor, expects a filepath to a 3D model.
-    Model(string const &path, bool gamma = false) : gammaCorrection(gamma)
+    // constructor, expects a filepath to a 3D model. Pass Mesh::KEEP_POSITIONS or KEEP_NONE as keep when
+    // nothing needs the full vertices after upload (MergedGeometry and the software rasterizer do).
+    Model(string const &path, bool gamma = false, Mesh::CpuData keep = Mesh::KEEP_ALL) : gammaCorrection(gamma), cpuData(keep)
     {
         loadModel(path);
     }
 
     // draws the model, and thus all its meshes
-    void Draw(Shader shader)
+    void Draw(const Shader &shader)
     {
         for(unsigned int i = 0; i < meshes.size(); i++)
             meshes[i].Draw(shader);
     }
-    
-private:
-    /*  Functions   */
-    // loads a model with supported ASSIMP extensions from file and stores the resulting meshes in the meshes vector.
-    void loadModel(string const &path)
-    {
-        // read file via ASSIMP
-        Assimp::Importer importer;
-        const aiScene* scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_CalcTangentSpace);
-        // check for errors
-        if(!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) // if is Not Zero
-        {
-            cout << "ERROR::ASSIMP:: " << importer.GetErrorString() << endl;
-            return;
-        }
-        // retrieve the directory path of the filepath
-        directory = path.substr(0, path.find_last_of('/'));
 
-        // process ASSIMP's root node recursively
-        processNode(scene->mRootNode, scene);
+    // draws instances.Count() copies of the model, one per model matrix of the instance buffer
+    void DrawInstanced(const Shader &shader, const InstanceBuffer &instances)
+    {
+        for(unsigned int i = 0; i < meshes.size(); i++)
+            meshes[i].DrawInstanced(shader, instances);
     }
 
-    // processes a node in a recursive fashion. Processes each individual mesh located at the node and repeats this process on its children nodes (if any).
-    void processNode(aiNode *node, const aiScene *scene)
+    // pushes one packet per mesh into queue instead of drawing right away, viewPosition is used for the sort depth.
+    void Submit(RenderQueue &queue, const Shader &shader, const glm::mat4 &model, const glm::vec3 &viewPosition, bool transparent = false)
     {
-        // process each mesh located at the current node
-        for(unsigned int i = 0; i < node->mNumMeshes; i++)
-        {
-            // the node object only contains indices to index the actual objects in the scene. 
-            // the scene contains all the data, node is just to keep stuff organized (like relations between nodes).
-            aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
-            meshes.push_back(processMesh(mesh, scene));
-        }
-        // after we've processed all of the meshes (if any) we then recursively process each of the children nodes
-        for(unsigned int i = 0; i < node->mNumChildren; i++)
-        {
-            processNode(node->mChildren[i], scene);
-        }
-
+        for(unsigned int i = 0; i < meshes.size(); i++)
+            SubmitMesh(queue, shader, i, model, viewPosition, transparent);
     }
 
-    Mesh processMesh(aiMesh *mesh, const aiScene *scene)
+    // pushes a single mesh, used to submit only what survived culling (see FrustumCuller).
+    void SubmitMesh(RenderQueue &queue, const Shader &shader, unsigned int mesh, const glm::mat4 &model, const glm::vec3 &viewPosition, bool transparent = false)
     {
-        // data to fill
-        vector<Vertex> vertices;
-        vector<unsigned int> indices;
-        vector<Texture> textures;
-
+        DrawPacket packet;
+        packet.Program = shader.ID;
+        packet.FirstIndex = 0;
+        packet.Depth = glm::length(glm::vec3(model[3]) - viewPosition);
+        packet.Transparent = transparent;
+        packet.Model = model;
+        packet.Material = &meshes[mesh].GetBinding(shader.ID);
+        packet.VAO = meshes[mesh].VAO;
+        packet.Count = meshes[mesh].indexCount;
+        queue.Push(packet);
+    }
+    
+    // converts the vertices and indices of an assimp mesh, the part of processMesh that needs no GL context
+    // (bench_asset_pipeline times it on its own). Any vector type works, processMesh stages in arena vectors.
+    template<typename VertexVector, typename IndexVector>
+    static void ConvertMesh(const aiMesh *mesh, VertexVector &vertices, IndexVector &indices)
+    {
+        vertices.clear();
+        indices.clear();
+        // sized once, growing would leave every outgrown array behind (in the heap or the arena)
+        vertices.reserve(mesh->mNumVertices);
+        indices.reserve(mesh->mNumFaces * 3);
         // Walk through each of the mesh's vertices
         for(unsigned int i = 0; i < mesh->mNumVertices; i++)
         {
@@ -140,6 +139,76 @@ private:
             for(unsigned int j = 0; j < face.mNumIndices; j++)
                 indices.push_back(face.mIndices[j]);
         }
+    }
+
+private:
+    /*  Functions   */
+    // loads a model with supported ASSIMP extensions from file and stores the resulting meshes in the meshes vector.
+    void loadModel(string const &path)
+    {
+        CPU_PROFILE_ZONE("Model::loadModel");
+        // the staging of every mesh goes at once when we return, whatever the caller staged before stays
+        LinearArenaScope staging(LinearArena::ThreadScratch());
+        // read file via ASSIMP
+        Assimp::Importer importer;
+        const aiScene* scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_CalcTangentSpace);
+        // check for errors
+        if(!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) // if is Not Zero
+        {
+            cout << "ERROR::ASSIMP:: " << importer.GetErrorString() << endl;
+            return;
+        }
+        // retrieve the directory path of the filepath
+        directory = path.substr(0, path.find_last_of('/'));
+
+        // the imported scene is loader scratch, freed with the importer when we return
+        aiMemoryInfo sceneMemory;
+        importer.GetMemoryRequirements(sceneMemory);
+        MemoryTracker::Instance().SetCpu(MemoryTracker::LOADER, (uintptr_t) this, sceneMemory.total, path.c_str());
+
+        // process ASSIMP's root node recursively, nodes usually reference each mesh once
+        meshes.reserve(scene->mNumMeshes);
+        processNode(scene->mRootNode, scene);
+        MemoryTracker::Instance().Release(MemoryTracker::LOADER, (uintptr_t) this);
+
+        // the model bounds enclose every mesh
+        bounds = meshes.empty() ? Bounds() : meshes[0].bounds;
+        for(unsigned int i = 1; i < meshes.size(); i++)
+        {
+            bounds.Min = glm::min(bounds.Min, meshes[i].bounds.Min);
+            bounds.Max = glm::max(bounds.Max, meshes[i].bounds.Max);
+        }
+        bounds.Center = (bounds.Min + bounds.Max) * 0.5f;
+        bounds.Radius = 0.0f;
+        for(unsigned int i = 0; i < meshes.size(); i++)
+            bounds.Radius = glm::max(bounds.Radius, glm::length(meshes[i].bounds.Center - bounds.Center) + meshes[i].bounds.Radius);
+    }
+
+    // processes a node in a recursive fashion. Processes each individual mesh located at the node and repeats this process on its children nodes (if any).
+    void processNode(aiNode *node, const aiScene *scene)
+    {
+        // process each mesh located at the current node
+        for(unsigned int i = 0; i < node->mNumMeshes; i++)
+        {
+            // the node object only contains indices to index the actual objects in the scene. 
+            // the scene contains all the data, node is just to keep stuff organized (like relations between nodes).
+            aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
+            meshes.push_back(processMesh(mesh, scene));
+        }
+        // after we've processed all of the meshes (if any) we then recursively process each of the children nodes
+        for(unsigned int i = 0; i < node->mNumChildren; i++)
+        {
+            processNode(node->mChildren[i], scene);
+        }
+
+    }
+
+    Mesh processMesh(aiMesh *mesh, const aiScene *scene)
+    {
+        CPU_PROFILE_ZONE("Model::processMesh");
+        // data to fill
+        vector<Texture> textures;
+
         // process materials
         aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];    
         // we assume a convention for sampler names in the shaders. Each diffuse texture should be named
@@ -150,27 +219,38 @@ private:
         // normal: texture_normalN
 
         // 1. diffuse maps
-        vector<Texture> diffuseMaps = loadMaterialTextures(material, aiTextureType_DIFFUSE, "texture_diffuse");
-        textures.insert(textures.end(), diffuseMaps.begin(), diffuseMaps.end());
+        loadMaterialTextures(material, aiTextureType_DIFFUSE, "texture_diffuse", textures);
         // 2. specular maps
-        vector<Texture> specularMaps = loadMaterialTextures(material, aiTextureType_SPECULAR, "texture_specular");
-        textures.insert(textures.end(), specularMaps.begin(), specularMaps.end());
+        loadMaterialTextures(material, aiTextureType_SPECULAR, "texture_specular", textures);
         // 3. normal maps
-        std::vector<Texture> normalMaps = loadMaterialTextures(material, aiTextureType_HEIGHT, "texture_normal");
-        textures.insert(textures.end(), normalMaps.begin(), normalMaps.end());
+        loadMaterialTextures(material, aiTextureType_HEIGHT, "texture_normal", textures);
         // 4. height maps
-        std::vector<Texture> heightMaps = loadMaterialTextures(material, aiTextureType_AMBIENT, "texture_height");
-        textures.insert(textures.end(), heightMaps.begin(), heightMaps.end());
-        
-        // return a mesh object created from the extracted mesh data
-        return Mesh(vertices, indices, textures);
+        loadMaterialTextures(material, aiTextureType_AMBIENT, "texture_height", textures);
+
+        // meshes that keep their vertices own them from the start and get them moved all the way into meshes.
+        // The others stage them in the loader arena, the mesh copies what it keeps (if anything) after upload.
+        if(cpuData == Mesh::KEEP_ALL)
+        {
+            vector<Vertex> vertices;
+            vector<unsigned int> indices;
+            ConvertMesh(mesh, vertices, indices);
+            Mesh result(std::move(vertices), std::move(indices), std::move(textures), cpuData);
+            MemoryTracker::Instance().Rename(MemoryTracker::MESHES, result.VAO, (directory + "/" + mesh->mName.C_Str()).c_str());
+            return result;
+        }
+        LinearArena &arena = LinearArena::ThreadScratch();
+        vector<Vertex, ArenaAllocator<Vertex> > vertices((ArenaAllocator<Vertex>(arena)));
+        vector<unsigned int, ArenaAllocator<unsigned int> > indices((ArenaAllocator<unsigned int>(arena)));
+        ConvertMesh(mesh, vertices, indices);
+        Mesh result(vertices.data(), vertices.size(), indices.data(), indices.size(), std::move(textures), cpuData);
+        MemoryTracker::Instance().Rename(MemoryTracker::MESHES, result.VAO, (directory + "/" + mesh->mName.C_Str()).c_str());
+        return result;
     }
 
     // checks all material textures of a given type and loads the textures if they're not loaded yet.
-    // the required info is returned as a Texture struct.
-    vector<Texture> loadMaterialTextures(aiMaterial *mat, aiTextureType type, string typeName)
+    // the required info is appended to textures as Texture structs.
+    void loadMaterialTextures(aiMaterial *mat, aiTextureType type, const char *typeName, vector<Texture> &textures)
     {
-        vector<Texture> textures;
         for(unsigned int i = 0; i < mat->GetTextureCount(type); i++)
         {
             aiString str;
@@ -196,13 +276,13 @@ private:
                 textures_loaded.push_back(texture);  // store it as texture loaded for entire model, to ensure we won't unnecesery load duplicate textures.
             }
         }
-        return textures;
     }
 };
 
 
 unsigned int TextureFromFile(const char *path, const string &directory, bool gamma)
 {
+    CPU_PROFILE_ZONE("TextureFromFile");
     string filename = string(path);
     filename = directory + '/' + filename;
 
@@ -220,6 +300,10 @@ unsigned int TextureFromFile(const char *path, const string &directory, bool gam
             format = GL_RGB;
         else if (nrComponents == 4)
             format = GL_RGBA;
+        // the decoded image is scratch until it is freed below, the texture is counted as RGBA for 3 components
+        MemoryTracker &memory = MemoryTracker::Instance();
+        memory.SetCpu(MemoryTracker::LOADER, textureID, (int64_t) width * height * nrComponents, filename.c_str());
+        memory.SetGpu(MemoryTracker::TEXTURES, textureID, MemoryTracker::TextureBytes(width, height, nrComponents == 3 ? 4 : nrComponents, true), filename.c_str());
 
         glBindTexture(GL_TEXTURE_2D, textureID);
         glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
@@ -231,6 +315,7 @@ unsigned int TextureFromFile(const char *path, const string &directory, bool gam
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
         stbi_image_free(data);
+        memory.Release(MemoryTracker::LOADER, textureID);
     }
     else
     {
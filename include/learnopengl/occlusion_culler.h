@@ -0,0 +1,427 @@
+#ifndef OCCLUSION_CULLER_H
+#define OCCLUSION_CULLER_H
+
+#include <glm/glm.hpp>
+
+#include <learnopengl/mesh.h>
+#include <learnopengl/cpu_profiler.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OCCLUSION_CULLER_SSE
+#include <emmintrin.h>
+#endif
+
+// Counters of the last frame.
+struct OcclusionStats
+{
+    unsigned int Triangles;     // occluder triangles set up (after near plane rejection)
+    unsigned int Binned;        // triangle/tile pairs rasterized
+    unsigned int Tested;
+    unsigned int Occluded;
+};
+
+// CPU occlusion culling: a few simplified occluder meshes are rasterized into a small depth buffer, which is
+// reduced into a max depth hierarchy (every texel holds the farthest depth of the 2x2 texels below it). An
+// instance box is occluded when its nearest depth is behind the hierarchy texels covering its screen rect, the
+// level is picked so that rect spans at most a few texels.
+//
+// The depth buffer is split in TILE_WIDTH x TILE_HEIGHT tiles. Triangles are binned per tile, then worker
+// threads take one tile at a time and rasterize its bin, 4 pixels per SSE instruction. A tile row is 256
+// bytes, so workers never write to the same cache line. Depth is z/w in [0, 1], 1 being the far plane.
+//
+// Usage per frame: BeginFrame(viewProjection), AddOccluder() for every occluder, Render(), then TestBox().
+class OcclusionCuller
+{
+public:
+    static const int TILE_WIDTH = 64;
+    static const int TILE_HEIGHT = 32;
+
+    // the resolution is rounded up to whole tiles. workers = 0 uses every hardware thread.
+    OcclusionCuller(int width = 320, int height = 192, unsigned int workers = 0) : nextTile(0), doneTiles(0), generation(0), stopping(false)
+    {
+        tilesX = (width + TILE_WIDTH - 1) / TILE_WIDTH;
+        tilesY = (height + TILE_HEIGHT - 1) / TILE_HEIGHT;
+        this->width = tilesX * TILE_WIDTH;
+        this->height = tilesY * TILE_HEIGHT;
+        bins.resize(tilesX * tilesY);
+
+        // one level per halving down to a single texel
+        int w = this->width, h = this->height;
+        while (true)
+        {
+            Level level;
+            level.Width = w;
+            level.Height = h;
+            level.Depth.assign((size_t) w * h, 1.0f);
+            levels.push_back(level);
+            if (w == 1 && h == 1)
+                break;
+            w = (w + 1) / 2;
+            h = (h + 1) / 2;
+        }
+
+        if (workers == 0)
+            workers = std::max(1u, std::thread::hardware_concurrency());
+        // the calling thread works too
+        for (unsigned int i = 1; i < workers; i++)
+            threads.push_back(std::thread(&OcclusionCuller::workerLoop, this));
+        std::memset(&stats, 0, sizeof(stats));
+    }
+
+    ~OcclusionCuller()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (unsigned int i = 0; i < threads.size(); i++)
+            threads[i].join();
+    }
+
+    void BeginFrame(const glm::mat4 &viewProjection)
+    {
+        this->viewProjection = viewProjection;
+        triangles.clear();
+        for (unsigned int i = 0; i < bins.size(); i++)
+            bins[i].clear();
+        std::memset(&stats, 0, sizeof(stats));
+    }
+
+    // adds occluder triangles, positions in model space. Triangles crossing the near plane are dropped, which
+    // only makes the culling less aggressive.
+    void AddOccluder(const std::vector<glm::vec3> &positions, const std::vector<unsigned int> &indices, const glm::mat4 &model)
+    {
+        glm::mat4 transform = viewProjection * model;
+        screen.resize(positions.size());
+        for (unsigned int i = 0; i < positions.size(); i++)
+        {
+            glm::vec4 clip = transform * glm::vec4(positions[i], 1.0f);
+            if (clip.w < 1e-4f)
+            {
+                screen[i] = glm::vec4(0.0f, 0.0f, 0.0f, -1.0f);
+                continue;
+            }
+            glm::vec3 ndc = glm::vec3(clip) / clip.w;
+            screen[i] = glm::vec4((ndc.x * 0.5f + 0.5f) * width, (ndc.y * 0.5f + 0.5f) * height, ndc.z * 0.5f + 0.5f, 1.0f);
+        }
+        for (unsigned int i = 0; i + 2 < indices.size(); i += 3)
+            setupTriangle(screen[indices[i]], screen[indices[i + 1]], screen[indices[i + 2]]);
+    }
+
+    // the whole mesh as its own occluder, prefer a simplified mesh for anything detailed.
+    // Works with Mesh::KEEP_POSITIONS, a mesh that kept nothing adds no triangles.
+    void AddOccluder(const Mesh &mesh, const glm::mat4 &model)
+    {
+        if (!mesh.positions.empty())
+        {
+            AddOccluder(mesh.positions, mesh.indices, model);
+            return;
+        }
+        positions.resize(mesh.vertices.size());
+        for (unsigned int i = 0; i < mesh.vertices.size(); i++)
+            positions[i] = mesh.vertices[i].Position;
+        AddOccluder(positions, mesh.indices, model);
+    }
+
+    // rasterizes every tile on the worker threads, then builds the depth hierarchy.
+    void Render()
+    {
+        CPU_PROFILE_ZONE("OcclusionCuller::Render");
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            nextTile = 0;
+            doneTiles = 0;
+            generation++;
+        }
+        wake.notify_all();
+        rasterizeTiles();
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            finished.wait(lock, [this]() { return doneTiles == (int) bins.size(); });
+        }
+        for (unsigned int i = 0; i < bins.size(); i++)
+            stats.Binned += (unsigned int) bins[i].size();
+        buildHierarchy();
+    }
+
+    // false when the world space box is hidden behind the occluders.
+    bool TestBox(const glm::vec3 &min, const glm::vec3 &max)
+    {
+        stats.Tested++;
+        glm::vec2 rectMin(std::numeric_limits<float>::max()), rectMax(-std::numeric_limits<float>::max());
+        float nearest = 1.0f;
+        for (int corner = 0; corner < 8; corner++)
+        {
+            glm::vec3 p((corner & 1) ? max.x : min.x, (corner & 2) ? max.y : min.y, (corner & 4) ? max.z : min.z);
+            glm::vec4 clip = viewProjection * glm::vec4(p, 1.0f);
+            // a box reaching behind the camera can't be judged from its projection
+            if (clip.w < 1e-4f)
+                return true;
+            glm::vec3 ndc = glm::vec3(clip) / clip.w;
+            glm::vec2 pixel((ndc.x * 0.5f + 0.5f) * width, (ndc.y * 0.5f + 0.5f) * height);
+            rectMin = glm::min(rectMin, pixel);
+            rectMax = glm::max(rectMax, pixel);
+            nearest = glm::min(nearest, ndc.z * 0.5f + 0.5f);
+        }
+
+        int x0 = std::max(0, (int) std::floor(rectMin.x)), y0 = std::max(0, (int) std::floor(rectMin.y));
+        int x1 = std::min(width - 1, (int) std::floor(rectMax.x)), y1 = std::min(height - 1, (int) std::floor(rectMax.y));
+        // off screen, that's for frustum culling to decide
+        if (x0 > x1 || y0 > y1)
+            return true;
+
+        // coarsest level where the rect spans at most 2 texels (3 when it straddles a texel boundary)
+        int size = std::max(x1 - x0, y1 - y0);
+        int level = 0;
+        while ((size >> level) > 1 && level + 1 < (int) levels.size())
+            level++;
+        const Level &depth = levels[level];
+        for (int y = y0 >> level; y <= (y1 >> level); y++)
+        {
+            for (int x = x0 >> level; x <= (x1 >> level); x++)
+            {
+                if (nearest <= depth.Depth[(size_t) y * depth.Width + x])
+                    return true;
+            }
+        }
+        stats.Occluded++;
+        return false;
+    }
+
+    // depth level 0 is the full resolution buffer, row major, bottom row first.
+    const std::vector<float> &Depth(int level = 0) const
+    {
+        return levels[level].Depth;
+    }
+
+    int Width(int level = 0) const
+    {
+        return levels[level].Width;
+    }
+
+    int Height(int level = 0) const
+    {
+        return levels[level].Height;
+    }
+
+    int Levels() const
+    {
+        return (int) levels.size();
+    }
+
+    unsigned int Workers() const
+    {
+        return (unsigned int) threads.size() + 1;
+    }
+
+    const OcclusionStats &Stats() const
+    {
+        return stats;
+    }
+
+private:
+    struct Level
+    {
+        int Width, Height;
+        std::vector<float> Depth;
+    };
+
+    // edge functions E(x, y) = A * x + B * y + C, positive inside, and the depth plane Z(x, y).
+    struct Triangle
+    {
+        float A[3], B[3], C[3];
+        float ZX, ZY, Z0;
+        float MinZ, MaxZ;
+        int MinX, MinY, MaxX, MaxY;
+    };
+
+    int width, height;
+    int tilesX, tilesY;
+    glm::mat4 viewProjection;
+    std::vector<Level> levels;
+    std::vector<Triangle> triangles;
+    std::vector<std::vector<uint32_t> > bins;
+    std::vector<glm::vec4> screen;
+    std::vector<glm::vec3> positions;
+    OcclusionStats stats;
+
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable wake, finished;
+    std::atomic<int> nextTile;
+    int doneTiles;
+    unsigned int generation;
+    bool stopping;
+
+    void setupTriangle(glm::vec4 v0, glm::vec4 v1, glm::vec4 v2)
+    {
+        if (v0.w < 0.0f || v1.w < 0.0f || v2.w < 0.0f)
+            return;
+        float area = (v1.x - v0.x) * (v2.y - v0.y) - (v2.x - v0.x) * (v1.y - v0.y);
+        if (area == 0.0f)
+            return;
+        // both windings are rasterized, a closed occluder is hidden behind its front faces anyway
+        if (area < 0.0f)
+        {
+            std::swap(v1, v2);
+            area = -area;
+        }
+
+        Triangle triangle;
+        triangle.MinX = std::max(0, (int) std::floor(std::min(v0.x, std::min(v1.x, v2.x))));
+        triangle.MinY = std::max(0, (int) std::floor(std::min(v0.y, std::min(v1.y, v2.y))));
+        triangle.MaxX = std::min(width - 1, (int) std::floor(std::max(v0.x, std::max(v1.x, v2.x))));
+        triangle.MaxY = std::min(height - 1, (int) std::floor(std::max(v0.y, std::max(v1.y, v2.y))));
+        if (triangle.MinX > triangle.MaxX || triangle.MinY > triangle.MaxY)
+            return;
+
+        const glm::vec4* v[3] = {&v0, &v1, &v2};
+        for (int e = 0; e < 3; e++)
+        {
+            const glm::vec4 &a = *v[e], &b = *v[(e + 1) % 3];
+            triangle.A[e] = a.y - b.y;
+            triangle.B[e] = b.x - a.x;
+            triangle.C[e] = a.x * b.y - a.y * b.x;
+        }
+        triangle.ZX = ((v1.z - v0.z) * (v2.y - v0.y) - (v2.z - v0.z) * (v1.y - v0.y)) / area;
+        triangle.ZY = ((v2.z - v0.z) * (v1.x - v0.x) - (v1.z - v0.z) * (v2.x - v0.x)) / area;
+        triangle.Z0 = v0.z - triangle.ZX * v0.x - triangle.ZY * v0.y;
+        // the plane is extrapolated a little at pixel centers outside the triangle, keep it within its vertices
+        triangle.MinZ = std::min(v0.z, std::min(v1.z, v2.z));
+        triangle.MaxZ = std::max(v0.z, std::max(v1.z, v2.z));
+
+        uint32_t index = (uint32_t) triangles.size();
+        triangles.push_back(triangle);
+        stats.Triangles++;
+        for (int ty = triangle.MinY / TILE_HEIGHT; ty <= triangle.MaxY / TILE_HEIGHT; ty++)
+        {
+            for (int tx = triangle.MinX / TILE_WIDTH; tx <= triangle.MaxX / TILE_WIDTH; tx++)
+                bins[ty * tilesX + tx].push_back(index);
+        }
+    }
+
+    void workerLoop()
+    {
+        unsigned int seen = 0;
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this, seen]() { return stopping || generation != seen; });
+                if (stopping)
+                    return;
+                seen = generation;
+            }
+            rasterizeTiles();
+        }
+    }
+
+    // takes tiles until there are none left.
+    void rasterizeTiles()
+    {
+        CPU_PROFILE_ZONE("OcclusionCuller::rasterizeTiles");
+        int count = (int) bins.size();
+        int tile;
+        while ((tile = nextTile.fetch_add(1)) < count)
+        {
+            rasterizeTile(tile);
+            std::lock_guard<std::mutex> lock(mutex);
+            if (++doneTiles == count)
+                finished.notify_all();
+        }
+    }
+
+    void rasterizeTile(int tile)
+    {
+        int tileX = (tile % tilesX) * TILE_WIDTH, tileY = (tile / tilesX) * TILE_HEIGHT;
+        float* depth = levels[0].Depth.data();
+        for (int y = tileY; y < tileY + TILE_HEIGHT; y++)
+            std::fill(depth + (size_t) y * width + tileX, depth + (size_t) y * width + tileX + TILE_WIDTH, 1.0f);
+
+        const std::vector<uint32_t> &bin = bins[tile];
+        for (unsigned int i = 0; i < bin.size(); i++)
+        {
+            const Triangle &t = triangles[bin[i]];
+            // x starts on a multiple of 4 so SSE loads/stores stay within the tile row
+            int x0 = std::max(t.MinX, tileX) & ~3, x1 = std::min(t.MaxX, tileX + TILE_WIDTH - 1);
+            int y0 = std::max(t.MinY, tileY), y1 = std::min(t.MaxY, tileY + TILE_HEIGHT - 1);
+            for (int y = y0; y <= y1; y++)
+                rasterizeRow(t, depth + (size_t) y * width, x0, x1, y);
+        }
+    }
+
+    void rasterizeRow(const Triangle &t, float* row, int x0, int x1, int y) const
+    {
+        float py = y + 0.5f;
+#if defined(OCCLUSION_CULLER_SSE)
+        const __m128 lanes = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+        const __m128 zero = _mm_setzero_ps();
+        __m128 a0 = _mm_set1_ps(t.A[0]), a1 = _mm_set1_ps(t.A[1]), a2 = _mm_set1_ps(t.A[2]);
+        __m128 r0 = _mm_set1_ps(t.B[0] * py + t.C[0]), r1 = _mm_set1_ps(t.B[1] * py + t.C[1]), r2 = _mm_set1_ps(t.B[2] * py + t.C[2]);
+        __m128 zx = _mm_set1_ps(t.ZX), zr = _mm_set1_ps(t.ZY * py + t.Z0);
+        __m128 minZ = _mm_set1_ps(t.MinZ), maxZ = _mm_set1_ps(t.MaxZ);
+        for (int x = x0; x <= x1; x += 4)
+        {
+            __m128 px = _mm_add_ps(_mm_set1_ps((float) x), lanes);
+            __m128 e0 = _mm_add_ps(_mm_mul_ps(a0, px), r0);
+            __m128 e1 = _mm_add_ps(_mm_mul_ps(a1, px), r1);
+            __m128 e2 = _mm_add_ps(_mm_mul_ps(a2, px), r2);
+            __m128 inside = _mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_and_ps(_mm_cmpge_ps(e1, zero), _mm_cmpge_ps(e2, zero)));
+            if (_mm_movemask_ps(inside) == 0)
+                continue;
+            __m128 z = _mm_min_ps(_mm_max_ps(_mm_add_ps(_mm_mul_ps(zx, px), zr), minZ), maxZ);
+            __m128 current = _mm_loadu_ps(row + x);
+            __m128 nearer = _mm_min_ps(current, z);
+            _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearer), _mm_andnot_ps(inside, current)));
+        }
+#else
+        for (int x = x0; x <= x1; x++)
+        {
+            float px = x + 0.5f;
+            if (t.A[0] * px + t.B[0] * py + t.C[0] < 0.0f || t.A[1] * px + t.B[1] * py + t.C[1] < 0.0f ||
+                t.A[2] * px + t.B[2] * py + t.C[2] < 0.0f)
+                continue;
+            float z = glm::clamp(t.ZX * px + t.ZY * py + t.Z0, t.MinZ, t.MaxZ);
+            row[x] = std::min(row[x], z);
+        }
+#endif
+    }
+
+    // every texel of a level keeps the farthest of the (up to) 2x2 texels below it.
+    void buildHierarchy()
+    {
+        for (unsigned int l = 1; l < levels.size(); l++)
+        {
+            const Level &source = levels[l - 1];
+            Level &target = levels[l];
+            for (int y = 0; y < target.Height; y++)
+            {
+                int sy0 = 2 * y, sy1 = std::min(2 * y + 1, source.Height - 1);
+                for (int x = 0; x < target.Width; x++)
+                {
+                    int sx0 = 2 * x, sx1 = std::min(2 * x + 1, source.Width - 1);
+                    float farthest = std::max(std::max(source.Depth[(size_t) sy0 * source.Width + sx0], source.Depth[(size_t) sy0 * source.Width + sx1]),
+                                              std::max(source.Depth[(size_t) sy1 * source.Width + sx0], source.Depth[(size_t) sy1 * source.Width + sx1]));
+                    target.Depth[(size_t) y * target.Width + x] = farthest;
+                }
+            }
+        }
+    }
+
+    // owns worker threads, not copyable
+    OcclusionCuller(const OcclusionCuller &);
+    OcclusionCuller &operator=(const OcclusionCuller &);
+};
+#endif
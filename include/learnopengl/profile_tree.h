@@ -0,0 +1,141 @@
+#ifndef PROFILE_TREE_H
+#define PROFILE_TREE_H
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// One named scope under its parent, with the time it took over the last HistorySize frames.
+struct ProfileNode
+{
+    enum
+    {
+        HistorySize = 128
+    };
+
+    const char* Name;           // the string literal the scope was opened with
+    int Parent;                 // -1 for a root
+    int Depth;
+    float Milliseconds;         // last frame (summed when the scope ran several times)
+    float Average;              // exponential moving average
+    unsigned int Calls;         // times the scope ran last frame
+    float History[HistorySize]; // ring, the oldest entry is at ProfileTree::HistoryHead()
+};
+
+// Timings aggregated per scope path, fed by the profilers and drawn by GUIManager. Has no GL dependency, so
+// the ImGui side can include it.
+//
+// Every frame: BeginFrame(), Add(Node(parent, name), ms) for every scope, EndFrame(). Nodes are created the
+// first time a path shows up and live on, a scope that didn't run in a frame records 0.
+class ProfileTree
+{
+public:
+    ProfileTree() : frames(0), head(0)
+    {
+    }
+
+    void BeginFrame()
+    {
+        for (unsigned int i = 0; i < nodes.size(); i++)
+        {
+            nodes[i].Milliseconds = 0.0f;
+            nodes[i].Calls = 0;
+        }
+    }
+
+    // index of the node for name under parent (-1 for a root), created on first use.
+    int Node(int parent, const char* name)
+    {
+        for (unsigned int i = 0; i < nodes.size(); i++)
+        {
+            if (nodes[i].Parent == parent && (nodes[i].Name == name || std::strcmp(nodes[i].Name, name) == 0))
+                return (int) i;
+        }
+        ProfileNode node;
+        std::memset(&node, 0, sizeof(node));
+        node.Name = name;
+        node.Parent = parent;
+        node.Depth = parent >= 0 ? nodes[parent].Depth + 1 : 0;
+        nodes.push_back(node);
+        return (int) nodes.size() - 1;
+    }
+
+    void Add(int node, double milliseconds)
+    {
+        nodes[node].Milliseconds += (float) milliseconds;
+        nodes[node].Calls++;
+    }
+
+    void EndFrame()
+    {
+        for (unsigned int i = 0; i < nodes.size(); i++)
+        {
+            ProfileNode &node = nodes[i];
+            node.History[head] = node.Milliseconds;
+            node.Average = frames == 0 ? node.Milliseconds : node.Average * 0.95f + node.Milliseconds * 0.05f;
+        }
+        head = (head + 1) % ProfileNode::HistorySize;
+        frames++;
+    }
+
+    void Clear()
+    {
+        nodes.clear();
+        frames = 0;
+        head = 0;
+    }
+
+    const std::vector<ProfileNode> &Nodes() const
+    {
+        return nodes;
+    }
+
+    unsigned int Frames() const
+    {
+        return frames;
+    }
+
+    // where the oldest history entry is, the offset to pass to ImGui::PlotLines.
+    unsigned int HistoryHead() const
+    {
+        return head;
+    }
+
+    // the nodes with their path ("frame/scene"), last, average, min and max over the history.
+    std::string ToJSON() const
+    {
+        std::string json = "{\"frames\": " + std::to_string(frames) + ", \"nodes\": [";
+        unsigned int count = std::min(frames, (unsigned int) ProfileNode::HistorySize);
+        char entry[256];
+        for (unsigned int i = 0; i < nodes.size(); i++)
+        {
+            const ProfileNode &node = nodes[i];
+            float low = count > 0 ? node.History[0] : 0.0f, high = low;
+            for (unsigned int h = 0; h < count; h++)
+            {
+                low = node.History[h] < low ? node.History[h] : low;
+                high = node.History[h] > high ? node.History[h] : high;
+            }
+            std::snprintf(entry, sizeof(entry), "%s{\"path\": \"%s\", \"depth\": %d, \"calls\": %u, \"ms\": %.4f, \"avg\": %.4f, \"min\": %.4f, \"max\": %.4f}",
+                          i > 0 ? ", " : "", path(i).c_str(), node.Depth, node.Calls, node.Milliseconds, node.Average, low, high);
+            json += entry;
+        }
+        return json + "]}";
+    }
+
+private:
+    std::vector<ProfileNode> nodes;
+    unsigned int frames;
+    unsigned int head;
+
+    std::string path(int node) const
+    {
+        std::string result = nodes[node].Name;
+        for (int parent = nodes[node].Parent; parent >= 0; parent = nodes[parent].Parent)
+            result = std::string(nodes[parent].Name) + "/" + result;
+        return result;
+    }
+};
+#endif
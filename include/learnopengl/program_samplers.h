@@ -0,0 +1,120 @@
+#ifndef PROGRAM_SAMPLERS_H
+#define PROGRAM_SAMPLERS_H
+
+#include <glad/glad.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+// Sampler uniform -> texture unit assignment of a program, read once so the sampler uniforms never have to be
+// touched again while drawing.
+//
+// The units come from the program: programs with generated parameters get theirs from ShaderParams::<name>::Setup()
+// (the Sampler enum), which drops the cached entry so the next lookup reads the new units back. Only a program
+// nobody assigned units to (its samplers still share the default unit 0) gets one unit per sampler here, in
+// active uniform order.
+class ProgramSamplers
+{
+public:
+    struct Sampler
+    {
+        std::string name;
+        GLint unit;
+    };
+
+    // returns the unit of the named sampler in program, or -1 if the program doesn't use it.
+    static GLint UnitOf(unsigned int program, const std::string &name)
+    {
+        const std::vector<Sampler> &samplers = resolve(program);
+        for (unsigned int i = 0; i < samplers.size(); i++)
+        {
+            if (samplers[i].name == name)
+                return samplers[i].unit;
+        }
+        return -1;
+    }
+
+    // forgets the assignment of a program. Called when the program gets deleted (ShaderLibrary::Clear()) or its
+    // units are assigned again (Setup()), GL recycles program names.
+    static void Invalidate(unsigned int program)
+    {
+        cache().erase(program);
+        generation()++;
+    }
+
+    // bumped by every Invalidate(). Whatever was derived from UnitOf() (the MaterialBindings of meshes) is
+    // stamped with it and resolved again once it differs: one compare per draw instead of a lookup.
+    static unsigned int Generation()
+    {
+        return generation();
+    }
+
+private:
+    static unsigned int &generation()
+    {
+        static unsigned int counter = 0;
+        return counter;
+    }
+
+    static std::map<unsigned int, std::vector<Sampler> > &cache()
+    {
+        static std::map<unsigned int, std::vector<Sampler> > programs;
+        return programs;
+    }
+
+    static bool isSampler(GLenum type)
+    {
+        switch (type)
+        {
+            case GL_SAMPLER_1D: case GL_SAMPLER_2D: case GL_SAMPLER_3D: case GL_SAMPLER_CUBE:
+            case GL_SAMPLER_2D_SHADOW: case GL_SAMPLER_2D_ARRAY: case GL_SAMPLER_2D_ARRAY_SHADOW:
+            case GL_SAMPLER_CUBE_SHADOW: case GL_SAMPLER_2D_MULTISAMPLE: case GL_SAMPLER_BUFFER:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    static const std::vector<Sampler> &resolve(unsigned int program)
+    {
+        std::map<unsigned int, std::vector<Sampler> >::iterator it = cache().find(program);
+        if (it != cache().end())
+            return it->second;
+
+        std::vector<Sampler> &samplers = cache()[program];
+        std::vector<GLint> locations;
+        bool shared = false;
+        GLint count = 0;
+        glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+        for (GLint i = 0; i < count; i++)
+        {
+            GLchar name[256];
+            GLint size;
+            GLenum type;
+            glGetActiveUniform(program, i, sizeof(name), NULL, &size, &type, name);
+            if (!isSampler(type))
+                continue;
+            Sampler sampler;
+            sampler.name = name;
+            GLint location = glGetUniformLocation(program, name);
+            glGetUniformiv(program, location, &sampler.unit);
+            for (unsigned int j = 0; j < samplers.size(); j++)
+                shared = shared || samplers[j].unit == sampler.unit;
+            samplers.push_back(sampler);
+            locations.push_back(location);
+        }
+
+        // nothing assigned the units yet
+        if (shared)
+        {
+            for (unsigned int i = 0; i < samplers.size(); i++)
+            {
+                samplers[i].unit = (GLint) i;
+                glProgramUniform1i(program, locations[i], samplers[i].unit);
+            }
+        }
+        return samplers;
+    }
+};
+#endif
@@ -0,0 +1,665 @@
+#ifndef RENDER_GRAPH_H
+#define RENDER_GRAPH_H
+
+#include <glad/glad.h>
+
+#include <learnopengl/memory_tracker.h>
+
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// size and internal format of a 2D render target.
+struct RenderTextureDesc
+{
+    int Width;
+    int Height;
+    GLenum Format;
+
+    bool operator==(const RenderTextureDesc &other) const
+    {
+        return Width == other.Width && Height == other.Height && Format == other.Format;
+    }
+};
+
+// Result of the last Compile().
+struct RenderGraphStats
+{
+    unsigned int Passes;            // passes that will execute
+    unsigned int CulledPasses;      // passes nothing visible depends on
+    unsigned int Barriers;          // glMemoryBarrier calls per Execute()
+    unsigned int TransientTextures;
+    unsigned int PhysicalTextures;  // GL textures backing them after aliasing
+    size_t TransientBytes;          // memory with one texture per transient resource
+    size_t PhysicalBytes;           // memory actually allocated
+
+    size_t SavedBytes() const
+    {
+        return TransientBytes - PhysicalBytes;
+    }
+};
+
+// Declarative frame setup: passes say which resources they read and write, Compile() works out the rest.
+//
+//   * passes whose output never reaches an imported resource (the backbuffer, a persistent texture) or that
+//     aren't marked SideEffect() are culled
+//   * the remaining ones are ordered so that every pass runs after the writers of what it reads (ties keep
+//     the declaration order)
+//   * a glMemoryBarrier is inserted where a resource written through image stores gets read or rendered to
+//   * transient render targets whose lifetimes don't overlap share one GL texture. Core GL has no way to place
+//     two textures in the same memory, so only targets with identical size and format alias each other. The
+//     contents of a transient target are undefined when its first writer starts, that pass must clear it.
+//
+// Build the graph once (again after Reset() when sizes change), Compile(), then Execute() every frame.
+// GL objects are only created and deleted inside Execute() and the destructor.
+class RenderGraph
+{
+public:
+    typedef int Resource;
+    typedef std::function<void(const RenderGraph &)> ExecuteFunction;
+
+    enum Access
+    {
+        RenderTarget,   // framebuffer attachment
+        Sampled,        // texture fetch
+        Storage         // image load/store
+    };
+
+    class PassBuilder
+    {
+    public:
+        PassBuilder(RenderGraph* graph, int pass) : graph(graph), pass(pass)
+        {
+        }
+
+        PassBuilder &Read(Resource resource, Access access = Sampled)
+        {
+            graph->passes[pass].Reads.push_back(Use{resource, access});
+            return *this;
+        }
+
+        PassBuilder &Write(Resource resource, Access access = RenderTarget)
+        {
+            graph->passes[pass].Writes.push_back(Use{resource, access});
+            return *this;
+        }
+
+        // the pass does something outside the graph (reads back, presents...), never cull it.
+        PassBuilder &SideEffect()
+        {
+            graph->passes[pass].SideEffect = true;
+            return *this;
+        }
+
+    private:
+        RenderGraph* graph;
+        int pass;
+    };
+
+    RenderGraph() : compiled(false)
+    {
+        std::memset(&stats, 0, sizeof(stats));
+    }
+
+    ~RenderGraph()
+    {
+        for (unsigned int i = 0; i < physical.size(); i++)
+            garbageTextures.push_back(physical[i].Texture);
+        for (unsigned int i = 0; i < pool.size(); i++)
+            garbageTextures.push_back(pool[i].Texture);
+        for (unsigned int i = 0; i < passes.size(); i++)
+            garbageFramebuffers.push_back(passes[i].Framebuffer);
+        collectGarbage();
+    }
+
+    // the default framebuffer. Writing it keeps a pass alive.
+    Resource ImportBackbuffer(const std::string &name, int width, int height)
+    {
+        RenderTextureDesc desc = {width, height, GL_RGBA8};
+        return addResource(name, desc, true, 0, true);
+    }
+
+    // new size of the default framebuffer, call it from the window's framebuffer size callback.
+    void ResizeBackbuffer(int width, int height)
+    {
+        for (unsigned int i = 0; i < resources.size(); i++)
+        {
+            if (resources[i].Backbuffer)
+            {
+                resources[i].Desc.Width = width;
+                resources[i].Desc.Height = height;
+            }
+        }
+    }
+
+    // a texture owned outside the graph (persistent across frames). Writing it keeps a pass alive.
+    Resource Import(const std::string &name, unsigned int texture, const RenderTextureDesc &desc)
+    {
+        return addResource(name, desc, true, texture, false);
+    }
+
+    // a render target only living within the frame, backed by a pooled (possibly shared) texture.
+    Resource CreateTexture(const std::string &name, const RenderTextureDesc &desc)
+    {
+        return addResource(name, desc, false, 0, false);
+    }
+
+    PassBuilder AddPass(const std::string &name, const ExecuteFunction &execute)
+    {
+        Pass pass;
+        pass.Name = name;
+        pass.Execute = execute;
+        pass.SideEffect = false;
+        pass.Framebuffer = 0;
+        pass.Barrier = 0;
+        passes.push_back(pass);
+        compiled = false;
+        return PassBuilder(this, (int) passes.size() - 1);
+    }
+
+    // forgets every pass and resource. Physical textures stay pooled for the next Compile().
+    void Reset()
+    {
+        for (unsigned int i = 0; i < physical.size(); i++)
+            pool.push_back(physical[i]);
+        physical.clear();
+        for (unsigned int i = 0; i < passes.size(); i++)
+            garbageFramebuffers.push_back(passes[i].Framebuffer);
+        passes.clear();
+        resources.clear();
+        order.clear();
+        compiled = false;
+    }
+
+    // culls, orders, places barriers and assigns physical textures. Returns false on an invalid graph.
+    bool Compile()
+    {
+        std::memset(&stats, 0, sizeof(stats));
+        if (!cull() || !sort() || !validate())
+            return false;
+        placeBarriers();
+        alias();
+        for (unsigned int i = 0; i < passes.size(); i++)
+        {
+            garbageFramebuffers.push_back(passes[i].Framebuffer);
+            passes[i].Framebuffer = 0;
+        }
+        stats.Passes = (unsigned int) order.size();
+        stats.CulledPasses = (unsigned int) (passes.size() - order.size());
+        compiled = true;
+        return true;
+    }
+
+    // runs the passes in order, each one with its render targets bound.
+    void Execute()
+    {
+        if (!compiled)
+        {
+            std::cout << "ERROR::RENDER_GRAPH::NOT_COMPILED" << std::endl;
+            return;
+        }
+        collectGarbage();
+        realize();
+        for (unsigned int i = 0; i < order.size(); i++)
+        {
+            Pass &pass = passes[order[i]];
+            if (pass.Barrier != 0)
+                glMemoryBarrier(pass.Barrier);
+            const RenderTextureDesc* target = renderTargetDesc(pass);
+            // every pass gets the viewport of its target, a backbuffer pass after an offscreen one of another
+            // size included (the backbuffer size is kept up to date by ResizeBackbuffer())
+            if (target != nullptr)
+            {
+                glBindFramebuffer(GL_FRAMEBUFFER, pass.Framebuffer);
+                glViewport(0, 0, target->Width, target->Height);
+            }
+            pass.Execute(*this);
+        }
+    }
+
+    // GL texture currently backing a resource (0 for the backbuffer), for passes to bind what they read.
+    unsigned int Texture(Resource resource) const
+    {
+        const ResourceNode &node = resources[resource];
+        if (node.Imported)
+            return node.Texture;
+        return node.Physical >= 0 ? physical[node.Physical].Texture : 0;
+    }
+
+    const RenderTextureDesc &Desc(Resource resource) const
+    {
+        return resources[resource].Desc;
+    }
+
+    // pass indices in execution order.
+    const std::vector<int> &Order() const
+    {
+        return order;
+    }
+
+    const std::string &PassName(int pass) const
+    {
+        return passes[pass].Name;
+    }
+
+    const RenderGraphStats &Stats() const
+    {
+        return stats;
+    }
+
+    // bytes per texel of the formats render targets commonly use, 4 for anything else.
+    static size_t BytesPerTexel(GLenum format)
+    {
+        switch (format)
+        {
+            case GL_R8: return 1;
+            case GL_RG8: case GL_R16F: case GL_DEPTH_COMPONENT16: return 2;
+            case GL_RGB8: case GL_DEPTH_COMPONENT24: return 3;
+            case GL_RGBA16F: case GL_RG32F: case GL_DEPTH32F_STENCIL8: return 8;
+            case GL_RGBA32F: return 16;
+            default: return 4;
+        }
+    }
+
+    static bool IsDepthFormat(GLenum format)
+    {
+        return format == GL_DEPTH_COMPONENT16 || format == GL_DEPTH_COMPONENT24 || format == GL_DEPTH_COMPONENT32F ||
+               format == GL_DEPTH24_STENCIL8 || format == GL_DEPTH32F_STENCIL8;
+    }
+
+private:
+    struct Use
+    {
+        Resource Id;
+        Access Mode;
+    };
+
+    struct Pass
+    {
+        std::string Name;
+        ExecuteFunction Execute;
+        std::vector<Use> Reads;
+        std::vector<Use> Writes;
+        bool SideEffect;
+        bool Alive;
+        unsigned int Framebuffer;
+        GLbitfield Barrier;
+    };
+
+    struct ResourceNode
+    {
+        std::string Name;
+        RenderTextureDesc Desc;
+        bool Imported;
+        bool Backbuffer;
+        unsigned int Texture;   // imported textures only
+        int Physical;           // transient textures: index in physical
+        int FirstUse, LastUse;  // positions in order
+    };
+
+    struct PhysicalTexture
+    {
+        RenderTextureDesc Desc;
+        unsigned int Texture;
+        int LastUse;
+    };
+
+    std::vector<Pass> passes;
+    std::vector<ResourceNode> resources;
+    std::vector<int> order;
+    std::vector<PhysicalTexture> physical;
+    std::vector<PhysicalTexture> pool;      // textures of earlier compiles, reused when the desc matches
+    std::vector<unsigned int> garbageTextures, garbageFramebuffers;
+    RenderGraphStats stats;
+    bool compiled;
+
+    Resource addResource(const std::string &name, const RenderTextureDesc &desc, bool imported, unsigned int texture, bool backbuffer)
+    {
+        ResourceNode node;
+        node.Name = name;
+        node.Desc = desc;
+        node.Imported = imported;
+        node.Backbuffer = backbuffer;
+        node.Texture = texture;
+        node.Physical = -1;
+        node.FirstUse = node.LastUse = -1;
+        resources.push_back(node);
+        compiled = false;
+        return (Resource) resources.size() - 1;
+    }
+
+    static bool uses(const std::vector<Use> &list, Resource resource)
+    {
+        for (unsigned int i = 0; i < list.size(); i++)
+        {
+            if (list[i].Id == resource)
+                return true;
+        }
+        return false;
+    }
+
+    // alive: passes with side effects or writing an imported resource, and every writer of what an alive pass reads.
+    bool cull()
+    {
+        std::vector<int> work;
+        for (unsigned int p = 0; p < passes.size(); p++)
+        {
+            passes[p].Alive = passes[p].SideEffect;
+            for (unsigned int w = 0; w < passes[p].Writes.size(); w++)
+                passes[p].Alive = passes[p].Alive || resources[passes[p].Writes[w].Id].Imported;
+            if (passes[p].Alive)
+                work.push_back(p);
+        }
+        while (!work.empty())
+        {
+            const Pass &pass = passes[work.back()];
+            work.pop_back();
+            for (unsigned int r = 0; r < pass.Reads.size(); r++)
+            {
+                for (unsigned int p = 0; p < passes.size(); p++)
+                {
+                    if (!passes[p].Alive && uses(passes[p].Writes, pass.Reads[r].Id))
+                    {
+                        passes[p].Alive = true;
+                        work.push_back(p);
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+    // topological order of the alive passes: writers of a resource in declaration order, readers after all
+    // of them. The earliest declared ready pass always goes first.
+    bool sort()
+    {
+        size_t count = passes.size();
+        std::vector<std::vector<int> > edges(count);
+        std::vector<int> incoming(count, 0);
+        for (unsigned int r = 0; r < resources.size(); r++)
+        {
+            int previousWriter = -1;
+            for (unsigned int p = 0; p < count; p++)
+            {
+                if (!passes[p].Alive || !uses(passes[p].Writes, r))
+                    continue;
+                if (previousWriter >= 0)
+                {
+                    edges[previousWriter].push_back(p);
+                    incoming[p]++;
+                }
+                previousWriter = p;
+            }
+            for (unsigned int p = 0; p < count; p++)
+            {
+                if (!passes[p].Alive || !uses(passes[p].Reads, r) || uses(passes[p].Writes, r))
+                    continue;
+                for (unsigned int w = 0; w < count; w++)
+                {
+                    if (passes[w].Alive && uses(passes[w].Writes, r))
+                    {
+                        edges[w].push_back(p);
+                        incoming[p]++;
+                    }
+                }
+            }
+        }
+
+        order.clear();
+        std::vector<bool> done(count, false);
+        unsigned int alive = 0;
+        for (unsigned int p = 0; p < count; p++)
+            alive += passes[p].Alive ? 1 : 0;
+        while (order.size() < alive)
+        {
+            int next = -1;
+            for (unsigned int p = 0; p < count && next < 0; p++)
+            {
+                if (passes[p].Alive && !done[p] && incoming[p] == 0)
+                    next = p;
+            }
+            if (next < 0)
+            {
+                std::cout << "ERROR::RENDER_GRAPH::CYCLE" << std::endl;
+                return false;
+            }
+            done[next] = true;
+            order.push_back(next);
+            for (unsigned int e = 0; e < edges[next].size(); e++)
+                incoming[edges[next][e]]--;
+        }
+        return true;
+    }
+
+    // every read needs a writer, render targets of one pass must agree on their size.
+    bool validate()
+    {
+        for (unsigned int r = 0; r < resources.size(); r++)
+            resources[r].FirstUse = resources[r].LastUse = -1;
+        for (unsigned int i = 0; i < order.size(); i++)
+        {
+            const Pass &pass = passes[order[i]];
+            for (unsigned int r = 0; r < pass.Reads.size(); r++)
+            {
+                ResourceNode &node = resources[pass.Reads[r].Id];
+                if (!node.Imported && node.FirstUse < 0)
+                {
+                    std::cout << "ERROR::RENDER_GRAPH::READ_BEFORE_WRITE " << pass.Name << " reads " << node.Name << std::endl;
+                    return false;
+                }
+                node.LastUse = i;
+            }
+            const RenderTextureDesc* target = nullptr;
+            bool backbuffer = false, offscreen = false;
+            for (unsigned int w = 0; w < pass.Writes.size(); w++)
+            {
+                ResourceNode &node = resources[pass.Writes[w].Id];
+                if (node.FirstUse < 0)
+                    node.FirstUse = i;
+                node.LastUse = i;
+                if (pass.Writes[w].Mode != RenderTarget)
+                    continue;
+                backbuffer = backbuffer || node.Backbuffer;
+                offscreen = offscreen || !node.Backbuffer;
+                if (target != nullptr && (target->Width != node.Desc.Width || target->Height != node.Desc.Height))
+                {
+                    std::cout << "ERROR::RENDER_GRAPH::TARGET_SIZE_MISMATCH " << pass.Name << std::endl;
+                    return false;
+                }
+                target = &node.Desc;
+            }
+            if (backbuffer && offscreen)
+            {
+                std::cout << "ERROR::RENDER_GRAPH::BACKBUFFER_WITH_OFFSCREEN_TARGETS " << pass.Name << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // render target writes and texture fetches are ordered by GL itself, only image stores need barriers.
+    void placeBarriers()
+    {
+        std::vector<Access> lastWrite(resources.size(), RenderTarget);
+        for (unsigned int i = 0; i < order.size(); i++)
+        {
+            Pass &pass = passes[order[i]];
+            pass.Barrier = 0;
+            for (unsigned int r = 0; r < pass.Reads.size(); r++)
+            {
+                if (lastWrite[pass.Reads[r].Id] == Storage)
+                    pass.Barrier |= pass.Reads[r].Mode == Storage ? GL_SHADER_IMAGE_ACCESS_BARRIER_BIT : GL_TEXTURE_FETCH_BARRIER_BIT;
+            }
+            for (unsigned int w = 0; w < pass.Writes.size(); w++)
+            {
+                Resource resource = pass.Writes[w].Id;
+                if (lastWrite[resource] == Storage)
+                    pass.Barrier |= pass.Writes[w].Mode == Storage ? GL_SHADER_IMAGE_ACCESS_BARRIER_BIT : GL_FRAMEBUFFER_BARRIER_BIT;
+                lastWrite[resource] = pass.Writes[w].Mode;
+            }
+            if (pass.Barrier != 0)
+                stats.Barriers++;
+        }
+    }
+
+    // greedy interval assignment: transient resources by first use, each takes the first physical texture
+    // with the same desc that is free again by then.
+    void alias()
+    {
+        for (unsigned int i = 0; i < physical.size(); i++)
+            pool.push_back(physical[i]);
+        physical.clear();
+
+        std::vector<int> transients;
+        for (unsigned int r = 0; r < resources.size(); r++)
+        {
+            resources[r].Physical = -1;
+            if (!resources[r].Imported && resources[r].FirstUse >= 0)
+                transients.push_back(r);
+        }
+        for (unsigned int i = 1; i < transients.size(); i++)
+        {
+            for (unsigned int j = i; j > 0 && resources[transients[j]].FirstUse < resources[transients[j - 1]].FirstUse; j--)
+                std::swap(transients[j], transients[j - 1]);
+        }
+
+        for (unsigned int t = 0; t < transients.size(); t++)
+        {
+            ResourceNode &node = resources[transients[t]];
+            size_t bytes = (size_t) node.Desc.Width * node.Desc.Height * BytesPerTexel(node.Desc.Format);
+            stats.TransientTextures++;
+            stats.TransientBytes += bytes;
+            for (unsigned int p = 0; p < physical.size() && node.Physical < 0; p++)
+            {
+                if (physical[p].Desc == node.Desc && physical[p].LastUse < node.FirstUse)
+                    node.Physical = p;
+            }
+            if (node.Physical < 0)
+            {
+                PhysicalTexture texture;
+                texture.Desc = node.Desc;
+                texture.Texture = takeFromPool(node.Desc);
+                physical.push_back(texture);
+                node.Physical = (int) physical.size() - 1;
+                stats.PhysicalTextures++;
+                stats.PhysicalBytes += bytes;
+            }
+            physical[node.Physical].LastUse = node.LastUse;
+        }
+
+        // whatever the new layout doesn't need is freed on the next Execute()
+        for (unsigned int i = 0; i < pool.size(); i++)
+            garbageTextures.push_back(pool[i].Texture);
+        pool.clear();
+    }
+
+    unsigned int takeFromPool(const RenderTextureDesc &desc)
+    {
+        for (unsigned int i = 0; i < pool.size(); i++)
+        {
+            if (pool[i].Desc == desc)
+            {
+                unsigned int texture = pool[i].Texture;
+                pool.erase(pool.begin() + i);
+                return texture;
+            }
+        }
+        return 0;
+    }
+
+    const RenderTextureDesc* renderTargetDesc(const Pass &pass) const
+    {
+        for (unsigned int w = 0; w < pass.Writes.size(); w++)
+        {
+            if (pass.Writes[w].Mode == RenderTarget)
+                return &resources[pass.Writes[w].Id].Desc;
+        }
+        return nullptr;
+    }
+
+    // creates the physical textures and the framebuffer of every pass rendering offscreen.
+    void realize()
+    {
+        for (unsigned int p = 0; p < physical.size(); p++)
+        {
+            if (physical[p].Texture != 0)
+                continue;
+            const RenderTextureDesc &desc = physical[p].Desc;
+            glCreateTextures(GL_TEXTURE_2D, 1, &physical[p].Texture);
+            glTextureStorage2D(physical[p].Texture, 1, desc.Format, desc.Width, desc.Height);
+            glTextureParameteri(physical[p].Texture, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTextureParameteri(physical[p].Texture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTextureParameteri(physical[p].Texture, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTextureParameteri(physical[p].Texture, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            MemoryTracker::Instance().SetGpu(MemoryTracker::RENDER_TARGETS, physical[p].Texture,
+                                             (int64_t) desc.Width * desc.Height * BytesPerTexel(desc.Format),
+                                             ("render target " + std::to_string(desc.Width) + "x" + std::to_string(desc.Height)).c_str());
+        }
+
+        for (unsigned int i = 0; i < order.size(); i++)
+        {
+            Pass &pass = passes[order[i]];
+            const RenderTextureDesc* target = renderTargetDesc(pass);
+            if (pass.Framebuffer != 0 || target == nullptr)
+                continue;
+            GLenum drawBuffers[8];
+            int colors = 0;
+            bool backbuffer = false;
+            for (unsigned int w = 0; w < pass.Writes.size(); w++)
+            {
+                const ResourceNode &node = resources[pass.Writes[w].Id];
+                backbuffer = backbuffer || node.Backbuffer;
+                if (pass.Writes[w].Mode != RenderTarget || node.Backbuffer)
+                    continue;
+                if (pass.Framebuffer == 0)
+                    glCreateFramebuffers(1, &pass.Framebuffer);
+                unsigned int texture = Texture(pass.Writes[w].Id);
+                if (IsDepthFormat(node.Desc.Format))
+                {
+                    GLenum attachment = node.Desc.Format == GL_DEPTH24_STENCIL8 || node.Desc.Format == GL_DEPTH32F_STENCIL8 ?
+                                        GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT;
+                    glNamedFramebufferTexture(pass.Framebuffer, attachment, texture, 0);
+                }
+                else if (colors < 8)
+                {
+                    drawBuffers[colors] = GL_COLOR_ATTACHMENT0 + colors;
+                    glNamedFramebufferTexture(pass.Framebuffer, drawBuffers[colors], texture, 0);
+                    colors++;
+                }
+            }
+            if (backbuffer || pass.Framebuffer == 0)
+                continue;
+            if (colors > 0)
+                glNamedFramebufferDrawBuffers(pass.Framebuffer, colors, drawBuffers);
+            else
+                glNamedFramebufferDrawBuffer(pass.Framebuffer, GL_NONE);
+            if (glCheckNamedFramebufferStatus(pass.Framebuffer, GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+                std::cout << "ERROR::RENDER_GRAPH::FRAMEBUFFER_INCOMPLETE " << pass.Name << std::endl;
+        }
+    }
+
+    void collectGarbage()
+    {
+        for (unsigned int i = 0; i < garbageTextures.size(); i++)
+        {
+            if (garbageTextures[i] == 0)
+                continue;
+            glDeleteTextures(1, &garbageTextures[i]);
+            MemoryTracker::Instance().Release(MemoryTracker::RENDER_TARGETS, garbageTextures[i]);
+        }
+        for (unsigned int i = 0; i < garbageFramebuffers.size(); i++)
+        {
+            if (garbageFramebuffers[i] != 0)
+                glDeleteFramebuffers(1, &garbageFramebuffers[i]);
+        }
+        garbageTextures.clear();
+        garbageFramebuffers.clear();
+    }
+
+    // owns GL objects, not copyable
+    RenderGraph(const RenderGraph &);
+    RenderGraph &operator=(const RenderGraph &);
+};
+#endif
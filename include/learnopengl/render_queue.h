@@ -0,0 +1,271 @@
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <learnopengl/mesh.h>
+#include <learnopengl/cpu_profiler.h>
+
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+// Everything needed to issue one draw call.
+struct DrawPacket
+{
+    unsigned int Program;
+    const MaterialBinding* Material;
+    unsigned int VAO;
+    unsigned int Count;      // number of indices
+    unsigned int FirstIndex;
+    float Depth;             // view distance, used to order the packets
+    bool Transparent;
+    glm::mat4 Model;         // uploaded to the "model" uniform of the program
+};
+
+// State changes of the last submitted frame. Unsorted* is what drawing the packets in the order they were
+// pushed would have cost, the other counters are what the sorted submission actually issued.
+struct RenderQueueStats
+{
+    unsigned int Draws;
+    unsigned int ProgramBinds;
+    unsigned int MaterialBinds;
+    unsigned int VAOBinds;
+    unsigned int UnsortedProgramBinds;
+    unsigned int UnsortedMaterialBinds;
+    unsigned int UnsortedVAOBinds;
+
+    unsigned int StateChanges() const
+    {
+        return ProgramBinds + MaterialBinds + VAOBinds;
+    }
+    unsigned int UnsortedStateChanges() const
+    {
+        return UnsortedProgramBinds + UnsortedMaterialBinds + UnsortedVAOBinds;
+    }
+};
+
+// Collects the draw packets of a frame, orders them with a 64 bit sort key and submits them while skipping
+// every program/material/VAO bind that is already current.
+//
+// Key layout (most significant bit first):
+//   opaque:      0 | program (12) | material (16) | vao (16) | depth (19, front to back)
+//   transparent: 1 | depth (24, back to front) | program (12) | material (16) | vao (11)
+// Programs, materials and VAOs get a dense per frame index in the order they are first seen, so a frame can
+// hold up to 4096 programs and 65536 materials before keys start to collide (which only costs binds).
+class RenderQueue
+{
+public:
+    bool SortingEnabled;
+
+    RenderQueue() : SortingEnabled(true), nearPlane(0.1f), farPlane(100.0f)
+    {
+        std::memset(&stats, 0, sizeof(stats));
+    }
+
+    // depth range used to quantize DrawPacket::Depth into the key.
+    void SetDepthRange(float nearPlane, float farPlane)
+    {
+        this->nearPlane = nearPlane;
+        this->farPlane = farPlane;
+    }
+
+    void Clear()
+    {
+        packets.clear();
+        keys.clear();
+        programIndices.clear();
+        materialIndices.clear();
+        vaoIndices.clear();
+    }
+
+    void Push(const DrawPacket &packet)
+    {
+        uint64_t program = denseIndex(programIndices, packet.Program);
+        uint64_t material = denseIndex(materialIndices, materialHash(packet.Material));
+        uint64_t vao = denseIndex(vaoIndices, packet.VAO);
+        float range = farPlane > nearPlane ? farPlane - nearPlane : 1.0f;
+        float depth = glm::clamp((packet.Depth - nearPlane) / range, 0.0f, 1.0f);
+
+        uint64_t key;
+        if (!packet.Transparent)
+        {
+            key = ((program & 0xFFF) << 51) | ((material & 0xFFFF) << 35) | ((vao & 0xFFFF) << 19) |
+                  (uint64_t) (depth * 0x7FFFF);
+        }
+        else
+        {
+            uint64_t farToNear = (uint64_t) ((1.0f - depth) * 0xFFFFFF);
+            key = (1ull << 63) | (farToNear << 39) | ((program & 0xFFF) << 27) | ((material & 0xFFFF) << 11) |
+                  (vao & 0x7FF);
+        }
+        keys.push_back(key);
+        packets.push_back(packet);
+    }
+
+    // radix sorts the packets by key (a no-op when SortingEnabled is false).
+    void Sort()
+    {
+        order.resize(packets.size());
+        for (unsigned int i = 0; i < order.size(); i++)
+            order[i] = i;
+        if (SortingEnabled)
+            radixSort();
+    }
+
+    // issues the draws in sorted order. Expects Sort() to have been called this frame.
+    void Submit()
+    {
+        CPU_PROFILE_ZONE("RenderQueue::Submit");
+        std::memset(&stats, 0, sizeof(stats));
+        countUnsorted();
+
+        unsigned int program = 0, vao = 0;
+        const MaterialBinding* material = nullptr;
+        GLint modelLocation = -1;
+        bool first = true;
+        for (unsigned int i = 0; i < order.size(); i++)
+        {
+            const DrawPacket &packet = packets[order[i]];
+            if (first || packet.Program != program)
+            {
+                glUseProgram(packet.Program);
+                program = packet.Program;
+                modelLocation = modelUniform(program);
+                stats.ProgramBinds++;
+            }
+            if (first || !sameMaterial(packet.Material, material))
+            {
+                if (packet.Material != nullptr)
+                {
+                    for (unsigned int t = 0; t < packet.Material->count; t++)
+                        glBindTextureUnit(packet.Material->units[t], packet.Material->textures[t]);
+                }
+                material = packet.Material;
+                stats.MaterialBinds++;
+            }
+            if (first || packet.VAO != vao)
+            {
+                glBindVertexArray(packet.VAO);
+                vao = packet.VAO;
+                stats.VAOBinds++;
+            }
+            first = false;
+
+            if (modelLocation >= 0)
+                glUniformMatrix4fv(modelLocation, 1, GL_FALSE, &packet.Model[0][0]);
+            glDrawElements(GL_TRIANGLES, packet.Count, GL_UNSIGNED_INT, (void*) (sizeof(unsigned int) * packet.FirstIndex));
+            stats.Draws++;
+        }
+        glBindVertexArray(0);
+    }
+
+    const RenderQueueStats &Stats() const
+    {
+        return stats;
+    }
+
+    unsigned int Size() const
+    {
+        return (unsigned int) packets.size();
+    }
+
+private:
+    std::vector<DrawPacket> packets;
+    std::vector<uint64_t> keys;
+    std::vector<uint32_t> order;
+    std::vector<uint32_t> scratch;
+    std::unordered_map<uint64_t, uint32_t> programIndices;
+    std::unordered_map<uint64_t, uint32_t> materialIndices;
+    std::unordered_map<uint64_t, uint32_t> vaoIndices;
+    std::unordered_map<unsigned int, GLint> modelLocations;
+    RenderQueueStats stats;
+    float nearPlane, farPlane;
+
+    static uint32_t denseIndex(std::unordered_map<uint64_t, uint32_t> &indices, uint64_t value)
+    {
+        std::unordered_map<uint64_t, uint32_t>::iterator it = indices.find(value);
+        if (it != indices.end())
+            return it->second;
+        uint32_t index = (uint32_t) indices.size();
+        indices[value] = index;
+        return index;
+    }
+
+    // materials are compared by content, two meshes sampling the same textures share a material.
+    static uint64_t materialHash(const MaterialBinding* material)
+    {
+        if (material == nullptr)
+            return 0;
+        uint64_t hash = 14695981039346656037ull;
+        for (unsigned int i = 0; i < material->count; i++)
+        {
+            hash = (hash ^ material->units[i]) * 1099511628211ull;
+            hash = (hash ^ material->textures[i]) * 1099511628211ull;
+        }
+        return hash;
+    }
+
+    static bool sameMaterial(const MaterialBinding* a, const MaterialBinding* b)
+    {
+        if (a == b)
+            return true;
+        if (a == nullptr || b == nullptr || a->count != b->count)
+            return false;
+        return std::memcmp(a->units, b->units, a->count * sizeof(GLuint)) == 0 &&
+               std::memcmp(a->textures, b->textures, a->count * sizeof(GLuint)) == 0;
+    }
+
+    GLint modelUniform(unsigned int program)
+    {
+        std::unordered_map<unsigned int, GLint>::iterator it = modelLocations.find(program);
+        if (it != modelLocations.end())
+            return it->second;
+        GLint location = glGetUniformLocation(program, "model");
+        modelLocations[program] = location;
+        return location;
+    }
+
+    // LSD radix sort of order[] by keys[], 8 bits per pass. Passes where every key has the same byte are skipped.
+    void radixSort()
+    {
+        if (order.empty())
+            return;
+        scratch.resize(order.size());
+        for (int shift = 0; shift < 64; shift += 8)
+        {
+            unsigned int counts[256] = {0};
+            for (unsigned int i = 0; i < order.size(); i++)
+                counts[(keys[order[i]] >> shift) & 0xFF]++;
+            if (counts[(keys[order[0]] >> shift) & 0xFF] == order.size())
+                continue;
+            unsigned int offset = 0;
+            for (int b = 0; b < 256; b++)
+            {
+                unsigned int count = counts[b];
+                counts[b] = offset;
+                offset += count;
+            }
+            for (unsigned int i = 0; i < order.size(); i++)
+                scratch[counts[(keys[order[i]] >> shift) & 0xFF]++] = order[i];
+            order.swap(scratch);
+        }
+    }
+
+    // counts the binds the packets would have needed in push order.
+    void countUnsorted()
+    {
+        for (unsigned int i = 0; i < packets.size(); i++)
+        {
+            if (i == 0 || packets[i].Program != packets[i - 1].Program)
+                stats.UnsortedProgramBinds++;
+            if (i == 0 || !sameMaterial(packets[i].Material, packets[i - 1].Material))
+                stats.UnsortedMaterialBinds++;
+            if (i == 0 || packets[i].VAO != packets[i - 1].VAO)
+                stats.UnsortedVAOBinds++;
+        }
+    }
+};
+#endif
@@ -0,0 +1,723 @@
+#ifndef SCENE_BVH_H
+#define SCENE_BVH_H
+
+#include <glm/glm.hpp>
+
+#include <learnopengl/frustum_culling.h>
+#include <learnopengl/cpu_profiler.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <limits>
+#include <vector>
+
+// Spatial index over the world bounds of scene instances: a bounding volume hierarchy built with the surface
+// area heuristic (binned, 16 bins per axis), answering frustum, ray and sphere queries in O(log n) per hit.
+//
+// Moving instances only refits the nodes above them (Update() + Refit()). Refitting keeps the tree valid but
+// its boxes grow and overlap as things move, so Refit() tracks the SAH cost of the tree and when it gets
+// RebuildThreshold times worse than right after the last build, a new tree is built on a worker thread from
+// a snapshot of the bounds and swapped in by a later Refit(). Instances inserted after the last build sit in
+// a small pending list that queries test linearly until the next rebuild picks them up.
+class SceneBVH
+{
+public:
+    struct Node
+    {
+        glm::vec3 Min;
+        uint32_t LeftOrFirst;   // internal: index of the left child (the right one follows it), leaf: first entry in Indices
+        glm::vec3 Max;
+        uint32_t Count;         // 0 for internal nodes
+    };
+
+    struct RayHit
+    {
+        uint32_t Instance;
+        float Distance;
+    };
+
+    // SAH cost growth (relative to the cost right after the build) that triggers a background rebuild.
+    float RebuildThreshold;
+    // pending inserts, as a fraction of the indexed instances, that trigger a background rebuild.
+    float PendingThreshold;
+
+    SceneBVH() : RebuildThreshold(1.5f), PendingThreshold(0.05f), builtCost(0.0f), cost(0.0f), treeSize(0), rebuilding(false), snapshotSize(0)
+    {
+    }
+
+    ~SceneBVH()
+    {
+        if (rebuilding)
+            job.wait();
+    }
+
+    // adds an instance with world space bounds, returns its id. The instance is queryable right away.
+    uint32_t Insert(const glm::vec3 &min, const glm::vec3 &max)
+    {
+        Instance instance;
+        instance.Min = min;
+        instance.Max = max;
+        instance.Alive = true;
+        instance.Leaf = NO_LEAF;
+        instances.push_back(instance);
+        pending.push_back((uint32_t) instances.size() - 1);
+        return (uint32_t) instances.size() - 1;
+    }
+
+    uint32_t Insert(const Bounds &bounds, const glm::mat4 &transform)
+    {
+        Bounds world = TransformBounds(bounds, transform);
+        return Insert(world.Min, world.Max);
+    }
+
+    // new world bounds for a moved instance, the tree catches up on the next Refit().
+    void Update(uint32_t id, const glm::vec3 &min, const glm::vec3 &max)
+    {
+        instances[id].Min = min;
+        instances[id].Max = max;
+        if (instances[id].Leaf != NO_LEAF)
+            dirty.push_back(id);
+    }
+
+    void Update(uint32_t id, const Bounds &bounds, const glm::mat4 &transform)
+    {
+        Bounds world = TransformBounds(bounds, transform);
+        Update(id, world.Min, world.Max);
+    }
+
+    // the id is not reused, queries stop returning it immediately.
+    void Remove(uint32_t id)
+    {
+        instances[id].Alive = false;
+        if (instances[id].Leaf != NO_LEAF)
+            dirty.push_back(id);
+    }
+
+    // synchronous build over every live instance, blocks until an ongoing background rebuild is done first.
+    void Build()
+    {
+        if (rebuilding)
+        {
+            job.wait();
+            rebuilding = false;
+        }
+        snapshotSize = (uint32_t) instances.size();
+        std::vector<Box> boxes = snapshot();
+        Tree tree = buildTree(boxes);
+        adopt(tree);
+    }
+
+    // call once per frame: refits the nodes above the instances updated since the last call, swaps in a
+    // finished background rebuild and starts a new one when the tree has degraded too much.
+    void Refit()
+    {
+        if (rebuilding && job.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+        {
+            Tree tree = job.get();
+            rebuilding = false;
+            adopt(tree);
+        }
+
+        // walking up from every moved instance touches the same upper nodes over and over, past a few
+        // percent of the tree one linear bottom up pass is cheaper
+        if (dirty.size() > nodes.size() / 32)
+            refitAll();
+        else
+        {
+            for (unsigned int i = 0; i < dirty.size(); i++)
+                refitLeaf(instances[dirty[i]].Leaf);
+        }
+        dirty.clear();
+
+        if (!rebuilding && NeedsRebuild())
+        {
+            snapshotSize = (uint32_t) instances.size();
+            rebuilding = true;
+            job = std::async(std::launch::async, &SceneBVH::buildTree, snapshot());
+        }
+    }
+
+    bool NeedsRebuild() const
+    {
+        if (nodes.empty())
+            return !pending.empty();
+        return Quality() > RebuildThreshold || pending.size() > PendingThreshold * treeSize;
+    }
+
+    // SAH cost of the tree relative to right after it was built, 1 means as good as new.
+    float Quality() const
+    {
+        if (nodes.empty() || builtCost <= 0.0f)
+            return 1.0f;
+        return (cost / area(nodes[0].Min, nodes[0].Max)) / builtCost;
+    }
+
+    bool Rebuilding() const
+    {
+        return rebuilding;
+    }
+
+    // instances whose box touches the frustum (same conservative test as FrustumCuller).
+    void QueryFrustum(const Frustum &frustum, std::vector<uint32_t> &result) const
+    {
+        result.clear();
+        if (!nodes.empty())
+        {
+            // each stack entry carries the planes its parent was not fully inside of, a node inside every
+            // plane is appended whole without any more tests.
+            struct Entry { uint32_t Node; uint32_t Planes; };
+            Entry stack[MAX_DEPTH + 2];
+            int top = 0;
+            stack[top++] = Entry{0, 0x3F};
+            while (top > 0)
+            {
+                Entry entry = stack[--top];
+                const Node &node = nodes[entry.Node];
+                if (node.Min.x > node.Max.x)
+                    continue;
+                uint32_t planes = entry.Planes;
+                if (!classify(frustum, node.Min, node.Max, planes))
+                    continue;
+                if (planes == 0)
+                {
+                    appendSubtree(entry.Node, result);
+                    continue;
+                }
+                if (node.Count > 0)
+                {
+                    for (uint32_t i = node.LeftOrFirst; i < node.LeftOrFirst + node.Count; i++)
+                    {
+                        const Instance &instance = instances[indices[i]];
+                        uint32_t instancePlanes = planes;
+                        if (instance.Alive && classify(frustum, instance.Min, instance.Max, instancePlanes))
+                            result.push_back(indices[i]);
+                    }
+                    continue;
+                }
+                stack[top++] = Entry{node.LeftOrFirst, planes};
+                stack[top++] = Entry{node.LeftOrFirst + 1, planes};
+            }
+        }
+        for (unsigned int i = 0; i < pending.size(); i++)
+        {
+            const Instance &instance = instances[pending[i]];
+            uint32_t planes = 0x3F;
+            if (instance.Alive && classify(frustum, instance.Min, instance.Max, planes))
+                result.push_back(pending[i]);
+        }
+    }
+
+    // closest instance box hit by the ray within maxDistance. direction doesn't need to be normalized,
+    // the distance is measured in units of direction.
+    bool QueryRay(const glm::vec3 &origin, const glm::vec3 &direction, float maxDistance, RayHit &hit) const
+    {
+        glm::vec3 inverse = 1.0f / direction;
+        hit.Instance = NO_LEAF;
+        hit.Distance = maxDistance;
+        if (!nodes.empty())
+        {
+            uint32_t stack[MAX_DEPTH + 2];
+            int top = 0;
+            stack[top++] = 0;
+            while (top > 0)
+            {
+                const Node &node = nodes[stack[--top]];
+                float entry;
+                if (!slab(origin, inverse, node.Min, node.Max, hit.Distance, entry))
+                    continue;
+                if (node.Count > 0)
+                {
+                    for (uint32_t i = node.LeftOrFirst; i < node.LeftOrFirst + node.Count; i++)
+                    {
+                        const Instance &instance = instances[indices[i]];
+                        if (instance.Alive && slab(origin, inverse, instance.Min, instance.Max, hit.Distance, entry) && entry < hit.Distance)
+                        {
+                            hit.Instance = indices[i];
+                            hit.Distance = entry;
+                        }
+                    }
+                    continue;
+                }
+                // push the far child first so the near one is visited first and shrinks hit.Distance early
+                uint32_t left = node.LeftOrFirst, right = node.LeftOrFirst + 1;
+                float leftEntry = 0.0f, rightEntry = 0.0f;
+                bool hitLeft = slab(origin, inverse, nodes[left].Min, nodes[left].Max, hit.Distance, leftEntry);
+                bool hitRight = slab(origin, inverse, nodes[right].Min, nodes[right].Max, hit.Distance, rightEntry);
+                if (hitLeft && hitRight)
+                {
+                    if (leftEntry < rightEntry)
+                    {
+                        stack[top++] = right;
+                        stack[top++] = left;
+                    }
+                    else
+                    {
+                        stack[top++] = left;
+                        stack[top++] = right;
+                    }
+                }
+                else if (hitLeft)
+                    stack[top++] = left;
+                else if (hitRight)
+                    stack[top++] = right;
+            }
+        }
+        for (unsigned int i = 0; i < pending.size(); i++)
+        {
+            const Instance &instance = instances[pending[i]];
+            float entry;
+            if (instance.Alive && slab(origin, inverse, instance.Min, instance.Max, hit.Distance, entry) && entry < hit.Distance)
+            {
+                hit.Instance = pending[i];
+                hit.Distance = entry;
+            }
+        }
+        return hit.Instance != NO_LEAF;
+    }
+
+    // instances whose box overlaps the sphere.
+    void QuerySphere(const glm::vec3 &center, float radius, std::vector<uint32_t> &result) const
+    {
+        result.clear();
+        float radius2 = radius * radius;
+        if (!nodes.empty())
+        {
+            uint32_t stack[MAX_DEPTH + 2];
+            int top = 0;
+            stack[top++] = 0;
+            while (top > 0)
+            {
+                const Node &node = nodes[stack[--top]];
+                if (distance2(center, node.Min, node.Max) > radius2)
+                    continue;
+                if (node.Count > 0)
+                {
+                    for (uint32_t i = node.LeftOrFirst; i < node.LeftOrFirst + node.Count; i++)
+                    {
+                        const Instance &instance = instances[indices[i]];
+                        if (instance.Alive && distance2(center, instance.Min, instance.Max) <= radius2)
+                            result.push_back(indices[i]);
+                    }
+                    continue;
+                }
+                stack[top++] = node.LeftOrFirst;
+                stack[top++] = node.LeftOrFirst + 1;
+            }
+        }
+        for (unsigned int i = 0; i < pending.size(); i++)
+        {
+            const Instance &instance = instances[pending[i]];
+            if (instance.Alive && distance2(center, instance.Min, instance.Max) <= radius2)
+                result.push_back(pending[i]);
+        }
+    }
+
+    const std::vector<Node> &Nodes() const
+    {
+        return nodes;
+    }
+
+    unsigned int Size() const
+    {
+        return (unsigned int) instances.size();
+    }
+
+    unsigned int PendingCount() const
+    {
+        return (unsigned int) pending.size();
+    }
+
+    // same test the frustum query applies to every instance, exposed to check the query against a linear scan.
+    static bool IntersectsFrustum(const Frustum &frustum, const glm::vec3 &min, const glm::vec3 &max)
+    {
+        uint32_t planes = 0x3F;
+        return classify(frustum, min, max, planes);
+    }
+
+    // distance along the ray to the box, false if it misses it within maxDistance.
+    static bool IntersectsRay(const glm::vec3 &origin, const glm::vec3 &direction, const glm::vec3 &min, const glm::vec3 &max,
+                              float maxDistance, float &distance)
+    {
+        return slab(origin, 1.0f / direction, min, max, maxDistance, distance);
+    }
+
+    static bool IntersectsSphere(const glm::vec3 &center, float radius, const glm::vec3 &min, const glm::vec3 &max)
+    {
+        return distance2(center, min, max) <= radius * radius;
+    }
+
+private:
+    // enums rather than static const members, they're bound to references (push_back) and would need a definition
+    enum : uint32_t { NO_LEAF = 0xFFFFFFFFu };
+    enum { MAX_LEAF_SIZE = 4, BINS = 16 };
+    // deeper nodes become leaves whatever their size, so traversal stacks can live on the stack
+    enum { MAX_DEPTH = 96 };
+
+    struct Instance
+    {
+        glm::vec3 Min;
+        glm::vec3 Max;
+        bool Alive;
+        uint32_t Leaf;
+    };
+
+    struct Box
+    {
+        glm::vec3 Min;
+        glm::vec3 Max;
+        uint32_t Id;
+    };
+
+    struct Tree
+    {
+        std::vector<Node> Nodes;
+        std::vector<uint32_t> Parents;
+        std::vector<uint32_t> Indices;
+    };
+
+    std::vector<Instance> instances;
+    std::vector<Node> nodes;
+    std::vector<uint32_t> parents;
+    std::vector<uint32_t> indices;
+    std::vector<uint32_t> pending;
+    std::vector<uint32_t> dirty;
+    float builtCost;    // cost / root area right after the build
+    float cost;         // sum of node areas weighted by SAH (1 per internal node, instance count per leaf)
+    uint32_t treeSize;
+    bool rebuilding;
+    uint32_t snapshotSize;
+    std::future<Tree> job;
+
+    static float area(const glm::vec3 &min, const glm::vec3 &max)
+    {
+        glm::vec3 size = glm::max(max - min, glm::vec3(0.0f));
+        return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+    }
+
+    static float weight(const Node &node)
+    {
+        return node.Count > 0 ? (float) node.Count : 1.0f;
+    }
+
+    // live instances at the time of the call, copied so the rebuild thread never reads the instance list.
+    std::vector<Box> snapshot() const
+    {
+        std::vector<Box> boxes;
+        boxes.reserve(instances.size());
+        for (uint32_t i = 0; i < instances.size(); i++)
+        {
+            if (!instances[i].Alive)
+                continue;
+            Box box;
+            box.Min = instances[i].Min;
+            box.Max = instances[i].Max;
+            box.Id = i;
+            boxes.push_back(box);
+        }
+        return boxes;
+    }
+
+    // binned SAH top-down build. Children are always allocated next to each other, after their parent.
+    static Tree buildTree(std::vector<Box> boxes)
+    {
+        CPU_PROFILE_ZONE("SceneBVH::buildTree");
+        Tree tree;
+        if (boxes.empty())
+            return tree;
+        tree.Nodes.reserve(2 * boxes.size() / MAX_LEAF_SIZE + 1);
+        tree.Parents.reserve(tree.Nodes.capacity());
+        std::vector<glm::vec3> centroids(boxes.size());
+        for (unsigned int i = 0; i < boxes.size(); i++)
+            centroids[i] = (boxes[i].Min + boxes[i].Max) * 0.5f;
+
+        Node root;
+        root.LeftOrFirst = 0;
+        root.Count = (uint32_t) boxes.size();
+        tree.Nodes.push_back(root);
+        tree.Parents.push_back(NO_LEAF);
+
+        std::vector<std::pair<uint32_t, int> > stack;
+        stack.push_back(std::make_pair(0u, 0));
+        while (!stack.empty())
+        {
+            uint32_t index = stack.back().first;
+            int depth = stack.back().second;
+            stack.pop_back();
+            uint32_t first = tree.Nodes[index].LeftOrFirst, count = tree.Nodes[index].Count;
+
+            glm::vec3 min(std::numeric_limits<float>::max()), max(-std::numeric_limits<float>::max());
+            glm::vec3 centroidMin = min, centroidMax = max;
+            for (uint32_t i = first; i < first + count; i++)
+            {
+                min = glm::min(min, boxes[i].Min);
+                max = glm::max(max, boxes[i].Max);
+                centroidMin = glm::min(centroidMin, centroids[i]);
+                centroidMax = glm::max(centroidMax, centroids[i]);
+            }
+            tree.Nodes[index].Min = min;
+            tree.Nodes[index].Max = max;
+            if (count <= MAX_LEAF_SIZE || depth >= MAX_DEPTH)
+                continue;
+
+            int axis;
+            uint32_t split = bestSplit(boxes, centroids, first, count, centroidMin, centroidMax, area(min, max), axis);
+            if (split == 0)
+                continue;
+
+            // partition by bin: everything in a bin below split goes left
+            float scale = BINS / (centroidMax[axis] - centroidMin[axis]);
+            uint32_t i = first, j = first + count;
+            while (i < j)
+            {
+                int bin = glm::min(BINS - 1, (int) ((centroids[i][axis] - centroidMin[axis]) * scale));
+                if ((uint32_t) bin < split)
+                    i++;
+                else
+                {
+                    j--;
+                    std::swap(boxes[i], boxes[j]);
+                    std::swap(centroids[i], centroids[j]);
+                }
+            }
+            uint32_t leftCount = i - first;
+            if (leftCount == 0 || leftCount == count)
+                continue;
+
+            uint32_t left = (uint32_t) tree.Nodes.size();
+            Node child;
+            child.LeftOrFirst = first;
+            child.Count = leftCount;
+            tree.Nodes.push_back(child);
+            child.LeftOrFirst = first + leftCount;
+            child.Count = count - leftCount;
+            tree.Nodes.push_back(child);
+            tree.Parents.push_back(index);
+            tree.Parents.push_back(index);
+            tree.Nodes[index].LeftOrFirst = left;
+            tree.Nodes[index].Count = 0;
+            stack.push_back(std::make_pair(left, depth + 1));
+            stack.push_back(std::make_pair(left + 1, depth + 1));
+        }
+
+        tree.Indices.resize(boxes.size());
+        for (unsigned int i = 0; i < boxes.size(); i++)
+            tree.Indices[i] = boxes[i].Id;
+        return tree;
+    }
+
+    // returns the first bin of the right side of the cheapest split and its axis, 0 when keeping a leaf is
+    // cheaper (only allowed for small nodes, large ones always split).
+    static uint32_t bestSplit(const std::vector<Box> &boxes, const std::vector<glm::vec3> &centroids, uint32_t first, uint32_t count,
+                              const glm::vec3 &centroidMin, const glm::vec3 &centroidMax, float nodeArea, int &bestAxis)
+    {
+        float bestCost = std::numeric_limits<float>::max();
+        uint32_t bestSplit = 0;
+        bestAxis = 0;
+        for (int axis = 0; axis < 3; axis++)
+        {
+            float extent = centroidMax[axis] - centroidMin[axis];
+            if (extent <= 0.0f)
+                continue;
+            glm::vec3 binMin[BINS], binMax[BINS];
+            uint32_t binCount[BINS];
+            for (int b = 0; b < BINS; b++)
+            {
+                binMin[b] = glm::vec3(std::numeric_limits<float>::max());
+                binMax[b] = glm::vec3(-std::numeric_limits<float>::max());
+                binCount[b] = 0;
+            }
+            float scale = BINS / extent;
+            for (uint32_t i = first; i < first + count; i++)
+            {
+                int bin = glm::min(BINS - 1, (int) ((centroids[i][axis] - centroidMin[axis]) * scale));
+                binMin[bin] = glm::min(binMin[bin], boxes[i].Min);
+                binMax[bin] = glm::max(binMax[bin], boxes[i].Max);
+                binCount[bin]++;
+            }
+
+            // sweep from the right to get the area/count of every right side, then from the left
+            float rightArea[BINS];
+            uint32_t rightCount[BINS];
+            glm::vec3 min(std::numeric_limits<float>::max()), max(-std::numeric_limits<float>::max());
+            uint32_t total = 0;
+            for (int b = BINS - 1; b > 0; b--)
+            {
+                min = glm::min(min, binMin[b]);
+                max = glm::max(max, binMax[b]);
+                total += binCount[b];
+                rightArea[b] = area(min, max);
+                rightCount[b] = total;
+            }
+            min = glm::vec3(std::numeric_limits<float>::max());
+            max = glm::vec3(-std::numeric_limits<float>::max());
+            total = 0;
+            for (int b = 1; b < BINS; b++)
+            {
+                min = glm::min(min, binMin[b - 1]);
+                max = glm::max(max, binMax[b - 1]);
+                total += binCount[b - 1];
+                if (total == 0 || rightCount[b] == 0)
+                    continue;
+                float splitCost = area(min, max) * total + rightArea[b] * rightCount[b];
+                if (splitCost < bestCost)
+                {
+                    bestCost = splitCost;
+                    bestSplit = (uint32_t) b;
+                    bestAxis = axis;
+                }
+            }
+        }
+        // traversal cost of 1 against the cost of testing every instance of the node
+        if (bestSplit != 0 && count <= 4 * MAX_LEAF_SIZE && 1.0f + bestCost / nodeArea >= (float) count)
+            return 0;
+        return bestSplit;
+    }
+
+    void adopt(Tree &tree)
+    {
+        nodes.swap(tree.Nodes);
+        parents.swap(tree.Parents);
+        indices.swap(tree.Indices);
+        treeSize = (uint32_t) indices.size();
+
+        for (unsigned int i = 0; i < instances.size(); i++)
+            instances[i].Leaf = NO_LEAF;
+        for (uint32_t n = 0; n < nodes.size(); n++)
+        {
+            for (uint32_t i = nodes[n].LeftOrFirst; nodes[n].Count > 0 && i < nodes[n].LeftOrFirst + nodes[n].Count; i++)
+                instances[indices[i]].Leaf = n;
+        }
+
+        // the snapshot may be stale when the tree was built in the background: refit everything and keep
+        // instances inserted since then pending.
+        refitAll();
+        builtCost = nodes.empty() ? 0.0f : cost / area(nodes[0].Min, nodes[0].Max);
+        dirty.clear();
+
+        std::vector<uint32_t> stillPending;
+        for (unsigned int i = 0; i < pending.size(); i++)
+        {
+            if (pending[i] >= snapshotSize)
+                stillPending.push_back(pending[i]);
+        }
+        pending.swap(stillPending);
+    }
+
+    // recomputes the box of one node from its children or instances. Dead instances don't count,
+    // a node left without any gets an inverted (empty) box.
+    void fitNode(uint32_t n)
+    {
+        Node &node = nodes[n];
+        glm::vec3 min(std::numeric_limits<float>::max()), max(-std::numeric_limits<float>::max());
+        if (node.Count > 0)
+        {
+            for (uint32_t i = node.LeftOrFirst; i < node.LeftOrFirst + node.Count; i++)
+            {
+                const Instance &instance = instances[indices[i]];
+                if (!instance.Alive)
+                    continue;
+                min = glm::min(min, instance.Min);
+                max = glm::max(max, instance.Max);
+            }
+        }
+        else
+        {
+            min = glm::min(nodes[node.LeftOrFirst].Min, nodes[node.LeftOrFirst + 1].Min);
+            max = glm::max(nodes[node.LeftOrFirst].Max, nodes[node.LeftOrFirst + 1].Max);
+        }
+        node.Min = min;
+        node.Max = max;
+    }
+
+    // children always come after their parent, so one reverse pass refits the whole tree.
+    void refitAll()
+    {
+        cost = 0.0f;
+        for (uint32_t n = (uint32_t) nodes.size(); n-- > 0;)
+        {
+            fitNode(n);
+            cost += area(nodes[n].Min, nodes[n].Max) * weight(nodes[n]);
+        }
+    }
+
+    // walks up from a leaf, stops as soon as a node box doesn't change.
+    void refitLeaf(uint32_t n)
+    {
+        while (n != NO_LEAF)
+        {
+            glm::vec3 oldMin = nodes[n].Min, oldMax = nodes[n].Max;
+            float oldArea = area(oldMin, oldMax);
+            fitNode(n);
+            cost += (area(nodes[n].Min, nodes[n].Max) - oldArea) * weight(nodes[n]);
+            if (nodes[n].Min == oldMin && nodes[n].Max == oldMax)
+                break;
+            n = parents[n];
+        }
+    }
+
+    void appendSubtree(uint32_t root, std::vector<uint32_t> &result) const
+    {
+        uint32_t stack[MAX_DEPTH + 2];
+        int top = 0;
+        stack[top++] = root;
+        while (top > 0)
+        {
+            const Node &node = nodes[stack[--top]];
+            if (node.Count == 0)
+            {
+                stack[top++] = node.LeftOrFirst;
+                stack[top++] = node.LeftOrFirst + 1;
+                continue;
+            }
+            for (uint32_t i = node.LeftOrFirst; i < node.LeftOrFirst + node.Count; i++)
+            {
+                if (instances[indices[i]].Alive)
+                    result.push_back(indices[i]);
+            }
+        }
+    }
+
+    // false if the box is outside one of the planes set in planes. Planes the box is completely inside of
+    // are cleared from the mask, the children of the box don't need to test them again.
+    static bool classify(const Frustum &frustum, const glm::vec3 &min, const glm::vec3 &max, uint32_t &planes)
+    {
+        for (int p = 0; p < 6; p++)
+        {
+            if ((planes & (1u << p)) == 0)
+                continue;
+            const glm::vec4 &plane = frustum.Planes[p];
+            // the corner furthest along the plane normal decides outside, the nearest one decides inside
+            glm::vec3 positive(plane.x >= 0.0f ? max.x : min.x, plane.y >= 0.0f ? max.y : min.y, plane.z >= 0.0f ? max.z : min.z);
+            glm::vec3 negative(plane.x >= 0.0f ? min.x : max.x, plane.y >= 0.0f ? min.y : max.y, plane.z >= 0.0f ? min.z : max.z);
+            if (glm::dot(glm::vec3(plane), positive) + plane.w < 0.0f)
+                return false;
+            if (glm::dot(glm::vec3(plane), negative) + plane.w >= 0.0f)
+                planes &= ~(1u << p);
+        }
+        return true;
+    }
+
+    static bool slab(const glm::vec3 &origin, const glm::vec3 &inverse, const glm::vec3 &min, const glm::vec3 &max,
+                     float maxDistance, float &entry)
+    {
+        if (min.x > max.x)
+            return false;
+        glm::vec3 t0 = (min - origin) * inverse;
+        glm::vec3 t1 = (max - origin) * inverse;
+        glm::vec3 tNear = glm::min(t0, t1), tFar = glm::max(t0, t1);
+        entry = glm::max(glm::max(tNear.x, tNear.y), glm::max(tNear.z, 0.0f));
+        float exit = glm::min(glm::min(tFar.x, tFar.y), glm::min(tFar.z, maxDistance));
+        return entry <= exit;
+    }
+
+    static float distance2(const glm::vec3 &point, const glm::vec3 &min, const glm::vec3 &max)
+    {
+        if (min.x > max.x)
+            return std::numeric_limits<float>::max();
+        glm::vec3 offset = point - glm::clamp(point, min, max);
+        return glm::dot(offset, offset);
+    }
+};
+#endif
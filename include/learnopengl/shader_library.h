@@ -0,0 +1,270 @@
+#ifndef SHADER_LIBRARY_H
+#define SHADER_LIBRARY_H
+
+#include <glad/glad.h>
+
+#include <learnopengl/shader.h>
+#include <learnopengl/cpu_profiler.h>
+#include <learnopengl/program_samplers.h>
+
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <vector>
+#include <cstring>
+
+// GL_KHR_parallel_shader_compile is not part of our glad profile, so declare what we need here.
+#ifndef GL_MAX_SHADER_COMPILER_THREADS_KHR
+#define GL_MAX_SHADER_COMPILER_THREADS_KHR 0x91B0
+#endif
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+// Compiles many shader programs in two steps: Submit() issues every glCompileShader/glLinkProgram call
+// up front without asking for any status, Collect() reads the results later. Because nothing is queried
+// in between, the driver is free to compile on its own threads while the app does other work (decoding
+// textures, loading models...). When GL_KHR_parallel_shader_compile is available IsReady()/Poll() can be
+// used to check for completion without blocking.
+class ShaderLibrary
+{
+public:
+    typedef void (APIENTRYP MaxShaderCompilerThreadsProc)(GLuint count);
+
+    struct Program
+    {
+        std::string Name;
+        unsigned int ID;
+        unsigned int Stages[3];
+        const char* StageNames[3];
+        int StageCount;
+        bool Collected;
+        bool Linked;
+    };
+
+    // loader is optional, it is only used to fetch glMaxShaderCompilerThreadsKHR.
+    explicit ShaderLibrary(GLADloadproc loader = nullptr) : parallelCompile(false)
+    {
+        parallelCompile = hasExtension("GL_KHR_parallel_shader_compile");
+        if (parallelCompile && loader != nullptr)
+        {
+            MaxShaderCompilerThreadsProc maxThreads = (MaxShaderCompilerThreadsProc) loader("glMaxShaderCompilerThreadsKHR");
+            // 0xFFFFFFFF lets the driver pick as many threads as it likes.
+            if (maxThreads != nullptr)
+                maxThreads(0xFFFFFFFFu);
+        }
+    }
+
+    // true if the driver reports GL_KHR_parallel_shader_compile (non-blocking completion queries).
+    bool SupportsParallelCompile() const
+    {
+        return parallelCompile;
+    }
+
+    // reads the stage files and submits the program, returns a handle to pass to IsReady()/Get().
+    int Submit(const std::string &name, const char* vertexPath, const char* fragmentPath, const char* geometryPath = nullptr)
+    {
+        std::string vertexCode = readFile(vertexPath);
+        std::string fragmentCode = readFile(fragmentPath);
+        std::string geometryCode = geometryPath != nullptr ? readFile(geometryPath) : std::string();
+        return SubmitSource(name, vertexCode.c_str(), fragmentCode.c_str(), geometryPath != nullptr ? geometryCode.c_str() : nullptr);
+    }
+
+    // same as Submit() but takes the GLSL code directly.
+    int SubmitSource(const std::string &name, const char* vertexCode, const char* fragmentCode, const char* geometryCode = nullptr)
+    {
+        Program program;
+        program.Name = name;
+        program.StageCount = 0;
+        program.Collected = false;
+        program.Linked = false;
+        program.ID = glCreateProgram();
+
+        addStage(program, GL_VERTEX_SHADER, "VERTEX", vertexCode);
+        addStage(program, GL_FRAGMENT_SHADER, "FRAGMENT", fragmentCode);
+        if (geometryCode != nullptr)
+            addStage(program, GL_GEOMETRY_SHADER, "GEOMETRY", geometryCode);
+
+        // no status query here, that would force the driver to finish the compile right away.
+        glLinkProgram(program.ID);
+
+        programs.push_back(program);
+        return (int) programs.size() - 1;
+    }
+
+    // non-blocking check, always true once collected. Without the extension we can't ask without
+    // stalling, so we report true and let Collect() do the wait.
+    bool IsReady(int handle) const
+    {
+        const Program &program = programs[handle];
+        if (program.Collected || !parallelCompile)
+            return true;
+        GLint done = GL_FALSE;
+        glGetProgramiv(program.ID, GL_COMPLETION_STATUS_KHR, &done);
+        return done == GL_TRUE;
+    }
+
+    // collects every program that has finished compiling, returns true when nothing is pending anymore.
+    bool Poll()
+    {
+        bool allDone = true;
+        for (unsigned int i = 0; i < programs.size(); i++)
+        {
+            if (programs[i].Collected)
+                continue;
+            if (IsReady(i))
+                collect(programs[i]);
+            else
+                allDone = false;
+        }
+        return allDone;
+    }
+
+    // waits for every pending program and checks the link results, returns false if any of them failed.
+    bool Collect()
+    {
+        CPU_PROFILE_ZONE("ShaderLibrary::Collect");
+        bool success = true;
+        for (unsigned int i = 0; i < programs.size(); i++)
+        {
+            if (!programs[i].Collected)
+                collect(programs[i]);
+            success = success && programs[i].Linked;
+        }
+        return success;
+    }
+
+    // returns the program as a Shader, waiting for it if it hasn't been collected yet.
+    Shader Get(int handle)
+    {
+        if (!programs[handle].Collected)
+            collect(programs[handle]);
+        return Shader(programs[handle].ID);
+    }
+
+    // whether the program linked, waiting for it if it hasn't been collected yet. A stage file that couldn't
+    // be read leaves its stage empty, so the program fails to link and this is false too.
+    bool IsLinked(int handle)
+    {
+        if (!programs[handle].Collected)
+            collect(programs[handle]);
+        return programs[handle].Linked;
+    }
+
+    Shader Get(const std::string &name)
+    {
+        for (unsigned int i = 0; i < programs.size(); i++)
+        {
+            if (programs[i].Name == name)
+                return Get(i);
+        }
+        std::cout << "ERROR::SHADER_LIBRARY::PROGRAM_NOT_FOUND: " << name << std::endl;
+        return Shader(0);
+    }
+
+    const std::vector<Program> &Programs() const
+    {
+        return programs;
+    }
+
+    // deletes every program of the library.
+    void Clear()
+    {
+        for (unsigned int i = 0; i < programs.size(); i++)
+        {
+            if (!programs[i].Collected)
+                deleteStages(programs[i]);
+            glDeleteProgram(programs[i].ID);
+            ProgramSamplers::Invalidate(programs[i].ID);
+            MemoryTracker::Instance().Release(MemoryTracker::SHADERS, programs[i].ID);
+        }
+        programs.clear();
+    }
+
+private:
+    std::vector<Program> programs;
+    bool parallelCompile;
+
+    static bool hasExtension(const char* name)
+    {
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for (GLint i = 0; i < count; i++)
+        {
+            const char* extension = (const char*) glGetStringi(GL_EXTENSIONS, i);
+            if (extension != nullptr && std::strcmp(extension, name) == 0)
+                return true;
+        }
+        return false;
+    }
+
+    static std::string readFile(const char* path)
+    {
+        std::ifstream file;
+        file.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+        try
+        {
+            file.open(path);
+            std::stringstream stream;
+            stream << file.rdbuf();
+            file.close();
+            return stream.str();
+        }
+        catch (std::ifstream::failure &e)
+        {
+            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ: " << path << std::endl;
+        }
+        return std::string();
+    }
+
+    static void addStage(Program &program, GLenum type, const char* typeName, const char* code)
+    {
+        unsigned int stage = glCreateShader(type);
+        glShaderSource(stage, 1, &code, NULL);
+        glCompileShader(stage);
+        glAttachShader(program.ID, stage);
+        program.Stages[program.StageCount] = stage;
+        program.StageNames[program.StageCount] = typeName;
+        program.StageCount++;
+    }
+
+    static void deleteStages(Program &program)
+    {
+        for (int i = 0; i < program.StageCount; i++)
+        {
+            glDetachShader(program.ID, program.Stages[i]);
+            glDeleteShader(program.Stages[i]);
+        }
+        program.StageCount = 0;
+    }
+
+    // reads the link status (this is where we block if the driver isn't done yet). The per stage compile
+    // logs are only fetched when linking failed so the happy path costs a single query per program.
+    static void collect(Program &program)
+    {
+        GLint success;
+        GLchar infoLog[1024];
+        glGetProgramiv(program.ID, GL_LINK_STATUS, &success);
+        program.Linked = success == GL_TRUE;
+        if (!program.Linked)
+        {
+            for (int i = 0; i < program.StageCount; i++)
+            {
+                glGetShaderiv(program.Stages[i], GL_COMPILE_STATUS, &success);
+                if (!success)
+                {
+                    glGetShaderInfoLog(program.Stages[i], 1024, NULL, infoLog);
+                    std::cout << "ERROR::SHADER_COMPILATION_ERROR of type: " << program.StageNames[i] << " (" << program.Name << ")\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
+                }
+            }
+            glGetProgramInfoLog(program.ID, 1024, NULL, infoLog);
+            std::cout << "ERROR::PROGRAM_LINKING_ERROR of type: PROGRAM (" << program.Name << ")\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
+        }
+        deleteStages(program);
+        program.Collected = true;
+        if (program.Linked)
+            Shader::TrackProgramMemory(program.ID, program.Name.c_str());
+    }
+};
+#endif
@@ -0,0 +1,570 @@
+#ifndef SOFTWARE_RASTERIZER_H
+#define SOFTWARE_RASTERIZER_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+// our stb_image.h compiles its implementation on every include, so only include it if model.h didn't already
+#ifndef STBI_INCLUDE_STB_IMAGE_H
+#include <stb_image.h>
+#endif
+
+#include <learnopengl/camera.h>
+#include <learnopengl/mesh.h>
+#include <learnopengl/worker_pool.h>
+#include <learnopengl/cpu_profiler.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SOFTWARE_RASTERIZER_SSE
+#include <emmintrin.h>
+#endif
+
+// RGBA8 texels in CPU memory, row 0 at t = 0 like a texture uploaded with glTexImage2D.
+struct SoftwareTexture
+{
+    int Width;
+    int Height;
+    std::vector<unsigned char> Texels;
+
+    bool Load(const std::string &path)
+    {
+        int channels;
+        unsigned char* data = stbi_load(path.c_str(), &Width, &Height, &channels, 4);
+        if (data == NULL)
+        {
+            std::cout << "Texture failed to load at path: " << path << std::endl;
+            Width = Height = 0;
+            return false;
+        }
+        Texels.assign(data, data + (size_t) Width * Height * 4);
+        stbi_image_free(data);
+        return true;
+    }
+
+    // bilinear filtering, GL_REPEAT wrapping, no mipmaps.
+    glm::vec4 Sample(glm::vec2 uv) const
+    {
+        float x = uv.x * Width - 0.5f, y = uv.y * Height - 0.5f;
+        float fx = std::floor(x), fy = std::floor(y);
+        int x0 = wrap((int) fx, Width), y0 = wrap((int) fy, Height);
+        int x1 = wrap(x0 + 1, Width), y1 = wrap(y0 + 1, Height);
+        float tx = x - fx, ty = y - fy;
+        glm::vec4 top = glm::mix(texel(x0, y0), texel(x1, y0), tx);
+        glm::vec4 bottom = glm::mix(texel(x0, y1), texel(x1, y1), tx);
+        return glm::mix(top, bottom, ty);
+    }
+
+private:
+    static int wrap(int i, int size)
+    {
+        i %= size;
+        return i < 0 ? i + size : i;
+    }
+
+    glm::vec4 texel(int x, int y) const
+    {
+        const unsigned char* t = &Texels[((size_t) y * Width + x) * 4];
+        return glm::vec4(t[0], t[1], t[2], t[3]) * (1.0f / 255.0f);
+    }
+};
+
+// What a draw is shaded with. Without a diffuse texture Color is used, without a specular one Specular.
+struct SoftwareMaterial
+{
+    const SoftwareTexture* Diffuse;
+    const SoftwareTexture* SpecularMap;
+    glm::vec3 Color;
+    float Specular;
+    float Shininess;
+};
+
+// Counters of the last frame.
+struct SoftwareRasterStats
+{
+    unsigned int Triangles;     // set up after clipping and culling
+    unsigned int Clipped;       // triangles crossing the near plane, split before setup
+    unsigned int Binned;        // triangle/tile pairs rasterized
+    unsigned int Shaded;        // pixels that passed the depth test
+};
+
+// CPU render backend for machines without a GPU: draws the same vertex/index data as Mesh with a textured
+// Phong model (one directional light, bilinear diffuse and specular maps) into an RGBA8 color and a float depth
+// buffer, for reference images and previews on headless servers.
+//
+// Draw() runs the vertex stage on the calling thread, clips against the near plane, sets up the edge functions
+// E(x, y) = A * x + B * y + C of every triangle and bins it into TILE_WIDTH x TILE_HEIGHT tiles. Render() lets
+// the workers take one tile at a time: the coverage and depth test are evaluated 4 pixels per SSE instruction
+// (see OcclusionCuller), covered pixels get perspective correct attributes and are shaded. Triangles keep their
+// submission order within a tile, so the image doesn't depend on the number of workers.
+//
+// Usage per frame: BeginFrame(clearColor), SetCamera(), Draw() for every mesh, Render(), then Color()/WritePPM().
+class SoftwareRasterizer
+{
+public:
+    static const int TILE_WIDTH = 64;
+    static const int TILE_HEIGHT = 32;
+
+    // directional light, pointing from the light into the scene
+    glm::vec3 LightDirection;
+    glm::vec3 LightColor;
+    float Ambient;
+    // skips triangles facing away from the camera (GL_CULL_FACE with counter clockwise front faces)
+    bool CullBackFaces;
+
+    // workers = 0 uses every hardware thread.
+    SoftwareRasterizer(int width, int height, unsigned int workers = 0) : LightDirection(-0.2f, -1.0f, -0.3f), LightColor(1.0f),
+        Ambient(0.1f), CullBackFaces(false), pool(workers), view(1.0f), projection(1.0f), viewPosition(0.0f), clearColor(0), nextTile(0)
+    {
+        this->width = width;
+        this->height = height;
+        // the buffers are rounded up to whole tiles, a tile row is 256 bytes of color
+        tilesX = (width + TILE_WIDTH - 1) / TILE_WIDTH;
+        tilesY = (height + TILE_HEIGHT - 1) / TILE_HEIGHT;
+        stride = tilesX * TILE_WIDTH;
+        color.assign((size_t) stride * tilesY * TILE_HEIGHT, 0);
+        depth.assign(color.size(), 1.0f);
+        bins.resize(tilesX * tilesY);
+        std::memset(&stats, 0, sizeof(stats));
+    }
+
+    void SetCamera(const glm::mat4 &view, const glm::mat4 &projection)
+    {
+        this->view = view;
+        this->projection = projection;
+        viewPosition = glm::vec3(glm::inverse(view)[3]);
+    }
+
+    // same projection as the samples: the camera zoom as vertical field of view, near 0.1, far 100.
+    void SetCamera(Camera &camera)
+    {
+        SetCamera(camera.GetViewMatrix(), glm::perspective(glm::radians(camera.Zoom), (float) width / (float) height, 0.1f, 100.0f));
+    }
+
+    // drops the triangles of the last frame, the tiles are cleared to clearColor when they are rendered.
+    void BeginFrame(const glm::vec4 &clearColor)
+    {
+        this->clearColor = pack(clearColor);
+        triangles.clear();
+        materials.clear();
+        for (unsigned int i = 0; i < bins.size(); i++)
+            bins[i].clear();
+        std::memset(&stats, 0, sizeof(stats));
+    }
+
+    // transforms, clips and bins one mesh. The material is copied, its textures have to stay alive until Render().
+    void Draw(const std::vector<Vertex> &vertices, const std::vector<unsigned int> &indices, const glm::mat4 &model, const SoftwareMaterial &material)
+    {
+        CPU_PROFILE_ZONE("SoftwareRasterizer::Draw");
+        glm::mat4 transform = projection * view * model;
+        glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(model)));
+        transformed.resize(vertices.size());
+        for (unsigned int i = 0; i < vertices.size(); i++)
+        {
+            ClipVertex &v = transformed[i];
+            v.Clip = transform * glm::vec4(vertices[i].Position, 1.0f);
+            v.World = glm::vec3(model * glm::vec4(vertices[i].Position, 1.0f));
+            v.Normal = normalMatrix * vertices[i].Normal;
+            v.TexCoords = vertices[i].TexCoords;
+        }
+
+        uint32_t materialIndex = (uint32_t) materials.size();
+        materials.push_back(material);
+        for (unsigned int i = 0; i + 2 < indices.size(); i += 3)
+            clipTriangle(transformed[indices[i]], transformed[indices[i + 1]], transformed[indices[i + 2]], materialIndex);
+    }
+
+    // a mesh with its first diffuse and specular texture, loaded from directory (Model::directory) on first use.
+    // Needs the full vertices, the mesh must have been created with Mesh::KEEP_ALL.
+    void Draw(const Mesh &mesh, const glm::mat4 &model, const std::string &directory)
+    {
+        if (mesh.vertices.empty() && mesh.indexCount > 0)
+        {
+            std::cout << "ERROR::SOFTWARE_RASTERIZER::MESH_CPU_DATA_RELEASED" << std::endl;
+            return;
+        }
+        SoftwareMaterial material = {nullptr, nullptr, glm::vec3(1.0f), 0.5f, 32.0f};
+        for (unsigned int i = 0; i < mesh.textures.size(); i++)
+        {
+            if (mesh.textures[i].type == "texture_diffuse" && material.Diffuse == nullptr)
+                material.Diffuse = LoadTexture(directory + '/' + mesh.textures[i].path);
+            else if (mesh.textures[i].type == "texture_specular" && material.SpecularMap == nullptr)
+                material.SpecularMap = LoadTexture(directory + '/' + mesh.textures[i].path);
+        }
+        Draw(mesh.vertices, mesh.indices, model, material);
+    }
+
+    // loads path once and keeps it for the lifetime of the rasterizer, null if it failed to load.
+    const SoftwareTexture* LoadTexture(const std::string &path)
+    {
+        std::map<std::string, SoftwareTexture>::iterator it = textures.find(path);
+        if (it == textures.end())
+        {
+            it = textures.insert(std::make_pair(path, SoftwareTexture())).first;
+            it->second.Load(path);
+        }
+        return it->second.Texels.empty() ? nullptr : &it->second;
+    }
+
+    // rasterizes and shades every tile on the workers.
+    void Render()
+    {
+        CPU_PROFILE_ZONE("SoftwareRasterizer::Render");
+        nextTile = 0;
+        std::atomic<unsigned int> shaded(0);
+        pool.ParallelFor(pool.Workers(), [this, &shaded](unsigned int, unsigned int, unsigned int) {
+            CPU_PROFILE_ZONE("SoftwareRasterizer::rasterizeTiles");
+            int count = (int) bins.size();
+            int tile;
+            unsigned int pixels = 0;
+            while ((tile = nextTile.fetch_add(1)) < count)
+                pixels += rasterizeTile(tile);
+            shaded += pixels;
+        });
+        stats.Shaded = shaded;
+        for (unsigned int i = 0; i < bins.size(); i++)
+            stats.Binned += (unsigned int) bins[i].size();
+    }
+
+    // RGBA8 (red in the lowest byte), Stride() pixels per row, bottom row first like glReadPixels.
+    const std::vector<uint32_t> &Color() const
+    {
+        return color;
+    }
+
+    const std::vector<float> &Depth() const
+    {
+        return depth;
+    }
+
+    int Width() const
+    {
+        return width;
+    }
+
+    int Height() const
+    {
+        return height;
+    }
+
+    int Stride() const
+    {
+        return stride;
+    }
+
+    unsigned int Workers() const
+    {
+        return pool.Workers();
+    }
+
+    const SoftwareRasterStats &Stats() const
+    {
+        return stats;
+    }
+
+    // binary PPM, top row first.
+    bool WritePPM(const char* path) const
+    {
+        FILE* file = std::fopen(path, "wb");
+        if (file == NULL)
+        {
+            std::cout << "ERROR::SOFTWARE_RASTERIZER::FAILED_TO_WRITE " << path << std::endl;
+            return false;
+        }
+        std::fprintf(file, "P6\n%d %d\n255\n", width, height);
+        std::vector<unsigned char> row((size_t) width * 3);
+        for (int y = height - 1; y >= 0; y--)
+        {
+            for (int x = 0; x < width; x++)
+            {
+                uint32_t pixel = color[(size_t) y * stride + x];
+                row[x * 3 + 0] = (unsigned char) (pixel & 0xFF);
+                row[x * 3 + 1] = (unsigned char) ((pixel >> 8) & 0xFF);
+                row[x * 3 + 2] = (unsigned char) ((pixel >> 16) & 0xFF);
+            }
+            std::fwrite(&row[0], 1, row.size(), file);
+        }
+        std::fclose(file);
+        return true;
+    }
+
+private:
+    struct ClipVertex
+    {
+        glm::vec4 Clip;
+        glm::vec3 World;
+        glm::vec3 Normal;
+        glm::vec2 TexCoords;
+    };
+
+    // edge functions (positive inside), the depth plane and the vertex attributes divided by w, so they
+    // interpolate linearly in screen space. Barycentric i is E[(i + 1) % 3] / Area.
+    struct Triangle
+    {
+        float A[3], B[3], C[3];
+        float InverseArea;
+        float ZX, ZY, Z0;
+        float MinZ, MaxZ;
+        int MinX, MinY, MaxX, MaxY;
+        float InverseW[3];
+        glm::vec3 World[3];
+        glm::vec3 Normal[3];
+        glm::vec2 TexCoords[3];
+        uint32_t Material;
+    };
+
+    int width, height, stride;
+    int tilesX, tilesY;
+    WorkerPool pool;
+    glm::mat4 view, projection;
+    glm::vec3 viewPosition;
+    uint32_t clearColor;
+    std::vector<uint32_t> color;
+    std::vector<float> depth;
+    std::vector<Triangle> triangles;
+    std::vector<SoftwareMaterial> materials;
+    std::vector<std::vector<uint32_t> > bins;
+    std::vector<ClipVertex> transformed;
+    std::map<std::string, SoftwareTexture> textures;
+    std::atomic<int> nextTile;
+    SoftwareRasterStats stats;
+
+    static uint32_t pack(glm::vec4 value)
+    {
+        value = glm::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f;
+        return (uint32_t) value.r | ((uint32_t) value.g << 8) | ((uint32_t) value.b << 16) | ((uint32_t) value.a << 24);
+    }
+
+    static ClipVertex lerp(const ClipVertex &a, const ClipVertex &b, float t)
+    {
+        ClipVertex v;
+        v.Clip = glm::mix(a.Clip, b.Clip, t);
+        v.World = glm::mix(a.World, b.World, t);
+        v.Normal = glm::mix(a.Normal, b.Normal, t);
+        v.TexCoords = glm::mix(a.TexCoords, b.TexCoords, t);
+        return v;
+    }
+
+    // clips against the near plane (z = -w), the other planes are left to the bounding box and tile range.
+    void clipTriangle(const ClipVertex &v0, const ClipVertex &v1, const ClipVertex &v2, uint32_t material)
+    {
+        const ClipVertex* in[3] = {&v0, &v1, &v2};
+        float distance[3];
+        int inside = 0;
+        for (int i = 0; i < 3; i++)
+        {
+            distance[i] = in[i]->Clip.z + in[i]->Clip.w;
+            inside += distance[i] >= 0.0f ? 1 : 0;
+        }
+        if (inside == 3)
+        {
+            setupTriangle(v0, v1, v2, material);
+            return;
+        }
+        if (inside == 0)
+            return;
+
+        stats.Clipped++;
+        ClipVertex polygon[4];
+        int count = 0;
+        for (int i = 0; i < 3; i++)
+        {
+            int j = (i + 1) % 3;
+            if (distance[i] >= 0.0f)
+                polygon[count++] = *in[i];
+            if ((distance[i] >= 0.0f) != (distance[j] >= 0.0f))
+                polygon[count++] = lerp(*in[i], *in[j], distance[i] / (distance[i] - distance[j]));
+        }
+        for (int i = 1; i + 1 < count; i++)
+            setupTriangle(polygon[0], polygon[i], polygon[i + 1], material);
+    }
+
+    void setupTriangle(const ClipVertex &c0, const ClipVertex &c1, const ClipVertex &c2, uint32_t material)
+    {
+        const ClipVertex* c[3] = {&c0, &c1, &c2};
+        glm::vec3 v[3];
+        float inverseW[3];
+        for (int i = 0; i < 3; i++)
+        {
+            // a vertex exactly on the near plane of a degenerate projection, nothing sensible to draw
+            if (c[i]->Clip.w <= 0.0f)
+                return;
+            inverseW[i] = 1.0f / c[i]->Clip.w;
+            glm::vec3 ndc = glm::vec3(c[i]->Clip) * inverseW[i];
+            v[i] = glm::vec3((ndc.x * 0.5f + 0.5f) * width, (ndc.y * 0.5f + 0.5f) * height, ndc.z * 0.5f + 0.5f);
+        }
+
+        float area = (v[1].x - v[0].x) * (v[2].y - v[0].y) - (v[2].x - v[0].x) * (v[1].y - v[0].y);
+        if (area == 0.0f || (CullBackFaces && area < 0.0f))
+            return;
+        int order[3] = {0, 1, 2};
+        // clockwise on screen: swap two vertices so the edge functions are positive inside
+        if (area < 0.0f)
+        {
+            std::swap(order[1], order[2]);
+            area = -area;
+        }
+
+        Triangle t;
+        t.MinX = std::max(0, (int) std::floor(std::min(v[0].x, std::min(v[1].x, v[2].x))));
+        t.MinY = std::max(0, (int) std::floor(std::min(v[0].y, std::min(v[1].y, v[2].y))));
+        t.MaxX = std::min(width - 1, (int) std::floor(std::max(v[0].x, std::max(v[1].x, v[2].x))));
+        t.MaxY = std::min(height - 1, (int) std::floor(std::max(v[0].y, std::max(v[1].y, v[2].y))));
+        if (t.MinX > t.MaxX || t.MinY > t.MaxY)
+            return;
+
+        const glm::vec3 &p0 = v[order[0]], &p1 = v[order[1]], &p2 = v[order[2]];
+        const glm::vec3* p[3] = {&p0, &p1, &p2};
+        for (int e = 0; e < 3; e++)
+        {
+            const glm::vec3 &a = *p[e], &b = *p[(e + 1) % 3];
+            t.A[e] = a.y - b.y;
+            t.B[e] = b.x - a.x;
+            t.C[e] = a.x * b.y - a.y * b.x;
+        }
+        t.InverseArea = 1.0f / area;
+        t.ZX = ((p1.z - p0.z) * (p2.y - p0.y) - (p2.z - p0.z) * (p1.y - p0.y)) / area;
+        t.ZY = ((p2.z - p0.z) * (p1.x - p0.x) - (p1.z - p0.z) * (p2.x - p0.x)) / area;
+        t.Z0 = p0.z - t.ZX * p0.x - t.ZY * p0.y;
+        t.MinZ = std::min(p0.z, std::min(p1.z, p2.z));
+        t.MaxZ = std::max(p0.z, std::max(p1.z, p2.z));
+        for (int i = 0; i < 3; i++)
+        {
+            const ClipVertex &source = *c[order[i]];
+            float w = inverseW[order[i]];
+            t.InverseW[i] = w;
+            t.World[i] = source.World * w;
+            t.Normal[i] = source.Normal * w;
+            t.TexCoords[i] = source.TexCoords * w;
+        }
+        t.Material = material;
+
+        uint32_t index = (uint32_t) triangles.size();
+        triangles.push_back(t);
+        stats.Triangles++;
+        for (int ty = t.MinY / TILE_HEIGHT; ty <= t.MaxY / TILE_HEIGHT; ty++)
+        {
+            for (int tx = t.MinX / TILE_WIDTH; tx <= t.MaxX / TILE_WIDTH; tx++)
+                bins[ty * tilesX + tx].push_back(index);
+        }
+    }
+
+    // clears the tile and draws its bin in submission order, returns the number of shaded pixels.
+    unsigned int rasterizeTile(int tile)
+    {
+        int tileX = (tile % tilesX) * TILE_WIDTH, tileY = (tile / tilesX) * TILE_HEIGHT;
+        for (int y = tileY; y < tileY + TILE_HEIGHT; y++)
+        {
+            size_t row = (size_t) y * stride + tileX;
+            std::fill(color.begin() + row, color.begin() + row + TILE_WIDTH, clearColor);
+            std::fill(depth.begin() + row, depth.begin() + row + TILE_WIDTH, 1.0f);
+        }
+
+        unsigned int shaded = 0;
+        const std::vector<uint32_t> &bin = bins[tile];
+        for (unsigned int i = 0; i < bin.size(); i++)
+        {
+            const Triangle &t = triangles[bin[i]];
+            // x starts on a multiple of 4 so SSE loads/stores stay within the tile row
+            int x0 = std::max(t.MinX, tileX) & ~3, x1 = std::min(t.MaxX, tileX + TILE_WIDTH - 1);
+            int y0 = std::max(t.MinY, tileY), y1 = std::min(t.MaxY, tileY + TILE_HEIGHT - 1);
+            for (int y = y0; y <= y1; y++)
+                shaded += rasterizeRow(t, (size_t) y * stride, x0, x1, y);
+        }
+        return shaded;
+    }
+
+    unsigned int rasterizeRow(const Triangle &t, size_t row, int x0, int x1, int y)
+    {
+        float py = y + 0.5f;
+        float* depthRow = &depth[row];
+        unsigned int shaded = 0;
+#if defined(SOFTWARE_RASTERIZER_SSE)
+        const __m128 lanes = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+        const __m128 zero = _mm_setzero_ps();
+        __m128 a0 = _mm_set1_ps(t.A[0]), a1 = _mm_set1_ps(t.A[1]), a2 = _mm_set1_ps(t.A[2]);
+        __m128 r0 = _mm_set1_ps(t.B[0] * py + t.C[0]), r1 = _mm_set1_ps(t.B[1] * py + t.C[1]), r2 = _mm_set1_ps(t.B[2] * py + t.C[2]);
+        __m128 zx = _mm_set1_ps(t.ZX), zr = _mm_set1_ps(t.ZY * py + t.Z0);
+        __m128 minZ = _mm_set1_ps(t.MinZ), maxZ = _mm_set1_ps(t.MaxZ);
+        for (int x = x0; x <= x1; x += 4)
+        {
+            __m128 px = _mm_add_ps(_mm_set1_ps((float) x), lanes);
+            __m128 e0 = _mm_add_ps(_mm_mul_ps(a0, px), r0);
+            __m128 e1 = _mm_add_ps(_mm_mul_ps(a1, px), r1);
+            __m128 e2 = _mm_add_ps(_mm_mul_ps(a2, px), r2);
+            __m128 inside = _mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_and_ps(_mm_cmpge_ps(e1, zero), _mm_cmpge_ps(e2, zero)));
+            if (_mm_movemask_ps(inside) == 0)
+                continue;
+            __m128 z = _mm_min_ps(_mm_max_ps(_mm_add_ps(_mm_mul_ps(zx, px), zr), minZ), maxZ);
+            int mask = _mm_movemask_ps(_mm_and_ps(inside, _mm_cmplt_ps(z, _mm_loadu_ps(depthRow + x))));
+            if (mask == 0)
+                continue;
+            float edges[3][4], depths[4];
+            _mm_storeu_ps(edges[0], e0);
+            _mm_storeu_ps(edges[1], e1);
+            _mm_storeu_ps(edges[2], e2);
+            _mm_storeu_ps(depths, z);
+            for (int lane = 0; lane < 4; lane++)
+            {
+                if ((mask & (1 << lane)) == 0)
+                    continue;
+                depthRow[x + lane] = depths[lane];
+                color[row + x + lane] = shade(t, edges[1][lane], edges[2][lane], edges[0][lane]);
+                shaded++;
+            }
+        }
+#else
+        for (int x = x0; x <= x1; x++)
+        {
+            float px = x + 0.5f;
+            float e0 = t.A[0] * px + t.B[0] * py + t.C[0];
+            float e1 = t.A[1] * px + t.B[1] * py + t.C[1];
+            float e2 = t.A[2] * px + t.B[2] * py + t.C[2];
+            if (e0 < 0.0f || e1 < 0.0f || e2 < 0.0f)
+                continue;
+            float z = glm::clamp(t.ZX * px + t.ZY * py + t.Z0, t.MinZ, t.MaxZ);
+            if (z >= depthRow[x])
+                continue;
+            depthRow[x] = z;
+            color[row + x] = shade(t, e1, e2, e0);
+            shaded++;
+        }
+#endif
+        return shaded;
+    }
+
+    // e0..e2 are the (unnormalized) barycentric weights of the three vertices.
+    uint32_t shade(const Triangle &t, float e0, float e1, float e2) const
+    {
+        float b0 = e0 * t.InverseArea, b1 = e1 * t.InverseArea, b2 = e2 * t.InverseArea;
+        float w = 1.0f / (b0 * t.InverseW[0] + b1 * t.InverseW[1] + b2 * t.InverseW[2]);
+        glm::vec3 world = (t.World[0] * b0 + t.World[1] * b1 + t.World[2] * b2) * w;
+        glm::vec3 normal = glm::normalize((t.Normal[0] * b0 + t.Normal[1] * b1 + t.Normal[2] * b2) * w);
+        glm::vec2 uv = (t.TexCoords[0] * b0 + t.TexCoords[1] * b1 + t.TexCoords[2] * b2) * w;
+
+        const SoftwareMaterial &material = materials[t.Material];
+        glm::vec3 albedo = material.Diffuse != nullptr ? glm::vec3(material.Diffuse->Sample(uv)) : material.Color;
+        float specularStrength = material.SpecularMap != nullptr ? material.SpecularMap->Sample(uv).r : material.Specular;
+
+        glm::vec3 light = glm::normalize(-LightDirection);
+        float diffuse = std::max(glm::dot(normal, light), 0.0f);
+        glm::vec3 toViewer = glm::normalize(viewPosition - world);
+        float specular = diffuse > 0.0f ? std::pow(std::max(glm::dot(toViewer, glm::reflect(-light, normal)), 0.0f), material.Shininess) : 0.0f;
+        glm::vec3 result = albedo * (Ambient + diffuse * LightColor) + specularStrength * specular * LightColor;
+        return pack(glm::vec4(result, 1.0f));
+    }
+
+    // owns worker threads, not copyable
+    SoftwareRasterizer(const SoftwareRasterizer &);
+    SoftwareRasterizer &operator=(const SoftwareRasterizer &);
+};
+#endif
@@ -0,0 +1,198 @@
+#ifndef STREAM_BUFFER_H
+#define STREAM_BUFFER_H
+
+#include <glad/glad.h>
+
+#include <learnopengl/memory_tracker.h>
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+// Where an allocation lives: Data is the CPU pointer to write through, Buffer/Offset what to bind.
+struct StreamAllocation
+{
+    void* Data;
+    GLuint Buffer;
+    GLintptr Offset;
+    GLsizeiptr Size;
+};
+
+struct StreamBufferStats
+{
+    unsigned int Frames;
+    unsigned int Stalls;        // BeginFrame() calls that had to wait for the GPU
+    double StallMilliseconds;   // total time spent waiting
+    GLsizeiptr PeakBytes;       // most bytes allocated in one frame
+    unsigned int Overflows;     // allocations that didn't fit in their region
+};
+
+// Streaming allocator for per frame GPU data (uniform blocks, storage buffers, vertices): one buffer created
+// with glBufferStorage and mapped once with GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT, so writing data is a
+// plain memcpy and never goes through glBufferData/glBufferSubData.
+//
+// The buffer is split in Regions blocks of RegionSize bytes, one per frame in flight. BeginFrame() moves to the
+// next region and waits on the fence EndFrame() placed the last time it was used, Allocate() is a bump of an
+// offset within the region. A wait in BeginFrame() means the CPU got Regions frames ahead of the GPU, it is
+// counted in Stats() (add a region if it happens regularly).
+class StreamBuffer
+{
+public:
+    unsigned int ID;
+    GLsizeiptr RegionSize;
+    unsigned int Regions;
+
+    StreamBuffer(GLsizeiptr regionSize, unsigned int regions = 3) : ID(0), Regions(regions), region(0), head(0), mapped(nullptr)
+    {
+        // regions start on a boundary every binding target accepts
+        RegionSize = (regionSize + 255) & ~(GLsizeiptr) 255;
+        fences = new GLsync[regions]();
+        std::memset(&stats, 0, sizeof(stats));
+
+        GLint alignment = 0;
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+        uniformAlignment = alignment > 0 ? alignment : 256;
+        glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+        storageAlignment = alignment > 0 ? alignment : 256;
+
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glCreateBuffers(1, &ID);
+        glNamedBufferStorage(ID, RegionSize * regions, NULL, flags);
+        mapped = (char*) glMapNamedBufferRange(ID, 0, RegionSize * regions, flags);
+        if (mapped == nullptr)
+            std::cout << "ERROR::STREAM_BUFFER::MAP_FAILED" << std::endl;
+        MemoryTracker::Instance().SetGpu(MemoryTracker::BUFFERS, ID, RegionSize * regions, ("stream buffer " + std::to_string(ID)).c_str());
+        // so the first BeginFrame() lands on region 0
+        region = regions - 1;
+        head = RegionSize;
+    }
+
+    ~StreamBuffer()
+    {
+        for (unsigned int i = 0; i < Regions; i++)
+        {
+            if (fences[i] != 0)
+                glDeleteSync(fences[i]);
+        }
+        delete[] fences;
+        if (ID != 0)
+        {
+            glUnmapNamedBuffer(ID);
+            glDeleteBuffers(1, &ID);
+            MemoryTracker::Instance().Release(MemoryTracker::BUFFERS, ID);
+        }
+    }
+
+    // moves to the next region, blocking only while the GPU still reads it.
+    void BeginFrame()
+    {
+        region = (region + 1) % Regions;
+        head = 0;
+        stats.Frames++;
+        GLsync fence = fences[region];
+        if (fence == 0)
+            return;
+        if (glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+        {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED)
+                ;
+            stats.Stalls++;
+            stats.StallMilliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }
+        glDeleteSync(fence);
+        fences[region] = 0;
+    }
+
+    // size bytes at an offset that is a multiple of alignment. Data is null when the region is full.
+    StreamAllocation Allocate(GLsizeiptr size, GLsizeiptr alignment = 16)
+    {
+        StreamAllocation allocation = {nullptr, ID, 0, size};
+        GLsizeiptr offset = (head + alignment - 1) / alignment * alignment;
+        if (offset + size > RegionSize)
+        {
+            stats.Overflows++;
+            return allocation;
+        }
+        head = offset + size;
+        if (head > stats.PeakBytes)
+            stats.PeakBytes = head;
+        allocation.Offset = (GLintptr) region * RegionSize + offset;
+        allocation.Data = mapped + allocation.Offset;
+        return allocation;
+    }
+
+    // aligned for glBindBufferRange(GL_UNIFORM_BUFFER, ...)
+    StreamAllocation AllocateUniform(GLsizeiptr size)
+    {
+        return Allocate(size, uniformAlignment);
+    }
+
+    // aligned for glBindBufferRange(GL_SHADER_STORAGE_BUFFER, ...)
+    StreamAllocation AllocateStorage(GLsizeiptr size)
+    {
+        return Allocate(size, storageAlignment);
+    }
+
+    // copies size bytes into a new allocation.
+    StreamAllocation Upload(const void* data, GLsizeiptr size, GLsizeiptr alignment = 16)
+    {
+        StreamAllocation allocation = Allocate(size, alignment);
+        if (allocation.Data != nullptr)
+            std::memcpy(allocation.Data, data, size);
+        return allocation;
+    }
+
+    static void BindUniform(GLuint binding, const StreamAllocation &allocation)
+    {
+        glBindBufferRange(GL_UNIFORM_BUFFER, binding, allocation.Buffer, allocation.Offset, allocation.Size);
+    }
+
+    static void BindStorage(GLuint binding, const StreamAllocation &allocation)
+    {
+        glBindBufferRange(GL_SHADER_STORAGE_BUFFER, binding, allocation.Buffer, allocation.Offset, allocation.Size);
+    }
+
+    // call once the draws reading this frame's allocations have been issued.
+    void EndFrame()
+    {
+        if (fences[region] != 0)
+            glDeleteSync(fences[region]);
+        fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+
+    GLsizeiptr UniformAlignment() const
+    {
+        return uniformAlignment;
+    }
+
+    GLsizeiptr StorageAlignment() const
+    {
+        return storageAlignment;
+    }
+
+    // bytes allocated in the current region so far.
+    GLsizeiptr Used() const
+    {
+        return head;
+    }
+
+    const StreamBufferStats &Stats() const
+    {
+        return stats;
+    }
+
+private:
+    unsigned int region;
+    GLsizeiptr head;
+    char* mapped;
+    GLsync* fences;
+    GLsizeiptr uniformAlignment;
+    GLsizeiptr storageAlignment;
+    StreamBufferStats stats;
+
+    // owns GL objects, not copyable
+    StreamBuffer(const StreamBuffer &);
+    StreamBuffer &operator=(const StreamBuffer &);
+};
+#endif
@@ -0,0 +1,105 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <learnopengl/cpu_profiler.h>
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A fixed set of threads running one ParallelFor at a time. The range is cut into one contiguous chunk per
+// worker, chunk i always goes to worker i (the calling thread is worker 0), so per worker outputs can be merged
+// in a deterministic order afterwards.
+class WorkerPool
+{
+public:
+    // worker(index, begin, end) processes items [begin, end).
+    typedef std::function<void(unsigned int, unsigned int, unsigned int)> Job;
+
+    // workers = 0 uses every hardware thread.
+    explicit WorkerPool(unsigned int workers = 0) : count(0), generation(0), pending(0), stopping(false)
+    {
+        if (workers == 0)
+            workers = std::thread::hardware_concurrency() > 0 ? std::thread::hardware_concurrency() : 1;
+        for (unsigned int i = 1; i < workers; i++)
+            threads.push_back(std::thread(&WorkerPool::workerLoop, this, i));
+    }
+
+    ~WorkerPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (unsigned int i = 0; i < threads.size(); i++)
+            threads[i].join();
+    }
+
+    unsigned int Workers() const
+    {
+        return (unsigned int) threads.size() + 1;
+    }
+
+    // runs job over [0, items) on every worker and returns once all of them are done.
+    void ParallelFor(unsigned int items, const Job &job)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            this->job = &job;
+            count = items;
+            pending = (unsigned int) threads.size();
+            generation++;
+        }
+        wake.notify_all();
+        run(0);
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [this]() { return pending == 0; });
+        this->job = nullptr;
+    }
+
+private:
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable wake, finished;
+    const Job* job;
+    unsigned int count;
+    unsigned int generation;
+    unsigned int pending;
+    bool stopping;
+
+    void run(unsigned int worker)
+    {
+        CPU_PROFILE_ZONE("WorkerPool::job");
+        unsigned int workers = Workers();
+        unsigned int begin = (unsigned int) ((unsigned long long) count * worker / workers);
+        unsigned int end = (unsigned int) ((unsigned long long) count * (worker + 1) / workers);
+        (*job)(worker, begin, end);
+    }
+
+    void workerLoop(unsigned int worker)
+    {
+        unsigned int seen = 0;
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this, seen]() { return stopping || generation != seen; });
+                if (stopping)
+                    return;
+                seen = generation;
+            }
+            run(worker);
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--pending == 0)
+                finished.notify_all();
+        }
+    }
+
+    // owns threads, not copyable
+    WorkerPool(const WorkerPool &);
+    WorkerPool &operator=(const WorkerPool &);
+};
+#endif
@@ -0,0 +1,11 @@
+#version 330 core
+out vec4 FragColor;
+
+uniform sampler2D texture_diffuse1;
+
+in vec2 TexCoords;
+
+void main()
+{
+    FragColor = texture(texture_diffuse1, TexCoords);
+}
\ No newline at end of file
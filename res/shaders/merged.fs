@@ -0,0 +1,17 @@
+#version 450 core
+out vec4 FragColor;
+
+// one layer per texture of the batch, Textures holds layer numbers: indexing a sampler array with a
+// per draw value isn't dynamically uniform, selecting a layer is
+uniform sampler2DArray materialTextures;
+
+in vec2 TexCoords;
+in vec3 Normal;
+flat in ivec4 Textures;
+
+void main()
+{
+    vec4 diffuse = Textures.x >= 0 ? texture(materialTextures, vec3(TexCoords, Textures.x)) : vec4(1.0);
+    float light = max(dot(normalize(Normal), normalize(vec3(0.3, 1.0, 0.5))), 0.2);
+    FragColor = vec4(diffuse.rgb * light, diffuse.a);
+}
\ No newline at end of file
@@ -0,0 +1,35 @@
+#version 450 core
+// gl_DrawID is core in 4.60, the extension also covers 4.5 drivers
+#extension GL_ARB_shader_draw_parameters : require
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoords;
+
+// one record per draw of the multi draw, see MergedGeometry
+struct DrawRecord
+{
+    mat4 model;
+    ivec4 textures; // diffuse, specular, normal, height: layer of materialTextures, -1 if the mesh has none
+};
+
+layout (std430, binding = 0) readonly buffer DrawData
+{
+    DrawRecord draws[];
+};
+
+out vec2 TexCoords;
+out vec3 Normal;
+flat out ivec4 Textures;
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform int firstDraw;
+
+void main()
+{
+    DrawRecord record = draws[firstDraw + gl_DrawIDARB];
+    TexCoords = aTexCoords;
+    Normal = mat3(record.model) * aNormal;
+    Textures = record.textures;
+    gl_Position = projection * view * record.model * vec4(aPos, 1.0);
+}
\ No newline at end of file
@@ -6,9 +6,12 @@ layout (location = 2) in vec2 aTexCoord;
 out vec3 ourColor;
 out vec2 TexCoord;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+layout (std140) uniform Transforms
+{
+    mat4 model;
+    mat4 view;
+    mat4 projection;
+};
 
 void main()
 {
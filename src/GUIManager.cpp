@@ -7,10 +7,39 @@
 #include "imgui/imgui_impl_glfw.h"
 #include "imgui/imgui_impl_opengl3.h"
 #include <GLFW/glfw3.h>
+#include <learnopengl/profile_tree.h>
+#include <learnopengl/cpu_profiler.h>
+#include <learnopengl/memory_tracker.h>
+#include <learnopengl/allocation_counter.h>
+#include <atomic>
+#include <cstdlib>
+
+// ImGui's heap goes through these so the UI shows up in the memory panel and in the allocation checks (it
+// doesn't use operator new). Every block carries its size in front.
+static std::atomic<int64_t> ui_heap_bytes(0);
+
+static void *CountedAlloc(size_t size, void *) {
+    size_t *block = (size_t *) std::malloc(size + 16);
+    if (block == nullptr)
+        return nullptr;
+    block[0] = size;
+    ui_heap_bytes += (int64_t) size;
+    AllocationCounter::Record(size);
+    return (char *) block + 16;
+}
+
+static void CountedFree(void *pointer, void *) {
+    if (pointer == nullptr)
+        return;
+    size_t *block = (size_t *) ((char *) pointer - 16);
+    ui_heap_bytes -= (int64_t) block[0];
+    std::free(block);
+}
 
 bool GUIManager::Init(GLFWwindow *window) {
     // Setup Dear ImGui context
     IMGUI_CHECKVERSION();
+    ImGui::SetAllocatorFunctions(CountedAlloc, CountedFree);
     ImGui::CreateContext();
     ImGuiIO &io = ImGui::GetIO();
     (void) io;
@@ -31,13 +60,164 @@ bool GUIManager::Init(GLFWwindow *window) {
 bool show_demo_window;
 bool show_another_window;
 ImVec4 clear_color = ImVec4(0.45f, 0.55f, 0.60f, 1.00f);
+const ProfileTree *gpu_profile = nullptr;
+bool show_cpu_profile = false;
+// reused every frame, so the flame view stops allocating once it saw its busiest frame
+std::vector<CpuZoneEvent> cpu_events;
+std::vector<float> cpu_lanes;
+bool show_memory = false;
+int memory_top_count = 10;
+std::vector<MemoryTracker::Consumer> memory_consumers;
+
+// one row per scope with its time and a rolling graph of the last frames, children indented under it.
+static void DrawProfileNodes(const ProfileTree &tree, int parent) {
+    const std::vector<ProfileNode> &nodes = tree.Nodes();
+    for (unsigned int i = 0; i < nodes.size(); i++) {
+        const ProfileNode &node = nodes[i];
+        if (node.Parent != parent)
+            continue;
+        ImGui::PushID(i);
+        bool open = ImGui::TreeNodeEx(node.Name, ImGuiTreeNodeFlags_DefaultOpen, "%-12s %7.3f ms  avg %7.3f ms",
+                                      node.Name, node.Milliseconds, node.Average);
+        float scale = node.Average * 3.0f > 0.001f ? node.Average * 3.0f : 0.001f;
+        ImGui::PlotLines("##history", node.History, ProfileNode::HistorySize, tree.HistoryHead(), NULL, 0.0f, scale,
+                         ImVec2(0, 30));
+        if (open) {
+            DrawProfileNodes(tree, (int) i);
+            ImGui::TreePop();
+        }
+        ImGui::PopID();
+    }
+}
+
+static void DrawProfile(const char *title, const ProfileTree &tree) {
+    ImGui::SetNextWindowSize(ImVec2(360, 240), ImGuiCond_FirstUseEver);
+    ImGui::Begin(title);
+    ImGui::Text("%u frames", tree.Frames());
+    DrawProfileNodes(tree, -1);
+    ImGui::End();
+}
+
+// the zones of the last completed frame: x is time, each thread gets a lane, each nesting level a row.
+static void DrawFlameView() {
+    ImGui::SetNextWindowSize(ImVec2(640, 260), ImGuiCond_FirstUseEver);
+    ImGui::Begin("CPU");
+    CpuProfiler &profiler = CpuProfiler::Instance();
+    uint64_t begin, end;
+    if (!profiler.LastFrame(begin, end)) {
+        ImGui::Text(CPU_PROFILER_ENABLED ? "waiting for frames" : "CPU zones are compiled out (CPU_PROFILER_ENABLED)");
+        ImGui::End();
+        return;
+    }
+    cpu_events.clear();
+    profiler.Collect(begin, end, cpu_events);
+    ImGui::Text("frame %.3f ms, %u zones", (end - begin) / 1000000.0, (unsigned int) cpu_events.size());
+
+    // lane height of every thread from its deepest zone
+    const float row = 18.0f;
+    unsigned int threads = profiler.Threads();
+    cpu_lanes.assign(threads + 1, 0.0f);
+    for (unsigned int i = 0; i < cpu_events.size(); i++) {
+        float height = (cpu_events[i].Depth + 2) * row;
+        if (height > cpu_lanes[cpu_events[i].Thread + 1])
+            cpu_lanes[cpu_events[i].Thread + 1] = height;
+    }
+    for (unsigned int t = 1; t <= threads; t++)
+        cpu_lanes[t] += cpu_lanes[t - 1];
+
+    ImDrawList *draw = ImGui::GetWindowDrawList();
+    ImVec2 origin = ImGui::GetCursorScreenPos();
+    float width = ImGui::GetContentRegionAvail().x;
+    double scale = width / (double) (end - begin);
+    for (unsigned int t = 0; t < threads; t++) {
+        if (cpu_lanes[t + 1] > cpu_lanes[t])
+            draw->AddText(ImVec2(origin.x, origin.y + cpu_lanes[t]), IM_COL32(200, 200, 200, 255), profiler.ThreadName(t).c_str());
+    }
+    for (unsigned int i = 0; i < cpu_events.size(); i++) {
+        const CpuZoneEvent &event = cpu_events[i];
+        uint64_t from = event.Begin > begin ? event.Begin : begin;
+        uint64_t to = event.End < end ? event.End : end;
+        ImVec2 min(origin.x + (float) ((from - begin) * scale), origin.y + cpu_lanes[event.Thread] + (event.Depth + 1) * row);
+        ImVec2 max(origin.x + (float) ((to - begin) * scale) + 1.0f, min.y + row - 1.0f);
+        // same name, same colour
+        float hue = (float) ((((uintptr_t) event.Name) >> 4) % 64) / 64.0f;
+        draw->AddRectFilled(min, max, ImColor::HSV(hue, 0.5f, 0.7f));
+        if (max.x - min.x > 24.0f) {
+            draw->PushClipRect(min, max, true);
+            draw->AddText(ImVec2(min.x + 2.0f, min.y + 1.0f), IM_COL32(0, 0, 0, 255), event.Name);
+            draw->PopClipRect();
+        }
+        if (ImGui::IsMouseHoveringRect(min, max))
+            ImGui::SetTooltip("%s\n%.3f ms", event.Name, (event.End - event.Begin) / 1000000.0);
+    }
+    ImGui::Dummy(ImVec2(width, cpu_lanes[threads]));
+    ImGui::End();
+}
+
+static float Megabytes(int64_t bytes) {
+    return bytes / (1024.0f * 1024.0f);
+}
+
+// current and peak bytes per category, then the largest single consumers.
+static void DrawMemoryPanel() {
+    MemoryTracker &memory = MemoryTracker::Instance();
+    ImGuiIO &io = ImGui::GetIO();
+    memory.SetCpu(MemoryTracker::UI, 0, ui_heap_bytes.load(), "ImGui heap");
+    memory.SetGpu(MemoryTracker::UI, 1, (int64_t) io.Fonts->TexWidth * io.Fonts->TexHeight * 4, "ImGui font atlas");
+
+    ImGui::SetNextWindowSize(ImVec2(520, 360), ImGuiCond_FirstUseEver);
+    ImGui::Begin("Memory");
+    MemoryTracker::Usage total = memory.Total();
+    ImGui::Text("CPU %.2f MB (peak %.2f)   GPU est. %.2f MB (peak %.2f)", Megabytes(total.Cpu), Megabytes(total.PeakCpu),
+                Megabytes(total.Gpu), Megabytes(total.PeakGpu));
+    ImGui::Separator();
+
+    ImGui::Columns(5, "categories");
+    const char *headers[] = {"MB", "cpu", "cpu peak", "gpu est", "gpu peak"};
+    for (int i = 0; i < 5; i++) {
+        ImGui::Text("%s", headers[i]);
+        ImGui::NextColumn();
+    }
+    ImGui::Separator();
+    for (int c = 0; c < MemoryTracker::CATEGORY_COUNT; c++) {
+        MemoryTracker::Usage used = memory.CategoryUsage((MemoryTracker::Category) c);
+        ImGui::Text("%s (%u)", MemoryTracker::CategoryName((MemoryTracker::Category) c), used.Entries);
+        ImGui::NextColumn();
+        ImGui::Text("%.2f", Megabytes(used.Cpu));
+        ImGui::NextColumn();
+        ImGui::Text("%.2f", Megabytes(used.PeakCpu));
+        ImGui::NextColumn();
+        ImGui::Text("%.2f", Megabytes(used.Gpu));
+        ImGui::NextColumn();
+        ImGui::Text("%.2f", Megabytes(used.PeakGpu));
+        ImGui::NextColumn();
+    }
+    ImGui::Columns(1);
+    ImGui::Separator();
+
+    ImGui::SliderInt("top", &memory_top_count, 1, 50);
+    memory.TopConsumers((unsigned int) memory_top_count, memory_consumers);
+    for (unsigned int i = 0; i < memory_consumers.size(); i++) {
+        const MemoryTracker::Consumer &consumer = memory_consumers[i];
+        ImGui::Text("%8.2f MB  cpu %7.2f  gpu %7.2f  %-14s %s", Megabytes(consumer.Cpu + consumer.Gpu), Megabytes(consumer.Cpu),
+                    Megabytes(consumer.Gpu), MemoryTracker::CategoryName(consumer.Type), consumer.Name);
+    }
+    ImGui::End();
+}
 
 bool GUIManager::Update() {
+    CPU_PROFILE_ZONE("GUIManager::Update");
     // Start the Dear ImGui frame
     ImGui_ImplOpenGL3_NewFrame();
     ImGui_ImplGlfw_NewFrame();
     ImGui::NewFrame();
     ImGui::ShowDemoWindow(&show_demo_window);
+    if (gpu_profile != nullptr)
+        DrawProfile("GPU", *gpu_profile);
+    if (show_cpu_profile)
+        DrawFlameView();
+    if (show_memory)
+        DrawMemoryPanel();
     ImGui::Render();
     return true;
     // 1. Show the big demo window (Most of the sample code is in ImGui::ShowDemoWindow()! You can browse its code to learn more about Dear ImGui!).
@@ -87,11 +267,24 @@ bool GUIManager::Update() {
 }
 
 bool GUIManager::Draw() {
+    CPU_PROFILE_ZONE("GUIManager::Draw");
     ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
     return true;
 }
 
 
+void GUIManager::ShowGpuProfile(const ProfileTree *tree) {
+    gpu_profile = tree;
+}
+
+void GUIManager::ShowCpuProfile(bool show) {
+    show_cpu_profile = show;
+}
+
+void GUIManager::ShowMemory(bool show) {
+    show_memory = show;
+}
+
 bool GUIManager::Destroy() {
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
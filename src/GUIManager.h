@@ -7,6 +7,8 @@
 
 #include <GLFW/glfw3.h>
 
+class ProfileTree;
+
 class GUIManager {
 public:
     static bool Init(GLFWwindow *window);
@@ -16,6 +18,15 @@ public:
     static bool Draw();
 
     static bool Destroy();
+
+    // shows the tree in a "GPU" overlay window from the next Update() on, null hides it.
+    static void ShowGpuProfile(const ProfileTree *tree);
+
+    // shows the CPU zones of the last frame as a flame graph, one lane per thread.
+    static void ShowCpuProfile(bool show);
+
+    // shows the MemoryTracker totals, high-water marks and largest consumers in a "Memory" window.
+    static void ShowMemory(bool show);
 };
 
 
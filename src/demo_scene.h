@@ -0,0 +1,197 @@
+//
+// The textured quad the window (main.cpp) and the headless benchmark (headless.cpp) both draw.
+//
+
+#ifndef LEARN_OPENGL_DEMO_SCENE_H
+#define LEARN_OPENGL_DEMO_SCENE_H
+
+#include <iostream>
+#include <glad/glad.h>
+#include <learnopengl/cpu_profiler.h>
+#include <learnopengl/memory_tracker.h>
+#include <learnopengl/shader.h>
+#include <learnopengl/shader_library.h>
+#include <learnopengl/stream_buffer.h>
+#include <stb_image.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <shader_params.h>
+
+inline int CreateTexture(char const *filename, int mode) {
+    CPU_PROFILE_ZONE("CreateTexture");
+    // load and create a texture
+    // -------------------------
+    unsigned int texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D,
+                  texture); // all upcoming GL_TEXTURE_2D operations now have effect on this texture object
+    // set the texture wrapping parameters
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S,
+                    GL_REPEAT);    // set texture wrapping to GL_REPEAT (default wrapping method)
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    // set texture filtering parameters
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    // load image, create texture and generate mipmaps
+    int width, height, nrChannels;
+    stbi_set_flip_vertically_on_load(true);
+
+    unsigned char *data = stbi_load(filename, &width, &height, &nrChannels, 0);
+    if (data) {
+        MemoryTracker &memory = MemoryTracker::Instance();
+        memory.SetCpu(MemoryTracker::LOADER, texture, (int64_t) width * height * nrChannels, filename);
+        glTexImage2D(GL_TEXTURE_2D, 0, mode, width, height, 0, mode, GL_UNSIGNED_BYTE, data);
+        glGenerateMipmap(GL_TEXTURE_2D);
+        memory.SetGpu(MemoryTracker::TEXTURES, texture, MemoryTracker::TextureBytes(width, height, 4, true), filename);
+    } else {
+        std::cout << "Failed to load texture " << filename << std::endl;
+    }
+    stbi_image_free(data);
+    MemoryTracker::Instance().Release(MemoryTracker::LOADER, texture);
+
+    // 0 tells the caller the image couldn't be loaded
+    if (!data) {
+        glDeleteTextures(1, &texture);
+        return 0;
+    }
+    return texture;
+}
+
+inline int InitVAO() {
+    // set up vertex data (and buffer(s)) and configure vertex attributes
+    // Once your vertex coordinates have been processed in the vertex shader,
+    // they should be in normalized device coordinates (NDC),
+    // which is a small space where the x, y and z values vary from -1.0 to 1.0.
+    // ------------------------------------------------------------------
+    float vertices[] = {
+            // positions          // colors           // texture coords
+            0.5f, 0.5f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f,   // top right
+            0.5f, -0.5f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f,   // bottom right
+            -0.5f, -0.5f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f,   // bottom left
+            -0.5f, 0.5f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 1.0f    // top left
+    };
+
+    unsigned int indices[] = {  // note that we start from 0!
+            0, 1, 3,   // first triangle
+            1, 2, 3    // second triangle
+    };
+
+    unsigned int VBO, VAO, EBO;
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO); // generate one with a buffer ID (first argument is size, second is id)
+    glGenBuffers(1, &EBO);
+
+    // bind the Vertex Array Object first
+    // from this point on we should bind/configure the corresponding VBO(s) and attribute pointer(s).
+    glBindVertexArray(VAO);
+
+    glBindBuffer(GL_ARRAY_BUFFER, VBO); // buffer type of a vertex buffer object is GL_ARRAY_BUFFER
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices,
+                 GL_STATIC_DRAW); // copies the previously defined vertex data into the buffer's memory:
+
+    // copy our index array in a element buffer for OpenGL to use
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+
+    // position attribute
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void *) 0);
+    glEnableVertexAttribArray(0);
+    // color attribute
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void *) (3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    // texture coord attribute
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void *) (6 * sizeof(float)));
+    glEnableVertexAttribArray(2);
+
+    // the call to glVertexAttribPointer registered VBO as the vertex attribute's bound vertex buffer object
+    // so afterwards we can safely unbind
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // You can unbind the VAO afterwards so other VAO calls won't accidentally modify this VAO, but this rarely happens.
+    // Modifying other VAOs requires a call to glBindVertexArray anyways so we generally don't unbind VAOs (nor VBOs) when it's not directly necessary.
+    glBindVertexArray(0);
+    MemoryTracker::Instance().SetGpu(MemoryTracker::MESHES, VAO, sizeof(vertices) + sizeof(indices), "demo quad");
+
+    return VAO;
+}
+
+struct DemoScene {
+    Shader shader;
+    ShaderParams::shader::Uniforms uniforms;
+    ShaderParams::shader::Transforms transforms;
+    int VAO;
+    int texture0;
+    int texture1;
+
+    DemoScene() : shader(0), VAO(-1), texture0(0), texture1(0) {
+    }
+
+    // submit every program first, the driver compiles them while we decode the textures.
+    bool Load(ShaderLibrary &shaders) {
+        CPU_PROFILE_ZONE("DemoScene::Load");
+        int shaderHandle = shaders.Submit("shader", "../res/shaders/shader.vs", "../res/shaders/shader.fs");
+
+        VAO = InitVAO();
+        if (VAO == -1)
+            return false;
+
+        texture0 = CreateTexture("../res/textures/container.jpg", GL_RGB);
+        texture1 = CreateTexture("../res/textures/window.png", GL_RGBA);
+
+        // a missing file or a broken shader must fail the load, the benchmark would time an empty frame otherwise
+        shaders.Collect();
+        if (!shaders.IsLinked(shaderHandle) || texture0 == 0 || texture1 == 0)
+            return false;
+        shader = shaders.Get(shaderHandle);
+
+        // the sampler units and the Transforms binding are fixed by the generated parameters,
+        // so nothing is looked up by name inside the render loop.
+        uniforms = ShaderParams::shader::Setup(shader.ID);
+        return true;
+    }
+
+    void Draw(StreamBuffer &frameData, const glm::mat4 &view, float aspect) {
+        CPU_PROFILE_ZONE("DemoScene::Draw");
+        glEnable(GL_DEPTH_TEST);
+        // rendering commands here
+        // the glClearColor function is a state-setting function and glClear is a state-using function
+        // uses the current state to retrieve the clearing color from.
+        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+
+        // Just like clearing the color buffer, we can clear the depth buffer by specifying the DEPTH_BUFFER_BIT
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        glActiveTexture(GL_TEXTURE0 + ShaderParams::shader::texture0);
+        glBindTexture(GL_TEXTURE_2D, texture0);
+
+        glActiveTexture(GL_TEXTURE0 + ShaderParams::shader::texture1);
+        glBindTexture(GL_TEXTURE_2D, texture1);
+
+        shader.use();
+
+        glUniform4f(uniforms.baseColor, 0.0f, 0.0f, 0.1f, 0.0f);
+
+        // create transformations
+        //transforms.model = glm::rotate(transforms.model, glm::radians(-55.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+        //transforms.model = glm::rotate(transforms.model, (float)glfwGetTime(), glm::vec3(1.0f, 0.0f, 0.0f));
+        transforms.model = glm::mat4(1.0f);
+        transforms.view = view;
+        // note: currently we set the projection matrix each frame, but since the projection matrix rarely changes it's often best practice to set it outside the main loop only once.
+        transforms.projection = glm::perspective(glm::radians(45.0f), aspect, 0.1f, 100.0f);
+
+        // the struct matches the std140 layout of the block, so a plain copy updates every matrix at once
+        StreamAllocation transformsBlock = frameData.Upload(&transforms, sizeof(transforms), frameData.UniformAlignment());
+        StreamBuffer::BindUniform(ShaderParams::shader::Transforms::Binding, transformsBlock);
+
+        // seeing as we only have a single VAO there's no need to bind it every time,
+        // but we'll do so to keep things a bit more organized
+        glBindVertexArray(VAO);
+
+        // glDrawElements(mode, number of elements, type of the indices, indices pointer)
+        // ps: leave last argument null if element buffer have binded.
+        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, NULL);
+        // glBindVertexArray(0); // no need to unbind it every time
+    }
+};
+
+#endif //LEARN_OPENGL_DEMO_SCENE_H
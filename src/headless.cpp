@@ -0,0 +1,244 @@
+//
+// Headless benchmark: draws the demo scene into an offscreen target through an EGL surfaceless context
+// (no window, no display server, works with Mesa's llvmpipe on GPU-less machines), flies a scripted camera
+// path for a fixed number of frames and writes the frame time statistics as JSON. With --capture the GL calls
+// of the first frames go to a capture file for tools/gl_replay and tools/gl_analyze.
+//
+// --check-allocations N counts the heap allocations (operator new) of the first N frames after the warm-up and
+// fails the run if there is any: a steady state frame is expected not to allocate.
+//
+// usage: learn_OpenGL_headless [--frames N] [--warmup N] [--width W] [--height H] [--output frame_stats.json]
+//                              [--capture frames.glcap] [--capture-frames N] [--check-allocations N]
+//
+
+#include <algorithm>
+#include <cmath>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+// this executable counts its allocations, see --check-allocations
+#define ALLOCATION_COUNTER_IMPLEMENTATION
+#include <learnopengl/allocation_counter.h>
+#include <learnopengl/gl_capture.h>
+#include <learnopengl/gl_state_cache.h>
+#include <learnopengl/gpu_profiler.h>
+#include <learnopengl/headless_context.h>
+#include <learnopengl/memory_tracker.h>
+#include <learnopengl/render_graph.h>
+#include <learnopengl/stream_buffer.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include "demo_scene.h"
+
+// a camera keyframe, the path is flown at one keyframe per second and loops.
+struct CameraKey {
+    glm::vec3 position;
+    glm::vec3 target;
+};
+
+const CameraKey cameraPath[] = {
+        {glm::vec3(-1.0f, 0.0f, 3.0f),  glm::vec3(-1.0f, 0.0f, 1.0f)},
+        {glm::vec3(0.0f, 0.5f, 2.0f),   glm::vec3(0.0f, 0.0f, 0.0f)},
+        {glm::vec3(1.5f, 0.0f, 1.5f),   glm::vec3(0.0f, 0.0f, 0.0f)},
+        {glm::vec3(0.0f, -1.0f, 1.0f),  glm::vec3(0.0f, 0.0f, 0.0f)},
+        {glm::vec3(-0.3f, 0.2f, 0.6f),  glm::vec3(0.0f, 0.0f, 0.0f)},
+        {glm::vec3(-2.0f, 0.0f, 4.0f),  glm::vec3(0.0f, 0.0f, 0.0f)},
+};
+const unsigned int cameraKeys = sizeof(cameraPath) / sizeof(cameraPath[0]);
+
+glm::mat4 cameraAt(double seconds) {
+    double position = std::fmod(seconds, (double) cameraKeys);
+    unsigned int key = (unsigned int) position;
+    float t = (float) (position - key);
+    const CameraKey &from = cameraPath[key];
+    const CameraKey &to = cameraPath[(key + 1) % cameraKeys];
+    // smoothstep so the camera eases in and out of every key
+    t = t * t * (3.0f - 2.0f * t);
+    return glm::lookAt(glm::mix(from.position, to.position, t), glm::mix(from.target, to.target, t), glm::vec3(0.0f, 1.0f, 0.0f));
+}
+
+struct FrameTimeStats {
+    double mean, min, p50, p95, p99, max;
+};
+
+FrameTimeStats computeStats(std::vector<double> samples) {
+    FrameTimeStats stats = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+    if (samples.empty())
+        return stats;
+    std::sort(samples.begin(), samples.end());
+    double sum = 0.0;
+    for (unsigned int i = 0; i < samples.size(); i++)
+        sum += samples[i];
+    size_t last = samples.size() - 1;
+    stats.mean = sum / samples.size();
+    stats.min = samples[0];
+    stats.p50 = samples[(size_t) (last * 0.50 + 0.5)];
+    stats.p95 = samples[(size_t) (last * 0.95 + 0.5)];
+    stats.p99 = samples[(size_t) (last * 0.99 + 0.5)];
+    stats.max = samples[last];
+    return stats;
+}
+
+std::string jsonString(const char *text) {
+    std::string result = "\"";
+    for (const char *c = text != NULL ? text : ""; *c != 0; c++) {
+        if (*c == '"' || *c == '\\')
+            result += '\\';
+        result += *c;
+    }
+    return result + "\"";
+}
+
+void writeStats(FILE *file, const char *name, const FrameTimeStats &stats, bool last) {
+    std::fprintf(file, "  \"%s\": {\"mean\": %.4f, \"min\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f}%s\n",
+                 name, stats.mean, stats.min, stats.p50, stats.p95, stats.p99, stats.max, last ? "" : ",");
+}
+
+double now() {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int main(int argc, char **argv) {
+    int frames = 600;
+    int warmup = 30;
+    int width = 800;
+    int height = 600;
+    const char *output = "frame_stats.json";
+    const char *capturePath = NULL;
+    int captureFrames = 10;
+    int checkedFrames = 0;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--frames") == 0)
+            frames = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--warmup") == 0)
+            warmup = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--width") == 0)
+            width = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--height") == 0)
+            height = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--output") == 0)
+            output = argv[i + 1];
+        else if (std::strcmp(argv[i], "--capture") == 0)
+            capturePath = argv[i + 1];
+        else if (std::strcmp(argv[i], "--capture-frames") == 0)
+            captureFrames = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--check-allocations") == 0)
+            checkedFrames = std::atoi(argv[i + 1]);
+        else {
+            std::cout << "unknown option " << argv[i] << std::endl;
+            return -1;
+        }
+    }
+
+    EGLDisplay display;
+    EGLContext context;
+    if (!CreateHeadlessContext(display, context))
+        return -1;
+    GLStateCache::Install();
+    // installed after the state cache, so the capture holds the calls as the app made them
+    if (capturePath != NULL && !GLCapture::Start(capturePath, width, height))
+        return -1;
+
+    ShaderLibrary shaders((GLADloadproc) eglGetProcAddress);
+    DemoScene scene;
+    if (!scene.Load(shaders)) {
+        std::cout << "ERROR::HEADLESS::SCENE_LOAD_FAILED (run from a directory where ../res resolves)" << std::endl;
+        return -1;
+    }
+    StreamBuffer *frameData = new StreamBuffer(64 * 1024);
+    GpuProfiler *gpuProfiler = new GpuProfiler();
+
+    // the same scene pass as the window, into offscreen targets. Nothing reads them, so the pass is kept
+    // alive as a side effect. (graph and frameData are pointers so they go before the context does)
+    RenderGraph *graph = new RenderGraph();
+    RenderTextureDesc colorDesc = {width, height, GL_RGBA8};
+    RenderTextureDesc depthDesc = {width, height, GL_DEPTH24_STENCIL8};
+    RenderGraph::Resource color = graph->CreateTexture("color", colorDesc);
+    RenderGraph::Resource depth = graph->CreateTexture("depth", depthDesc);
+
+    glm::mat4 view(1.0f);
+    graph->AddPass("scene", [&](const RenderGraph &) {
+        GpuZone zone(*gpuProfiler, "scene");
+        scene.Draw(*frameData, view, (float) width / (float) height);
+    }).Write(color).Write(depth).SideEffect();
+
+    if (!graph->Compile())
+        return -1;
+
+    // the camera advances a fixed 1/60 s per frame, so every run renders exactly the same images.
+    std::vector<double> frameTimes, submitTimes;
+    frameTimes.reserve(frames);
+    submitTimes.reserve(frames);
+    int allocatingFrames = 0;
+    for (int frame = 0; frame < warmup + frames; frame++) {
+        bool checked = frame >= warmup && frame < warmup + checkedFrames;
+        AllocationCounter::Reset();
+        AllocationCounter::Enable(checked);
+        double start = now();
+        view = cameraAt(frame / 60.0);
+        GLCapture::BeginFrame();
+
+        frameData->BeginFrame();
+        gpuProfiler->BeginFrame();
+        graph->Execute();
+        gpuProfiler->EndFrame();
+        frameData->EndFrame();
+        double submitted = now();
+
+        // without a swap to pace it, wait for the GPU so the time covers the whole frame
+        glFinish();
+        GLStateCache::EndFrame();
+        GLCapture::EndFrame();
+        if (GLCapture::Active() && GLCapture::Frames() >= (unsigned int) captureFrames)
+            GLCapture::Stop();
+        double finished = now();
+        AllocationCounter::Enable(false);
+        AllocationCounter::Counts allocations = AllocationCounter::Read();
+        if (checked && allocations.Allocations > 0) {
+            if (allocatingFrames++ < 10)
+                std::printf("frame %d: %llu heap allocations, %llu bytes\n", frame, (unsigned long long) allocations.Allocations,
+                            (unsigned long long) allocations.Bytes);
+        }
+
+        if (frame >= warmup) {
+            frameTimes.push_back(finished - start);
+            submitTimes.push_back(submitted - start);
+        }
+    }
+
+    FrameTimeStats frameStats = computeStats(frameTimes);
+    FrameTimeStats submitStats = computeStats(submitTimes);
+    std::printf("%s: %d frames at %dx%d, mean %.3f ms, p95 %.3f ms, p99 %.3f ms\n", (const char *) glGetString(GL_RENDERER),
+                frames, width, height, frameStats.mean, frameStats.p95, frameStats.p99);
+    MemoryTracker::Instance().Print();
+    if (checkedFrames > 0)
+        std::printf("%d of %d checked frames allocated\n", allocatingFrames, std::min(checkedFrames, frames));
+
+    FILE *file = std::fopen(output, "w");
+    if (file == NULL) {
+        std::cout << "Failed to write " << output << std::endl;
+    } else {
+        std::fprintf(file, "{\n");
+        std::fprintf(file, "  \"renderer\": %s,\n", jsonString((const char *) glGetString(GL_RENDERER)).c_str());
+        std::fprintf(file, "  \"version\": %s,\n", jsonString((const char *) glGetString(GL_VERSION)).c_str());
+        std::fprintf(file, "  \"width\": %d,\n  \"height\": %d,\n  \"frames\": %d,\n  \"warmup\": %d,\n", width, height, frames, warmup);
+        writeStats(file, "frame_ms", frameStats, false);
+        writeStats(file, "submit_ms", submitStats, false);
+        std::fprintf(file, "  \"gpu\": %s\n", gpuProfiler->ToJSON().c_str());
+        std::fprintf(file, "}\n");
+        std::fclose(file);
+    }
+
+    GLCapture::Stop();
+    // release the GL objects while the context is still current
+    delete graph;
+    delete gpuProfiler;
+    delete frameData;
+    DestroyHeadlessContext(display, context);
+    return file != NULL && allocatingFrames == 0 ? 0 : -1;
+}
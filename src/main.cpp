@@ -1,35 +1,58 @@
 ﻿
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <learnopengl/shader.h>
-#include <stb_image.h>
+#include <learnopengl/shader_library.h>
+#include <learnopengl/gl_state_cache.h>
+#include <learnopengl/gl_capture.h>
+#include <learnopengl/render_graph.h>
+#include <learnopengl/stream_buffer.h>
+#include <learnopengl/fixed_timestep.h>
+#include <learnopengl/frame_pacer.h>
+#include <learnopengl/gpu_profiler.h>
+#include <learnopengl/cpu_profiler.h>
 #include <learnopengl/filesystem.h>
+// this executable counts its allocations, see --check-allocations
+#define ALLOCATION_COUNTER_IMPLEMENTATION
+#include <learnopengl/allocation_counter.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include "GUIManager.h"
-#include <Windows.h>
+#include "demo_scene.h"
 #include <imgui/imgui.h>
 
 // settings
 const unsigned int SCR_WIDTH = 800;
 const unsigned int SCR_HEIGHT = 600;
 
-glm::vec3 cameraPos = glm::vec3(-1.0f, 0.0f, 3.0f);
 glm::vec3 cameraFront = glm::vec3(0.0f, 0.0f, -2.0f);
 glm::vec3 cameraUp = glm::vec3(0.0f, 1.0f, 0.0f);
-float deltaTime = 0.0f;    // Time between current frame and last frame
-float lastFrame = 0.0f; // Time of last frame
+
+// the frame graph, for the resize callback to update its backbuffer size
+RenderGraph *renderGraph = NULL;
+
+// everything the simulation advances, one copy per tick. The renderer draws a blend of the last two.
+struct SimulationState {
+    glm::vec3 cameraPos;
+};
 
 void framebuffer_size_callback(GLFWwindow *window, int width, int height) {
     glViewport(0, 0, width, height);
+    // minimized windows report 0x0, keep the last size so the projection stays valid
+    if (renderGraph != NULL && width > 0 && height > 0)
+        renderGraph->ResizeBackbuffer(width, height);
     ImGui::SetNextWindowPos(ImVec2(0, 0));
     ImGui::SetNextWindowSize(ImVec2(width, height));
     std::cout << "test" << std::endl;
 }
 
 void processInput(GLFWwindow *window) {
+    CPU_PROFILE_ZONE("processInput");
     if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
         glfwSetWindowShouldClose(window, true);
 
@@ -38,20 +61,27 @@ void processInput(GLFWwindow *window) {
     if (glfwGetKey(window, GLFW_KEY_2) == GLFW_PRESS)
         glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
 
-    float currentFrame = glfwGetTime();
-    deltaTime = currentFrame - lastFrame;
-    lastFrame = currentFrame;
+    // P dumps the CPU zones still in the profiler as a Chrome trace (open it in chrome://tracing or Perfetto)
+    static bool tracePressed = false;
+    bool pressed = glfwGetKey(window, GLFW_KEY_P) == GLFW_PRESS;
+    if (pressed && !tracePressed && CpuProfiler::Instance().WriteChromeTrace("cpu_trace.json"))
+        std::cout << "wrote cpu_trace.json" << std::endl;
+    tracePressed = pressed;
+}
 
-    float cameraSpeed = 2.5f * deltaTime;
+// one fixed step of the simulation, the keys are sampled once per tick.
+void simulate(GLFWwindow *window, SimulationState &state, float tickSeconds) {
+    CPU_PROFILE_ZONE("simulate");
+    float cameraSpeed = 2.5f * tickSeconds;
 
     if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
-        cameraPos += cameraSpeed * cameraFront;
+        state.cameraPos += cameraSpeed * cameraFront;
     if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
-        cameraPos -= cameraSpeed * cameraFront;
+        state.cameraPos -= cameraSpeed * cameraFront;
     if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
-        cameraPos -= glm::normalize(glm::cross(cameraFront, cameraUp)) * cameraSpeed;
+        state.cameraPos -= glm::normalize(glm::cross(cameraFront, cameraUp)) * cameraSpeed;
     if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
-        cameraPos += glm::normalize(glm::cross(cameraFront, cameraUp)) * cameraSpeed;
+        state.cameraPos += glm::normalize(glm::cross(cameraFront, cameraUp)) * cameraSpeed;
 }
 
 GLFWwindow *initWindows() {
@@ -87,6 +117,9 @@ GLFWwindow *initWindows() {
         return NULL;
     }
 
+    // from here on redundant binds/state changes made through glad never reach the driver.
+    GLStateCache::Install();
+
     glViewport(0, 0, 800, 600);
 
     // the moment a user resizes the window the viewport should be adjusted as well.
@@ -95,196 +128,196 @@ GLFWwindow *initWindows() {
     return window;
 }
 
-int CreateTexture(char const *filename, int mode) {
-    // load and create a texture
-    // -------------------------
-    unsigned int texture;
-    glGenTextures(1, &texture);
-    glBindTexture(GL_TEXTURE_2D,
-                  texture); // all upcoming GL_TEXTURE_2D operations now have effect on this texture object
-    // set the texture wrapping parameters
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S,
-                    GL_REPEAT);    // set texture wrapping to GL_REPEAT (default wrapping method)
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    // set texture filtering parameters
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    // load image, create texture and generate mipmaps
-    int width, height, nrChannels;
-    stbi_set_flip_vertically_on_load(true);
-
-    unsigned char *data = stbi_load(filename, &width, &height, &nrChannels, 0);
-    if (data) {
-        glTexImage2D(GL_TEXTURE_2D, 0, mode, width, height, 0, mode, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-    } else {
-        std::cout << "Failed to load texture" << std::endl;
-    }
-    stbi_image_free(data);
 
-    return texture;
-}
-
-int InitVAO() {
-    // set up vertex data (and buffer(s)) and configure vertex attributes
-    // Once your vertex coordinates have been processed in the vertex shader,
-    // they should be in normalized device coordinates (NDC),
-    // which is a small space where the x, y and z values vary from -1.0 to 1.0.
-    // ------------------------------------------------------------------
-    float vertices[] = {
-            // positions          // colors           // texture coords
-            0.5f, 0.5f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f,   // top right
-            0.5f, -0.5f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f,   // bottom right
-            -0.5f, -0.5f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f,   // bottom left
-            -0.5f, 0.5f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 1.0f    // top left
-    };
-
-    unsigned int indices[] = {  // note that we start from 0!
-            0, 1, 3,   // first triangle
-            1, 2, 3    // second triangle
-    };
-
-    unsigned int VBO, VAO, EBO;
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO); // generate one with a buffer ID (first argument is size, second is id)
-    glGenBuffers(1, &EBO);
-
-    // bind the Vertex Array Object first
-    // from this point on we should bind/configure the corresponding VBO(s) and attribute pointer(s).
-    glBindVertexArray(VAO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, VBO); // buffer type of a vertex buffer object is GL_ARRAY_BUFFER
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices,
-                 GL_STATIC_DRAW); // copies the previously defined vertex data into the buffer's memory:
-
-    // copy our index array in a element buffer for OpenGL to use
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-
-    // position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void *) 0);
-    glEnableVertexAttribArray(0);
-    // color attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void *) (3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    // texture coord attribute
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void *) (6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
-
-    // the call to glVertexAttribPointer registered VBO as the vertex attribute's bound vertex buffer object
-    // so afterwards we can safely unbind
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-    // You can unbind the VAO afterwards so other VAO calls won't accidentally modify this VAO, but this rarely happens.
-    // Modifying other VAOs requires a call to glBindVertexArray anyways so we generally don't unbind VAOs (nor VBOs) when it's not directly necessary.
-    glBindVertexArray(0);
-
-    return VAO;
-}
-
-
-int main() {
+// --capture frames.glcap records every GL call from startup through the first --capture-frames frames (default 60)
+// for tools/gl_replay and tools/gl_analyze.
+// --check-allocations N counts the heap allocations (operator new and ImGui's heap) of the N frames after a one second
+// warm-up, the whole loop from input to swap, then exits. The exit code is -1 if any of them allocated.
+int main(int argc, char **argv) {
 //    FreeConsole();
 
+    CPU_PROFILE_THREAD("main");
+
+    const char *capturePath = NULL;
+    unsigned int captureFrames = 60;
+    int checkedFrames = 0;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--capture") == 0)
+            capturePath = argv[i + 1];
+        else if (strcmp(argv[i], "--capture-frames") == 0)
+            captureFrames = (unsigned int) atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--check-allocations") == 0)
+            checkedFrames = atoi(argv[i + 1]);
+    }
+
     auto window = initWindows();
     if (window == NULL)
         return -1;
+    if (capturePath != NULL && !GLCapture::Start(capturePath, SCR_WIDTH, SCR_HEIGHT))
+        return -1;
 
     GUIManager::Init(window);
 
-    Shader shader("../res/shaders/shader.vs", "../res/shaders/shader.fs");
-
-    int VAO = InitVAO();
-    if (VAO == -1)
+    ShaderLibrary shaders((GLADloadproc) glfwGetProcAddress);
+    DemoScene scene;
+    if (!scene.Load(shaders))
         return -1;
 
-    int texture0 = CreateTexture("../res/textures/container.jpg", GL_RGB);
-    int texture1 = CreateTexture("../res/textures/window.png", GL_RGBA);
+    // per frame uniform blocks, SSBOs and vertices are written straight into this persistently mapped buffer.
+    // (owned through a pointer so it is released while the context is still current)
+    StreamBuffer *frameData = new StreamBuffer(64 * 1024);
+
+    // GPU time of every pass, read back a few frames late so it never stalls, shown in the GUI overlay.
+    GpuProfiler *gpuProfiler = new GpuProfiler();
+    GUIManager::ShowGpuProfile(&gpuProfiler->Tree());
+    GUIManager::ShowCpuProfile(true);
+    GUIManager::ShowMemory(true);
 
     // uncomment this call to draw in wireframe polygons.
 //    glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
 
-    // render loop
-    glEnable(GL_DEPTH_TEST);
-
-    while (!glfwWindowShouldClose(window)) {
-        processInput(window);
-        GUIManager::Update();
-        // rendering commands here
-        // the glClearColor function is a state-setting function and glClear is a state-using function
-        // uses the current state to retrieve the clearing color from.
-        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
-
-        // Just like clearing the color buffer, we can clear the depth buffer by specifying the DEPTH_BUFFER_BIT
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, texture0);
-
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, texture1);
-
-        shader.use();
-
-        // either set it manually like so:
-        //glUniform1i(glGetUniformLocation(shader.ID, "texture0"), 0);
-        //glUniform1i(glGetUniformLocation(shader.ID, "texture1"), 1);
+    SimulationState previous, current;
+    current.cameraPos = glm::vec3(-1.0f, 0.0f, 3.0f);
+    previous = current;
+    glm::vec3 cameraPos = current.cameraPos;
+
+    // the frame is described once as a render graph: each pass says what it writes (and reads),
+    // the graph orders the passes and binds their targets. New passes (shadows, post-processing)
+    // only have to declare their render targets here.
+    RenderGraph graph;
+    int framebufferWidth, framebufferHeight;
+    glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+    RenderGraph::Resource backbuffer = graph.ImportBackbuffer("backbuffer", framebufferWidth, framebufferHeight);
+    renderGraph = &graph;
+
+    graph.AddPass("scene", [&](const RenderGraph &) {
+        GpuZone zone(*gpuProfiler, "scene");
+        glm::mat4 view = glm::lookAt(cameraPos, cameraPos + cameraFront, cameraUp);
+        const RenderTextureDesc &size = graph.Desc(backbuffer);
+        scene.Draw(*frameData, view, (float) size.Width / (float) size.Height);
+    }).Write(backbuffer);
+
+    graph.AddPass("ui", [&](const RenderGraph &) {
+        GpuZone zone(*gpuProfiler, "ui");
+        // the ImGui backend loads GL through glad too, the state cache sees every binding it changes
+        GUIManager::Draw();
+    }).Write(backbuffer);
 
-        shader.setInt("texture0", 0); // or with shader class
-        shader.setInt("texture1", 1); // or with shader class
-        shader.setVec4("baseColor", 0.0f, 0.0f, 0.1f, 0.0f);
+    if (!graph.Compile())
+        return -1;
 
-        // create transformations
-        glm::mat4 model;
-        glm::mat4 view;
-        glm::mat4 projection;
-        //model = glm::rotate(model, glm::radians(-55.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-        //model = glm::rotate(model, (float)glfwGetTime(), glm::vec3(1.0f, 0.0f, 0.0f));
-        //view = glm::translate(view, glm::vec3(0.0f, 0.0f, -3.0f));
+    // the simulation always advances at 60 ticks per second, rendering runs at whatever rate the pacer
+    // allows and interpolates between the last two ticks.
+    FixedTimestep timestep(60.0);
 
-        view = glm::lookAt(cameraPos, cameraPos + cameraFront, cameraUp);
+    // vsync with input sampled just in time for the next refresh, switch to Immediate (and set MaxFrameRate
+    // to cap it) to measure the uncapped frame rate.
+    FramePacer pacer;
+    const GLFWvidmode *videoMode = glfwGetVideoMode(glfwGetPrimaryMonitor());
+    if (videoMode != NULL)
+        pacer.RefreshRate = videoMode->refreshRate;
+    pacer.SetSwapMode(FramePacer::VSync);
+    pacer.JustInTimeInput = true;
 
-        projection = glm::perspective(glm::radians(45.0f), (float) SCR_WIDTH / (float) SCR_HEIGHT, 0.1f, 100.0f);
+    // frames before the allocation checks start, the GUI windows and the profilers reach their steady state
+    const int allocationWarmup = 60;
+    int frame = 0;
+    int allocatingFrames = 0;
 
-        // retrieve the matrix uniform locations
-        unsigned int modelLoc = glGetUniformLocation(shader.ID, "model");
-        unsigned int viewLoc = glGetUniformLocation(shader.ID, "view");
-        // pass them to the shaders (3 different ways)
-        glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-        glUniformMatrix4fv(viewLoc, 1, GL_FALSE, &view[0][0]);
-        // note: currently we set the projection matrix each frame, but since the projection matrix rarely changes it's often best practice to set it outside the main loop only once.
-        shader.setMat4("projection", projection);
+    // render loop
+    while (!glfwWindowShouldClose(window)) {
+        bool checked = checkedFrames > 0 && frame >= allocationWarmup && frame < allocationWarmup + checkedFrames;
+        AllocationCounter::Reset();
+        AllocationCounter::Enable(checked);
+        pacer.BeginFrame();
+        CPU_PROFILE_FRAME();
+        GLCapture::BeginFrame();
 
-        // seeing as we only have a single VAO there's no need to bind it every time,
-        // but we'll do so to keep things a bit more organized
-        glBindVertexArray(VAO);
+        //The glfwPollEvents function checks if any events are triggered (like keyboard input or mouse movement events),
+        //updates the window state, and calls the corresponding functions (which we can set via callback methods).
+        glfwPollEvents();
+        processInput(window);
+        pacer.Mark(FramePacer::Input);
 
-        // glDrawElements(mode, number of elements, type of the indices, indices pointer)
-        // ps: leave last argument null if element buffer have binded.
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, NULL);
+        timestep.BeginFrame(glfwGetTime());
+        while (timestep.Tick()) {
+            previous = current;
+            simulate(window, current, (float) timestep.TickSeconds);
+        }
+        cameraPos = glm::mix(previous.cameraPos, current.cameraPos, timestep.Alpha());
+        pacer.Mark(FramePacer::Simulation);
 
-        GUIManager::Draw();
+        GUIManager::Update();
 
-        // glBindVertexArray(0); // no need to unbind it every time
+        {
+            CPU_PROFILE_ZONE("render");
+            frameData->BeginFrame();
+            gpuProfiler->BeginFrame();
+            gpuProfiler->Push("frame");
+            graph.Execute();
+            gpuProfiler->Pop();
+            gpuProfiler->EndFrame();
+            frameData->EndFrame();
+        }
+        pacer.Mark(FramePacer::Render);
 
         // Double buffer
         // The front buffer contains the final output image that is shown at the screen,
         // while all the rendering commands draw to the back buffer.
         // As soon as all the rendering commands are finished we swap the back buffer to the front buffer,
         // so the image is instantly displayed to the user
-        glfwSwapBuffers(window);
-
-        //The glfwPollEvents function checks if any events are triggered (like keyboard input or mouse movement events),
-        //updates the window state, and calls the corresponding functions (which we can set via callback methods).
-        glfwPollEvents();
+        {
+            CPU_PROFILE_ZONE("swap");
+            glfwSwapBuffers(window);
+        }
+        pacer.Mark(FramePacer::Swap);
+        GLStateCache::EndFrame();
+        GLCapture::EndFrame();
+        if (GLCapture::Active() && GLCapture::Frames() >= captureFrames)
+            GLCapture::Stop();
+
+        timestep.EndFrame(glfwGetTime());
+        if (timestep.StatsUpdated()) {
+            const FixedTimestepStats &stats = timestep.Stats();
+            char title[128];
+            snprintf(title, sizeof(title), "LearnOpenGL - simulation %.1f Hz, render %.1f fps (%.2f ms)",
+                     stats.SimulationRate, stats.RenderRate, stats.FrameMilliseconds);
+            glfwSetWindowTitle(window, title);
+        }
+
+        AllocationCounter::Enable(false);
+        AllocationCounter::Counts allocations = AllocationCounter::Read();
+        if (checked && allocations.Allocations > 0) {
+            if (allocatingFrames++ < 10)
+                printf("frame %d: %llu heap allocations, %llu bytes\n", frame, (unsigned long long) allocations.Allocations,
+                       (unsigned long long) allocations.Bytes);
+        }
+        frame++;
+        if (checkedFrames > 0 && frame == allocationWarmup + checkedFrames) {
+            printf("%d of %d checked frames allocated\n", allocatingFrames, checkedFrames);
+            glfwSetWindowShouldClose(window, true);
+        }
     }
 
+    // latency and stutter percentiles of the session
+    pacer.PrintReport();
+
+    // GPU pass timings of the last frames, for comparing runs offline
+    FILE *gpuProfile = fopen("gpu_profile.json", "w");
+    if (gpuProfile != NULL) {
+        fprintf(gpuProfile, "%s\n", gpuProfiler->ToJSON().c_str());
+        fclose(gpuProfile);
+    }
 
+    GLCapture::Stop();
+    GUIManager::ShowGpuProfile(nullptr);
+    delete gpuProfiler;
+    delete frameData;
     GUIManager::Destroy();
 
     glfwDestroyWindow(window);
     // As soon as we exit the render loop we would like to properly clean/delete all resources that were allocated.
     glfwTerminate();
 
-    return 0;
+    return allocatingFrames == 0 ? 0 : -1;
 }
\ No newline at end of file
@@ -0,0 +1,432 @@
+// gl_analyze: reads a GL capture (see include/learnopengl/gl_capture.h) without any GL context and reports, per
+// frame and in total: calls, draws, state changes that set what was already set, uniform uploads of unchanged
+// values, binds by object kind and how many of them actually changed the binding (bind churn), and bytes
+// uploaded (glBufferData/glTexImage2D...) or written through mapped buffers.
+//
+// The loading part of the capture (everything before the first frame) is reported as "setup".
+//
+// usage: gl_analyze <capture> [--json analysis.json]
+
+#include <learnopengl/gl_capture_format.h>
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// the few GL enums the analysis needs, so no GL header is involved.
+static const uint32_t TEXTURE0 = 0x84C0;
+static const uint32_t ELEMENT_ARRAY_BUFFER = 0x8893;
+static const uint32_t FRAMEBUFFER = 0x8D40;
+static const uint32_t READ_FRAMEBUFFER = 0x8CA8;
+static const uint32_t DRAW_FRAMEBUFFER = 0x8CA9;
+
+enum BindKind
+{
+    BIND_PROGRAM,
+    BIND_VERTEX_ARRAY,
+    BIND_BUFFER,
+    BIND_TEXTURE,
+    BIND_SAMPLER,
+    BIND_FRAMEBUFFER,
+    BIND_KINDS
+};
+
+static const char* bindKindNames[BIND_KINDS] = {"program", "vertex_array", "buffer", "texture", "sampler", "framebuffer"};
+
+struct FrameReport
+{
+    unsigned int Calls;
+    unsigned int Draws;             // a multi draw counts every draw it issues
+    unsigned long long Instances;
+    unsigned int Clears;
+    unsigned int StateCalls;        // binds and fixed function state
+    unsigned int RedundantState;
+    unsigned int Uniforms;
+    unsigned int RedundantUniforms;
+    unsigned int Binds[BIND_KINDS];
+    unsigned int BindChanges[BIND_KINDS];
+    double UploadBytes;
+    double MappedBytes;
+    unsigned int CallCounts[GLCaptureFormat::CALL_COUNT];
+    unsigned int RedundantCounts[GLCaptureFormat::CALL_COUNT];
+};
+
+// Shadow of the GL state the capture sets, keyed by (what, slot), to find calls that change nothing.
+class StateShadow
+{
+public:
+    // stores value under key, true if it was already the value there.
+    bool Set(unsigned int what, uint64_t slot, const void* value, size_t size)
+    {
+        std::string &current = values[key(what, slot)];
+        if (current.size() == size && std::memcmp(current.data(), value, size) == 0)
+            return true;
+        current.assign((const char*) value, size);
+        return false;
+    }
+
+    bool Set(unsigned int what, uint64_t slot, uint32_t value)
+    {
+        return Set(what, slot, &value, sizeof(value));
+    }
+
+    void Forget(unsigned int what, uint64_t slot)
+    {
+        values.erase(key(what, slot));
+    }
+
+private:
+    struct KeyHash
+    {
+        size_t operator()(const std::pair<unsigned int, uint64_t> &k) const
+        {
+            return std::hash<uint64_t>()(k.second * 131 + k.first);
+        }
+    };
+
+    std::unordered_map<std::pair<unsigned int, uint64_t>, std::string, KeyHash> values;
+
+    static std::pair<unsigned int, uint64_t> key(unsigned int what, uint64_t slot)
+    {
+        return std::make_pair(what, slot);
+    }
+};
+
+class Analyzer
+{
+public:
+    Analyzer() : program(0), activeUnit(0)
+    {
+        frames.push_back(FrameReport());
+        std::memset(&frames.back(), 0, sizeof(FrameReport));
+    }
+
+    void Add(const GLCaptureCommand &command)
+    {
+        if (command.Call == GLCaptureFormat::FRAME_BEGIN)
+        {
+            frames.push_back(FrameReport());
+            std::memset(&frames.back(), 0, sizeof(FrameReport));
+            return;
+        }
+        if (command.Call >= GLCaptureFormat::CALL_COUNT || command.Call == GLCaptureFormat::FRAME_END)
+            return;
+
+        FrameReport &frame = frames.back();
+        frame.Calls++;
+        frame.CallCounts[command.Call]++;
+        const GLCaptureFormat::CallInfo &info = GLCaptureFormat::Info(command.Call);
+        bool redundant = false;
+        if (info.Type == GLCaptureFormat::BIND || info.Type == GLCaptureFormat::STATE)
+        {
+            redundant = state(frame, command);
+            frame.StateCalls++;
+            frame.RedundantState += redundant;
+        }
+        else if (info.Type == GLCaptureFormat::UNIFORM)
+        {
+            redundant = uniform(command);
+            frame.Uniforms++;
+            frame.RedundantUniforms += redundant;
+        }
+        else if (info.Type == GLCaptureFormat::DRAW)
+            draw(frame, command);
+        else if (info.Type == GLCaptureFormat::UPLOAD)
+        {
+            if (command.Call == GLCaptureFormat::MAPPED_WRITE)
+                frame.MappedBytes += command.PayloadSize;
+            else
+                frame.UploadBytes += command.PayloadSize;
+        }
+        else if (command.Call == GLCaptureFormat::CREATE_TEXTURES)
+        {
+            const uint32_t* names = (const uint32_t*) command.Payload;
+            for (uint32_t i = 0; i < command.U32(1) && i * sizeof(uint32_t) < command.PayloadSize; i++)
+                textureTargets[names[i]] = command.U32(0);
+        }
+        frame.RedundantCounts[command.Call] += redundant;
+    }
+
+    const std::vector<FrameReport> &Frames() const
+    {
+        return frames;
+    }
+
+private:
+    std::vector<FrameReport> frames;    // [0] is the setup before the first frame
+    StateShadow shadow;
+    std::unordered_map<uint32_t, uint32_t> textureTargets;
+    uint32_t program;
+    uint32_t activeUnit;
+
+    // counts a bind of kind, returns whether it was redundant.
+    static bool bind(FrameReport &frame, BindKind kind, bool redundant)
+    {
+        frame.Binds[kind]++;
+        frame.BindChanges[kind] += !redundant;
+        return redundant;
+    }
+
+    bool bindTexture(FrameReport &frame, uint32_t unit, uint32_t target, uint32_t texture)
+    {
+        return bind(frame, BIND_TEXTURE, shadow.Set(GLCaptureFormat::BIND_TEXTURE, ((uint64_t) unit << 32) | target, texture));
+    }
+
+    // the state calls, true when the call set what was already set.
+    bool state(FrameReport &frame, const GLCaptureCommand &c)
+    {
+        switch (c.Call)
+        {
+            case GLCaptureFormat::USE_PROGRAM:
+                program = c.U32(0);
+                return bind(frame, BIND_PROGRAM, shadow.Set(c.Call, 0, c.U32(0)));
+            case GLCaptureFormat::BIND_VERTEX_ARRAY:
+            {
+                bool redundant = shadow.Set(c.Call, 0, c.U32(0));
+                // the element array binding belongs to the vertex array
+                if (!redundant)
+                    shadow.Forget(GLCaptureFormat::BIND_BUFFER, ELEMENT_ARRAY_BUFFER);
+                return bind(frame, BIND_VERTEX_ARRAY, redundant);
+            }
+            case GLCaptureFormat::BIND_BUFFER:
+                return bind(frame, BIND_BUFFER, shadow.Set(c.Call, c.U32(0), c.U32(1)));
+            case GLCaptureFormat::BIND_BUFFER_BASE:
+            case GLCaptureFormat::BIND_BUFFER_RANGE:
+            {
+                // an indexed bind also sets the generic binding of the target
+                shadow.Set(GLCaptureFormat::BIND_BUFFER, c.U32(0), c.U32(2));
+                uint32_t range[5] = {c.U32(2), c.U32(3), c.U32(4), c.U32(5), c.U32(6)};
+                return bind(frame, BIND_BUFFER, shadow.Set(GLCaptureFormat::BIND_BUFFER_RANGE, ((uint64_t) c.U32(0) << 32) | c.U32(1), range, sizeof(range)));
+            }
+            case GLCaptureFormat::ACTIVE_TEXTURE:
+                activeUnit = c.U32(0) - TEXTURE0;
+                return shadow.Set(c.Call, 0, c.U32(0));
+            case GLCaptureFormat::BIND_TEXTURE:
+                if (c.U32(1) != 0)
+                    textureTargets[c.U32(1)] = c.U32(0);
+                return bindTexture(frame, activeUnit, c.U32(0), c.U32(1));
+            case GLCaptureFormat::BIND_TEXTURE_UNIT:
+                return bindTexture(frame, c.U32(0), textureTargets[c.U32(1)], c.U32(1));
+            case GLCaptureFormat::BIND_TEXTURES:
+            {
+                // redundant only when every unit already had its texture
+                bool redundant = true;
+                const uint32_t* names = (const uint32_t*) c.Payload;
+                for (uint32_t i = 0; i < c.U32(1); i++)
+                {
+                    uint32_t texture = c.U32(2) && i * sizeof(uint32_t) < c.PayloadSize ? names[i] : 0;
+                    redundant &= bindTexture(frame, c.U32(0) + i, textureTargets[texture], texture);
+                }
+                return redundant;
+            }
+            case GLCaptureFormat::BIND_SAMPLER:
+                return bind(frame, BIND_SAMPLER, shadow.Set(c.Call, c.U32(0), c.U32(1)));
+            case GLCaptureFormat::BIND_FRAMEBUFFER:
+            {
+                bool redundant = true;
+                if (c.U32(0) == FRAMEBUFFER || c.U32(0) == DRAW_FRAMEBUFFER)
+                    redundant &= shadow.Set(c.Call, DRAW_FRAMEBUFFER, c.U32(1));
+                if (c.U32(0) == FRAMEBUFFER || c.U32(0) == READ_FRAMEBUFFER)
+                    redundant &= shadow.Set(c.Call, READ_FRAMEBUFFER, c.U32(1));
+                return bind(frame, BIND_FRAMEBUFFER, redundant);
+            }
+            case GLCaptureFormat::ENABLE:
+            case GLCaptureFormat::DISABLE:
+                return shadow.Set(GLCaptureFormat::ENABLE, c.U32(0), c.Call == GLCaptureFormat::ENABLE);
+            case GLCaptureFormat::BLEND_FUNC:
+            {
+                uint32_t factors[4] = {c.U32(0), c.U32(1), c.U32(0), c.U32(1)};
+                return shadow.Set(GLCaptureFormat::BLEND_FUNC_SEPARATE, 0, factors, sizeof(factors));
+            }
+            case GLCaptureFormat::BLEND_EQUATION:
+            {
+                uint32_t modes[2] = {c.U32(0), c.U32(0)};
+                return shadow.Set(GLCaptureFormat::BLEND_EQUATION_SEPARATE, 0, modes, sizeof(modes));
+            }
+            case GLCaptureFormat::POLYGON_MODE:
+            case GLCaptureFormat::PIXEL_STOREI:
+                return shadow.Set(c.Call, c.U32(0), c.U32(1));
+            case GLCaptureFormat::MEMORY_BARRIER:
+                return false;
+            default:
+                // the whole call is the value: blend func separate, depth, viewport, scissor, clear color...
+                return shadow.Set(c.Call, 0, c.Args, c.Words * sizeof(uint32_t));
+        }
+    }
+
+    // uniforms are state of their program, keyed by program and location.
+    bool uniform(const GLCaptureCommand &c)
+    {
+        bool named = c.Call == GLCaptureFormat::PROGRAM_UNIFORM_1I || c.Call == GLCaptureFormat::PROGRAM_UNIFORM_1IV;
+        uint32_t target = named ? c.U32(0) : program;
+        unsigned int first = named ? 1 : 0;
+        std::string value((const char*) (c.Args + first + 1), (c.Words - first - 1) * sizeof(uint32_t));
+        value.append(c.Payload, c.PayloadSize);
+        return shadow.Set(GLCaptureFormat::UNIFORM_1I, ((uint64_t) target << 32) | c.U32(first), value.data(), value.size());
+    }
+
+    static void draw(FrameReport &frame, const GLCaptureCommand &c)
+    {
+        switch (c.Call)
+        {
+            case GLCaptureFormat::CLEAR:
+                frame.Clears++;
+                break;
+            case GLCaptureFormat::DRAW_ELEMENTS_INSTANCED_BASE_VERTEX:
+            case GLCaptureFormat::DRAW_ELEMENTS_INSTANCED_BASE_INSTANCE:
+                frame.Draws++;
+                frame.Instances += c.U32(5);
+                break;
+            case GLCaptureFormat::MULTI_DRAW_ELEMENTS_INDIRECT:
+                // the instance counts are in the indirect buffer, out of reach here
+                frame.Draws += c.U32(4);
+                break;
+            default:
+                frame.Draws++;
+                frame.Instances++;
+                break;
+        }
+    }
+};
+
+static unsigned int sum(const unsigned int* values, int count)
+{
+    unsigned int total = 0;
+    for (int i = 0; i < count; i++)
+        total += values[i];
+    return total;
+}
+
+static void printFrame(const char* name, const FrameReport &frame)
+{
+    std::printf("%-8s %7u %6u %8u %8u %8u %8u %7u %7u %10.1f %10.1f\n", name, frame.Calls, frame.Draws, frame.StateCalls, frame.RedundantState,
+                frame.Uniforms, frame.RedundantUniforms, sum(frame.Binds, BIND_KINDS), sum(frame.BindChanges, BIND_KINDS),
+                frame.UploadBytes / 1024.0, frame.MappedBytes / 1024.0);
+}
+
+static void accumulate(FrameReport &total, const FrameReport &frame)
+{
+    total.Calls += frame.Calls;
+    total.Draws += frame.Draws;
+    total.Instances += frame.Instances;
+    total.Clears += frame.Clears;
+    total.StateCalls += frame.StateCalls;
+    total.RedundantState += frame.RedundantState;
+    total.Uniforms += frame.Uniforms;
+    total.RedundantUniforms += frame.RedundantUniforms;
+    total.UploadBytes += frame.UploadBytes;
+    total.MappedBytes += frame.MappedBytes;
+    for (int i = 0; i < BIND_KINDS; i++)
+    {
+        total.Binds[i] += frame.Binds[i];
+        total.BindChanges[i] += frame.BindChanges[i];
+    }
+    for (int i = 0; i < GLCaptureFormat::CALL_COUNT; i++)
+    {
+        total.CallCounts[i] += frame.CallCounts[i];
+        total.RedundantCounts[i] += frame.RedundantCounts[i];
+    }
+}
+
+static void writeFrameJSON(FILE* file, const FrameReport &frame)
+{
+    std::fprintf(file, "{\"calls\": %u, \"draws\": %u, \"instances\": %llu, \"clears\": %u, \"state_calls\": %u, \"redundant_state\": %u, "
+                       "\"uniforms\": %u, \"redundant_uniforms\": %u, \"upload_bytes\": %.0f, \"mapped_bytes\": %.0f, \"binds\": {",
+                 frame.Calls, frame.Draws, frame.Instances, frame.Clears, frame.StateCalls, frame.RedundantState, frame.Uniforms,
+                 frame.RedundantUniforms, frame.UploadBytes, frame.MappedBytes);
+    for (int i = 0; i < BIND_KINDS; i++)
+        std::fprintf(file, "%s\"%s\": [%u, %u]", i > 0 ? ", " : "", bindKindNames[i], frame.Binds[i], frame.BindChanges[i]);
+    std::fprintf(file, "}}");
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::cout << "usage: gl_analyze <capture> [--json analysis.json]" << std::endl;
+        return -1;
+    }
+    const char* json = NULL;
+    for (int i = 2; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "--json") == 0)
+            json = argv[i + 1];
+        else
+        {
+            std::cout << "unknown option " << argv[i] << std::endl;
+            return -1;
+        }
+    }
+
+    GLCaptureReader reader;
+    if (!reader.Open(argv[1]))
+        return -1;
+    Analyzer analyzer;
+    GLCaptureCommand command;
+    while (reader.Next(command))
+        analyzer.Add(command);
+
+    const std::vector<FrameReport> &frames = analyzer.Frames();
+    std::printf("%s: %ux%u, %u frames\n\n", argv[1], reader.Header().Width, reader.Header().Height, (unsigned int) frames.size() - 1);
+    std::printf("%-8s %7s %6s %8s %8s %8s %8s %7s %7s %10s %10s\n", "frame", "calls", "draws", "state", "redund.", "uniforms", "redund.",
+                "binds", "changed", "upload KB", "mapped KB");
+    printFrame("setup", frames[0]);
+    FrameReport total;
+    std::memset(&total, 0, sizeof(total));
+    for (unsigned int i = 1; i < frames.size(); i++)
+    {
+        char name[16];
+        std::snprintf(name, sizeof(name), "%u", i - 1);
+        printFrame(name, frames[i]);
+        accumulate(total, frames[i]);
+    }
+
+    unsigned int count = frames.size() > 1 ? (unsigned int) frames.size() - 1 : 1;
+    std::printf("\nper frame: %.1f calls, %.1f draws, %.1f%% of state calls and %.1f%% of uniform uploads redundant\n",
+                (double) total.Calls / count, (double) total.Draws / count,
+                total.StateCalls > 0 ? 100.0 * total.RedundantState / total.StateCalls : 0.0,
+                total.Uniforms > 0 ? 100.0 * total.RedundantUniforms / total.Uniforms : 0.0);
+    std::printf("bind churn per frame (binds / changed):");
+    for (int i = 0; i < BIND_KINDS; i++)
+        std::printf(" %s %.1f/%.1f", bindKindNames[i], (double) total.Binds[i] / count, (double) total.BindChanges[i] / count);
+    std::printf("\n\nredundant calls in frames:\n");
+    for (int i = 0; i < GLCaptureFormat::CALL_COUNT; i++)
+    {
+        if (total.RedundantCounts[i] > 0)
+            std::printf("  %-32s %8u of %8u\n", GLCaptureFormat::Info(i).Name, total.RedundantCounts[i], total.CallCounts[i]);
+    }
+
+    if (json != NULL)
+    {
+        FILE* file = std::fopen(json, "w");
+        if (file == NULL)
+        {
+            std::cout << "ERROR::GL_ANALYZE::FAILED_TO_WRITE " << json << std::endl;
+            return -1;
+        }
+        std::fprintf(file, "{\n  \"capture\": \"%s\",\n  \"setup\": ", argv[1]);
+        writeFrameJSON(file, frames[0]);
+        std::fprintf(file, ",\n  \"frames\": [\n");
+        for (unsigned int i = 1; i < frames.size(); i++)
+        {
+            std::fprintf(file, "    ");
+            writeFrameJSON(file, frames[i]);
+            std::fprintf(file, "%s\n", i + 1 < frames.size() ? "," : "");
+        }
+        std::fprintf(file, "  ],\n  \"redundant_calls\": {");
+        bool first = true;
+        for (int i = 0; i < GLCaptureFormat::CALL_COUNT; i++)
+        {
+            if (total.RedundantCounts[i] == 0)
+                continue;
+            std::fprintf(file, "%s\"%s\": %u", first ? "" : ", ", GLCaptureFormat::Info(i).Name, total.RedundantCounts[i]);
+            first = false;
+        }
+        std::fprintf(file, "}\n}\n");
+        std::fclose(file);
+    }
+    return 0;
+}
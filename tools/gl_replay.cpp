@@ -0,0 +1,470 @@
+// gl_replay: re-issues a GL capture (see include/learnopengl/gl_capture.h) on a headless EGL context and times
+// every captured frame, so a frame recorded on one machine can be profiled on another, GPU or not.
+//
+// Object names, uniform and attribute locations are mapped to the ones the replaying driver hands out. The
+// default framebuffer of the capture becomes an offscreen target of the captured size. Writes through
+// mapped buffers are replayed with glNamedBufferSubData (buffer storage gets GL_DYNAMIC_STORAGE_BIT for it).
+//
+// --screenshot saves what the last draw rendered to (at the captured size), to compare against the original.
+//
+// usage: gl_replay <capture> [--output replay_stats.json] [--screenshot last_frame.ppm] [--state-cache]
+
+#include <learnopengl/gl_capture_format.h>
+#include <learnopengl/gl_state_cache.h>
+#include <learnopengl/headless_context.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+typedef std::unordered_map<GLuint, GLuint> NameMap;
+
+struct ReplayState
+{
+    NameMap buffers;
+    NameMap textures;
+    NameMap arrays;
+    NameMap framebuffers;
+    NameMap programs;       // shaders and programs share one namespace
+    std::unordered_map<uint64_t, GLint> uniforms;   // (replay program, captured location) -> location
+    std::unordered_map<GLint, GLint> attributes;
+    GLuint program;         // current program, for the glUniform* locations
+    GLuint backbuffer;      // stands in for framebuffer 0
+    GLuint drawTarget;      // bound draw framebuffer
+    GLuint lastTarget;      // the framebuffer the last draw went to, what --screenshot saves
+    unsigned int errors;
+};
+
+static GLuint mapName(const NameMap &names, GLuint name)
+{
+    if (name == 0)
+        return 0;
+    NameMap::const_iterator found = names.find(name);
+    return found != names.end() ? found->second : name;
+}
+
+static GLint mapUniform(const ReplayState &state, GLuint program, GLint location)
+{
+    if (location < 0)
+        return location;
+    std::unordered_map<uint64_t, GLint>::const_iterator found = state.uniforms.find(((uint64_t) program << 32) | (uint32_t) location);
+    return found != state.uniforms.end() ? found->second : location;
+}
+
+static GLint mapAttribute(const ReplayState &state, GLint location)
+{
+    std::unordered_map<GLint, GLint>::const_iterator found = state.attributes.find(location);
+    return found != state.attributes.end() ? found->second : location;
+}
+
+// new names for the names the capture created
+static void createNames(NameMap &names, const GLCaptureCommand &command, void (APIENTRYP *create)(GLsizei, GLuint*))
+{
+    GLsizei n = (GLsizei) command.U32(0);
+    const GLuint* captured = (const GLuint*) command.Payload;
+    std::vector<GLuint> created(n > 0 ? n : 0);
+    if (n > 0)
+        (*create)(n, &created[0]);
+    for (GLsizei i = 0; i < n && (size_t) i * sizeof(GLuint) < command.PayloadSize; i++)
+        names[captured[i]] = created[i];
+}
+
+static void deleteNames(NameMap &names, const GLCaptureCommand &command, void (APIENTRYP *destroy)(GLsizei, const GLuint*))
+{
+    GLsizei n = (GLsizei) command.U32(0);
+    const GLuint* captured = (const GLuint*) command.Payload;
+    std::vector<GLuint> mapped;
+    for (GLsizei i = 0; i < n && (size_t) i * sizeof(GLuint) < command.PayloadSize; i++)
+    {
+        mapped.push_back(mapName(names, captured[i]));
+        names.erase(captured[i]);
+    }
+    if (!mapped.empty())
+        (*destroy)((GLsizei) mapped.size(), &mapped[0]);
+}
+
+static const void* offset(uint64_t value)
+{
+    return (const void*) (uintptr_t) value;
+}
+
+static const void* payload(const GLCaptureCommand &command, unsigned int hasData)
+{
+    return command.U32(hasData) ? command.Payload : NULL;
+}
+
+// c is the command, short because every case reads several of its arguments
+static void execute(ReplayState &state, const GLCaptureCommand &c)
+{
+    switch (c.Call)
+    {
+        // objects
+        case GLCaptureFormat::GEN_BUFFERS: createNames(state.buffers, c, &glad_glGenBuffers); break;
+        case GLCaptureFormat::CREATE_BUFFERS: createNames(state.buffers, c, &glad_glCreateBuffers); break;
+        case GLCaptureFormat::DELETE_BUFFERS: deleteNames(state.buffers, c, &glad_glDeleteBuffers); break;
+        case GLCaptureFormat::GEN_VERTEX_ARRAYS: createNames(state.arrays, c, &glad_glGenVertexArrays); break;
+        case GLCaptureFormat::DELETE_VERTEX_ARRAYS: deleteNames(state.arrays, c, &glad_glDeleteVertexArrays); break;
+        case GLCaptureFormat::GEN_TEXTURES: createNames(state.textures, c, &glad_glGenTextures); break;
+        case GLCaptureFormat::CREATE_TEXTURES:
+        {
+            GLsizei n = (GLsizei) c.U32(1);
+            const GLuint* captured = (const GLuint*) c.Payload;
+            std::vector<GLuint> created(n > 0 ? n : 0);
+            if (n > 0)
+                glCreateTextures(c.U32(0), n, &created[0]);
+            for (GLsizei i = 0; i < n && (size_t) i * sizeof(GLuint) < c.PayloadSize; i++)
+                state.textures[captured[i]] = created[i];
+            break;
+        }
+        case GLCaptureFormat::DELETE_TEXTURES: deleteNames(state.textures, c, &glad_glDeleteTextures); break;
+        case GLCaptureFormat::CREATE_FRAMEBUFFERS: createNames(state.framebuffers, c, &glad_glCreateFramebuffers); break;
+        case GLCaptureFormat::DELETE_FRAMEBUFFERS: deleteNames(state.framebuffers, c, &glad_glDeleteFramebuffers); break;
+        case GLCaptureFormat::CREATE_SHADER: state.programs[c.U32(1)] = glCreateShader(c.U32(0)); break;
+        case GLCaptureFormat::SHADER_SOURCE:
+        {
+            const GLchar* source = c.Payload;
+            GLint length = (GLint) c.PayloadSize;
+            glShaderSource(mapName(state.programs, c.U32(0)), 1, &source, &length);
+            break;
+        }
+        case GLCaptureFormat::COMPILE_SHADER: glCompileShader(mapName(state.programs, c.U32(0))); break;
+        case GLCaptureFormat::DELETE_SHADER: glDeleteShader(mapName(state.programs, c.U32(0))); break;
+        case GLCaptureFormat::CREATE_PROGRAM: state.programs[c.U32(0)] = glCreateProgram(); break;
+        case GLCaptureFormat::ATTACH_SHADER: glAttachShader(mapName(state.programs, c.U32(0)), mapName(state.programs, c.U32(1))); break;
+        case GLCaptureFormat::DETACH_SHADER: glDetachShader(mapName(state.programs, c.U32(0)), mapName(state.programs, c.U32(1))); break;
+        case GLCaptureFormat::LINK_PROGRAM: glLinkProgram(mapName(state.programs, c.U32(0))); break;
+        case GLCaptureFormat::DELETE_PROGRAM: glDeleteProgram(mapName(state.programs, c.U32(0))); break;
+        case GLCaptureFormat::GET_UNIFORM_LOCATION:
+        {
+            GLuint program = mapName(state.programs, c.U32(0));
+            std::string name(c.Payload, c.PayloadSize);
+            state.uniforms[((uint64_t) program << 32) | c.U32(1)] = glGetUniformLocation(program, name.c_str());
+            break;
+        }
+        case GLCaptureFormat::GET_ATTRIB_LOCATION:
+        {
+            std::string name(c.Payload, c.PayloadSize);
+            state.attributes[c.I32(1)] = glGetAttribLocation(mapName(state.programs, c.U32(0)), name.c_str());
+            break;
+        }
+        // uploads
+        case GLCaptureFormat::MAPPED_WRITE: glNamedBufferSubData(mapName(state.buffers, c.U32(0)), (GLintptr) c.U64(1), c.PayloadSize, c.Payload); break;
+        case GLCaptureFormat::BUFFER_DATA: glBufferData(c.U32(0), (GLsizeiptr) c.U64(1), payload(c, 4), c.U32(3)); break;
+        case GLCaptureFormat::BUFFER_SUB_DATA: glBufferSubData(c.U32(0), (GLintptr) c.U64(1), c.PayloadSize, c.Payload); break;
+        case GLCaptureFormat::NAMED_BUFFER_STORAGE:
+            glNamedBufferStorage(mapName(state.buffers, c.U32(0)), (GLsizeiptr) c.U64(1), payload(c, 4), c.U32(3) | GL_DYNAMIC_STORAGE_BIT);
+            break;
+        case GLCaptureFormat::MAP_NAMED_BUFFER_RANGE:
+        case GLCaptureFormat::UNMAP_NAMED_BUFFER:
+            // the writes arrive as MAPPED_WRITE records, nothing to map
+            break;
+        case GLCaptureFormat::TEX_IMAGE_2D:
+            glTexImage2D(c.U32(0), c.I32(1), c.I32(2), c.I32(3), c.I32(4), c.I32(5), c.U32(6), c.U32(7), payload(c, 8));
+            break;
+        case GLCaptureFormat::TEXTURE_STORAGE_2D:
+            glTextureStorage2D(mapName(state.textures, c.U32(0)), c.I32(1), c.U32(2), c.I32(3), c.I32(4));
+            break;
+        case GLCaptureFormat::GENERATE_MIPMAP: glGenerateMipmap(c.U32(0)); break;
+        case GLCaptureFormat::TEX_PARAMETERI: glTexParameteri(c.U32(0), c.U32(1), c.I32(2)); break;
+        case GLCaptureFormat::TEXTURE_PARAMETERI: glTextureParameteri(mapName(state.textures, c.U32(0)), c.U32(1), c.I32(2)); break;
+        // vertex and framebuffer setup
+        case GLCaptureFormat::VERTEX_ATTRIB_POINTER:
+            glVertexAttribPointer(mapAttribute(state, c.I32(0)), c.I32(1), c.U32(2), (GLboolean) c.U32(3), c.I32(4), offset(c.U64(5)));
+            break;
+        case GLCaptureFormat::ENABLE_VERTEX_ATTRIB_ARRAY: glEnableVertexAttribArray(mapAttribute(state, c.I32(0))); break;
+        case GLCaptureFormat::VERTEX_ATTRIB_DIVISOR: glVertexAttribDivisor(mapAttribute(state, c.I32(0)), c.U32(1)); break;
+        case GLCaptureFormat::NAMED_FRAMEBUFFER_TEXTURE:
+            glNamedFramebufferTexture(mapName(state.framebuffers, c.U32(0)), c.U32(1), mapName(state.textures, c.U32(2)), c.I32(3));
+            break;
+        case GLCaptureFormat::NAMED_FRAMEBUFFER_DRAW_BUFFER:
+        {
+            // the stand-in backbuffer draws to its color attachment where the capture drew to GL_BACK
+            GLuint framebuffer = c.U32(0) == 0 ? state.backbuffer : mapName(state.framebuffers, c.U32(0));
+            glNamedFramebufferDrawBuffer(framebuffer, c.U32(0) == 0 && c.U32(1) != GL_NONE ? GL_COLOR_ATTACHMENT0 : c.U32(1));
+            break;
+        }
+        case GLCaptureFormat::NAMED_FRAMEBUFFER_DRAW_BUFFERS:
+            glNamedFramebufferDrawBuffers(mapName(state.framebuffers, c.U32(0)), c.I32(1), (const GLenum*) c.Payload);
+            break;
+        // binds
+        case GLCaptureFormat::USE_PROGRAM:
+            state.program = mapName(state.programs, c.U32(0));
+            glUseProgram(state.program);
+            break;
+        case GLCaptureFormat::BIND_VERTEX_ARRAY: glBindVertexArray(mapName(state.arrays, c.U32(0))); break;
+        case GLCaptureFormat::BIND_BUFFER: glBindBuffer(c.U32(0), mapName(state.buffers, c.U32(1))); break;
+        case GLCaptureFormat::BIND_BUFFER_BASE: glBindBufferBase(c.U32(0), c.U32(1), mapName(state.buffers, c.U32(2))); break;
+        case GLCaptureFormat::BIND_BUFFER_RANGE:
+            glBindBufferRange(c.U32(0), c.U32(1), mapName(state.buffers, c.U32(2)), (GLintptr) c.U64(3), (GLsizeiptr) c.U64(5));
+            break;
+        case GLCaptureFormat::ACTIVE_TEXTURE: glActiveTexture(c.U32(0)); break;
+        case GLCaptureFormat::BIND_TEXTURE: glBindTexture(c.U32(0), mapName(state.textures, c.U32(1))); break;
+        case GLCaptureFormat::BIND_TEXTURE_UNIT: glBindTextureUnit(c.U32(0), mapName(state.textures, c.U32(1))); break;
+        case GLCaptureFormat::BIND_TEXTURES:
+        {
+            GLsizei count = c.I32(1);
+            if (!c.U32(2))
+            {
+                glBindTextures(c.U32(0), count, NULL);
+                break;
+            }
+            std::vector<GLuint> textures(count > 0 ? count : 0);
+            const GLuint* captured = (const GLuint*) c.Payload;
+            for (GLsizei i = 0; i < count && (size_t) i * sizeof(GLuint) < c.PayloadSize; i++)
+                textures[i] = mapName(state.textures, captured[i]);
+            if (count > 0)
+                glBindTextures(c.U32(0), count, &textures[0]);
+            break;
+        }
+        case GLCaptureFormat::BIND_SAMPLER: glBindSampler(c.U32(0), c.U32(1)); break;
+        case GLCaptureFormat::BIND_FRAMEBUFFER:
+        {
+            GLuint framebuffer = c.U32(1) == 0 ? state.backbuffer : mapName(state.framebuffers, c.U32(1));
+            if (c.U32(0) != GL_READ_FRAMEBUFFER)
+                state.drawTarget = framebuffer;
+            glBindFramebuffer(c.U32(0), framebuffer);
+            break;
+        }
+        // fixed function state
+        case GLCaptureFormat::ENABLE: glEnable(c.U32(0)); break;
+        case GLCaptureFormat::DISABLE: glDisable(c.U32(0)); break;
+        case GLCaptureFormat::BLEND_FUNC: glBlendFunc(c.U32(0), c.U32(1)); break;
+        case GLCaptureFormat::BLEND_FUNC_SEPARATE: glBlendFuncSeparate(c.U32(0), c.U32(1), c.U32(2), c.U32(3)); break;
+        case GLCaptureFormat::BLEND_EQUATION: glBlendEquation(c.U32(0)); break;
+        case GLCaptureFormat::BLEND_EQUATION_SEPARATE: glBlendEquationSeparate(c.U32(0), c.U32(1)); break;
+        case GLCaptureFormat::DEPTH_FUNC: glDepthFunc(c.U32(0)); break;
+        case GLCaptureFormat::DEPTH_MASK: glDepthMask((GLboolean) c.U32(0)); break;
+        case GLCaptureFormat::POLYGON_MODE: glPolygonMode(c.U32(0), c.U32(1)); break;
+        case GLCaptureFormat::VIEWPORT: glViewport(c.I32(0), c.I32(1), c.I32(2), c.I32(3)); break;
+        case GLCaptureFormat::SCISSOR: glScissor(c.I32(0), c.I32(1), c.I32(2), c.I32(3)); break;
+        case GLCaptureFormat::CLEAR_COLOR: glClearColor(c.F32(0), c.F32(1), c.F32(2), c.F32(3)); break;
+        case GLCaptureFormat::PIXEL_STOREI: glPixelStorei(c.U32(0), c.I32(1)); break;
+        case GLCaptureFormat::MEMORY_BARRIER: glMemoryBarrier(c.U32(0)); break;
+        // uniforms
+        case GLCaptureFormat::UNIFORM_1I: glUniform1i(mapUniform(state, state.program, c.I32(0)), c.I32(1)); break;
+        case GLCaptureFormat::UNIFORM_1F: glUniform1f(mapUniform(state, state.program, c.I32(0)), c.F32(1)); break;
+        case GLCaptureFormat::UNIFORM_2F: glUniform2f(mapUniform(state, state.program, c.I32(0)), c.F32(1), c.F32(2)); break;
+        case GLCaptureFormat::UNIFORM_3F: glUniform3f(mapUniform(state, state.program, c.I32(0)), c.F32(1), c.F32(2), c.F32(3)); break;
+        case GLCaptureFormat::UNIFORM_4F:
+            glUniform4f(mapUniform(state, state.program, c.I32(0)), c.F32(1), c.F32(2), c.F32(3), c.F32(4));
+            break;
+        case GLCaptureFormat::UNIFORM_2FV: glUniform2fv(mapUniform(state, state.program, c.I32(0)), c.I32(1), (const GLfloat*) c.Payload); break;
+        case GLCaptureFormat::UNIFORM_3FV: glUniform3fv(mapUniform(state, state.program, c.I32(0)), c.I32(1), (const GLfloat*) c.Payload); break;
+        case GLCaptureFormat::UNIFORM_4FV: glUniform4fv(mapUniform(state, state.program, c.I32(0)), c.I32(1), (const GLfloat*) c.Payload); break;
+        case GLCaptureFormat::UNIFORM_MATRIX_2FV:
+            glUniformMatrix2fv(mapUniform(state, state.program, c.I32(0)), c.I32(1), (GLboolean) c.U32(2), (const GLfloat*) c.Payload);
+            break;
+        case GLCaptureFormat::UNIFORM_MATRIX_3FV:
+            glUniformMatrix3fv(mapUniform(state, state.program, c.I32(0)), c.I32(1), (GLboolean) c.U32(2), (const GLfloat*) c.Payload);
+            break;
+        case GLCaptureFormat::UNIFORM_MATRIX_4FV:
+            glUniformMatrix4fv(mapUniform(state, state.program, c.I32(0)), c.I32(1), (GLboolean) c.U32(2), (const GLfloat*) c.Payload);
+            break;
+        case GLCaptureFormat::PROGRAM_UNIFORM_1I:
+        {
+            GLuint program = mapName(state.programs, c.U32(0));
+            glProgramUniform1i(program, mapUniform(state, program, c.I32(1)), c.I32(2));
+            break;
+        }
+        case GLCaptureFormat::PROGRAM_UNIFORM_1IV:
+        {
+            GLuint program = mapName(state.programs, c.U32(0));
+            glProgramUniform1iv(program, mapUniform(state, program, c.I32(1)), c.I32(2), (const GLint*) c.Payload);
+            break;
+        }
+        // work
+        case GLCaptureFormat::CLEAR: glClear(c.U32(0)); break;
+        case GLCaptureFormat::DRAW_ARRAYS: glDrawArrays(c.U32(0), c.I32(1), c.I32(2)); break;
+        case GLCaptureFormat::DRAW_ELEMENTS: glDrawElements(c.U32(0), c.I32(1), c.U32(2), offset(c.U64(3))); break;
+        case GLCaptureFormat::DRAW_ELEMENTS_BASE_VERTEX:
+            glDrawElementsBaseVertex(c.U32(0), c.I32(1), c.U32(2), offset(c.U64(3)), c.I32(5));
+            break;
+        case GLCaptureFormat::DRAW_ELEMENTS_INSTANCED_BASE_VERTEX:
+            glDrawElementsInstancedBaseVertex(c.U32(0), c.I32(1), c.U32(2), offset(c.U64(3)), c.I32(5), c.I32(6));
+            break;
+        case GLCaptureFormat::DRAW_ELEMENTS_INSTANCED_BASE_INSTANCE:
+            glDrawElementsInstancedBaseInstance(c.U32(0), c.I32(1), c.U32(2), offset(c.U64(3)), c.I32(5), c.U32(6));
+            break;
+        case GLCaptureFormat::MULTI_DRAW_ELEMENTS_INDIRECT:
+            glMultiDrawElementsIndirect(c.U32(0), c.U32(1), offset(c.U64(2)), c.I32(4), c.I32(5));
+            break;
+        default:
+            break;
+    }
+    if (GLCaptureFormat::Info(c.Call).Type == GLCaptureFormat::DRAW && c.Call != GLCaptureFormat::CLEAR)
+        state.lastTarget = state.drawTarget;
+}
+
+static double now()
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static double percentile(std::vector<double> samples, double p)
+{
+    if (samples.empty())
+        return 0.0;
+    std::sort(samples.begin(), samples.end());
+    return samples[(size_t) ((samples.size() - 1) * p + 0.5)];
+}
+
+static double mean(const std::vector<double> &samples)
+{
+    double sum = 0.0;
+    for (unsigned int i = 0; i < samples.size(); i++)
+        sum += samples[i];
+    return samples.empty() ? 0.0 : sum / samples.size();
+}
+
+static void writeStats(FILE* file, const char* name, const std::vector<double> &samples, bool last)
+{
+    std::fprintf(file, "  \"%s\": {\"mean\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f}%s\n", name, mean(samples),
+                 percentile(samples, 0.5), percentile(samples, 0.95), percentile(samples, 0.99), percentile(samples, 1.0), last ? "" : ",");
+}
+
+// the first color attachment of framebuffer as a binary PPM, top row first.
+static bool writeScreenshot(const char* path, GLuint framebuffer, int width, int height)
+{
+    std::vector<unsigned char> pixels(width * height * 3);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    glNamedFramebufferReadBuffer(framebuffer, GL_COLOR_ATTACHMENT0);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, &pixels[0]);
+    FILE* file = std::fopen(path, "wb");
+    if (file == NULL)
+    {
+        std::cout << "ERROR::GL_REPLAY::FAILED_TO_WRITE " << path << std::endl;
+        return false;
+    }
+    std::fprintf(file, "P6\n%d %d\n255\n", width, height);
+    for (int y = height - 1; y >= 0; y--)
+        std::fwrite(&pixels[y * width * 3], 1, width * 3, file);
+    std::fclose(file);
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::cout << "usage: gl_replay <capture> [--output replay_stats.json] [--screenshot last_frame.ppm] [--state-cache]" << std::endl;
+        return -1;
+    }
+    const char* output = "replay_stats.json";
+    const char* screenshot = NULL;
+    bool stateCache = false;
+    for (int i = 2; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--output") == 0 && i + 1 < argc)
+            output = argv[++i];
+        else if (std::strcmp(argv[i], "--screenshot") == 0 && i + 1 < argc)
+            screenshot = argv[++i];
+        else if (std::strcmp(argv[i], "--state-cache") == 0)
+            stateCache = true;
+        else
+        {
+            std::cout << "unknown option " << argv[i] << std::endl;
+            return -1;
+        }
+    }
+
+    GLCaptureReader reader;
+    if (!reader.Open(argv[1]))
+        return -1;
+    int width = (int) reader.Header().Width;
+    int height = (int) reader.Header().Height;
+
+    EGLDisplay display;
+    EGLContext context;
+    if (!CreateHeadlessContext(display, context))
+        return -1;
+    // with the cache the replay shows what eliminating the redundant calls of the capture is worth
+    if (stateCache)
+        GLStateCache::Install();
+
+    ReplayState state;
+    state.program = 0;
+    state.errors = 0;
+    GLuint targets[2];
+    glCreateTextures(GL_TEXTURE_2D, 2, targets);
+    glTextureStorage2D(targets[0], 1, GL_RGBA8, width, height);
+    glTextureStorage2D(targets[1], 1, GL_DEPTH24_STENCIL8, width, height);
+    glCreateFramebuffers(1, &state.backbuffer);
+    glNamedFramebufferTexture(state.backbuffer, GL_COLOR_ATTACHMENT0, targets[0], 0);
+    glNamedFramebufferTexture(state.backbuffer, GL_DEPTH_STENCIL_ATTACHMENT, targets[1], 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, state.backbuffer);
+    state.drawTarget = state.backbuffer;
+    state.lastTarget = state.backbuffer;
+    glViewport(0, 0, width, height);
+
+    std::vector<double> frameTimes, submitTimes;
+    unsigned long long issued = 0, elided = 0;
+    double setupStart = now(), frameStart = 0.0, setupTime = 0.0;
+    bool inFrame = false;
+    GLCaptureCommand command;
+    while (reader.Next(command))
+    {
+        if (command.Call == GLCaptureFormat::FRAME_BEGIN)
+        {
+            if (frameTimes.empty() && !inFrame)
+            {
+                glFinish();
+                setupTime = now() - setupStart;
+            }
+            frameStart = now();
+            inFrame = true;
+        }
+        else if (command.Call == GLCaptureFormat::FRAME_END)
+        {
+            double submitted = now();
+            glFinish();
+            frameTimes.push_back(now() - frameStart);
+            submitTimes.push_back(submitted - frameStart);
+            inFrame = false;
+            while (glGetError() != GL_NO_ERROR)
+                state.errors++;
+            if (stateCache)
+            {
+                GLStateCache::EndFrame();
+                issued += GLStateCache::LastFrame().Issued();
+                elided += GLStateCache::LastFrame().Elided();
+            }
+        }
+        else
+            execute(state, command);
+    }
+    glFinish();
+
+    const char* renderer = (const char*) glGetString(GL_RENDERER);
+    std::printf("%s: %u frames at %dx%d, setup %.2f ms, frame mean %.3f ms, p95 %.3f ms, %u GL errors\n", renderer,
+                (unsigned int) frameTimes.size(), width, height, setupTime, mean(frameTimes), percentile(frameTimes, 0.95), state.errors);
+    if (stateCache)
+        std::printf("state cache: %llu calls issued, %llu elided\n", issued, elided);
+
+    bool written = screenshot == NULL || writeScreenshot(screenshot, state.lastTarget, width, height);
+    FILE* file = std::fopen(output, "w");
+    if (file == NULL)
+        std::cout << "ERROR::GL_REPLAY::FAILED_TO_WRITE " << output << std::endl;
+    else
+    {
+        std::fprintf(file, "{\n  \"capture\": \"%s\",\n  \"renderer\": \"%s\",\n", argv[1], renderer);
+        std::fprintf(file, "  \"width\": %d,\n  \"height\": %d,\n  \"frames\": %u,\n  \"errors\": %u,\n  \"setup_ms\": %.4f,\n", width, height,
+                     (unsigned int) frameTimes.size(), state.errors, setupTime);
+        writeStats(file, "frame_ms", frameTimes, false);
+        writeStats(file, "submit_ms", submitTimes, !stateCache);
+        if (stateCache)
+            std::fprintf(file, "  \"state_cache\": {\"issued\": %llu, \"elided\": %llu}\n", issued, elided);
+        std::fprintf(file, "}\n");
+        std::fclose(file);
+    }
+
+    // the replayed objects go with the context
+    DestroyHeadlessContext(display, context);
+    return file != NULL && written && state.errors == 0 ? 0 : -1;
+}
@@ -0,0 +1,522 @@
+// glsl_reflect: build step that reads the GLSL sources under res/shaders and generates a C++ header with
+// typed parameter structs for every program (a program is the set of stages sharing a file name, e.g.
+// shader.vs + shader.fs -> "shader").
+//
+// For every program the header contains:
+//  - an Attribute enum with the explicit vertex attribute locations,
+//  - a Sampler enum with a precomputed texture unit for every sampler uniform,
+//  - one std140 struct per uniform block (with its binding point) that can be memcpy'd into a UBO,
+//  - a Uniforms struct with the locations of the remaining default block uniforms,
+//  - Setup(program) which assigns the sampler units / block bindings and resolves those locations once.
+//
+// usage: glsl_reflect <output header> <shader files...>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+struct TypeInfo
+{
+    const char* glsl;
+    const char* cpp;
+    int align;  // std140 base alignment
+    int size;   // std140 size
+};
+
+// std140 layout of the types we support inside uniform blocks.
+static const TypeInfo types[] = {
+        {"float", "float", 4, 4},
+        {"int", "int32_t", 4, 4},
+        {"uint", "uint32_t", 4, 4},
+        {"bool", "uint32_t", 4, 4},
+        {"vec2", "glm::vec2", 8, 8},
+        {"vec3", "glm::vec3", 16, 12},
+        {"vec4", "glm::vec4", 16, 16},
+        {"ivec2", "glm::ivec2", 8, 8},
+        {"ivec3", "glm::ivec3", 16, 12},
+        {"ivec4", "glm::ivec4", 16, 16},
+        {"uvec2", "glm::uvec2", 8, 8},
+        {"uvec3", "glm::uvec3", 16, 12},
+        {"uvec4", "glm::uvec4", 16, 16},
+        {"mat2", "std140_mat2", 16, 32},
+        {"mat3", "std140_mat3", 16, 48},
+        {"mat4", "glm::mat4", 16, 64},
+};
+
+static const TypeInfo* findType(const std::string &name)
+{
+    for (const TypeInfo &type : types)
+    {
+        if (name == type.glsl)
+            return &type;
+    }
+    return nullptr;
+}
+
+static bool isOpaque(const std::string &type)
+{
+    return type.find("sampler") != std::string::npos || type.find("image") != std::string::npos;
+}
+
+struct Variable
+{
+    std::string Type;
+    std::string Name;
+    int ArraySize;   // 0 when not an array
+    int Location;    // explicit layout location, -1 if none
+};
+
+struct Block
+{
+    std::string Name;
+    std::vector<Variable> Members;
+    int Binding;     // explicit layout binding, -1 if none
+};
+
+struct Program
+{
+    std::string Name;
+    std::vector<Variable> Attributes;
+    std::vector<Variable> Samplers;
+    std::vector<Variable> Uniforms;
+    std::vector<Block> Blocks;
+};
+
+static int errors = 0;
+
+static void error(const std::string &file, const std::string &message)
+{
+    std::cerr << file << ": error: " << message << std::endl;
+    errors++;
+}
+
+// splits the source in identifiers, numbers and single character punctuation. Comments and
+// preprocessor lines are dropped.
+static std::vector<std::string> tokenize(const std::string &code)
+{
+    std::vector<std::string> tokens;
+    size_t i = 0;
+    bool lineStart = true;
+    while (i < code.size())
+    {
+        char c = code[i];
+        if (c == '\n')
+        {
+            lineStart = true;
+            i++;
+        }
+        else if (std::isspace((unsigned char) c))
+            i++;
+        else if (c == '#' && lineStart)
+        {
+            while (i < code.size() && code[i] != '\n')
+                i++;
+        }
+        else if (c == '/' && i + 1 < code.size() && code[i + 1] == '/')
+        {
+            while (i < code.size() && code[i] != '\n')
+                i++;
+        }
+        else if (c == '/' && i + 1 < code.size() && code[i + 1] == '*')
+        {
+            size_t end = code.find("*/", i + 2);
+            i = end == std::string::npos ? code.size() : end + 2;
+        }
+        else if (std::isalnum((unsigned char) c) || c == '_')
+        {
+            size_t start = i;
+            while (i < code.size() && (std::isalnum((unsigned char) code[i]) || code[i] == '_' || code[i] == '.'))
+                i++;
+            tokens.push_back(code.substr(start, i - start));
+            lineStart = false;
+        }
+        else
+        {
+            tokens.push_back(std::string(1, c));
+            lineStart = false;
+            i++;
+        }
+    }
+    return tokens;
+}
+
+// reads the value of "key = N" inside a layout(...) qualifier, -1 if missing.
+static int layoutValue(const std::vector<std::string> &layout, const char* key)
+{
+    for (size_t i = 0; i + 2 < layout.size(); i++)
+    {
+        if (layout[i] == key && layout[i + 1] == "=")
+            return std::atoi(layout[i + 2].c_str());
+    }
+    return -1;
+}
+
+// parses "type name [N]" starting at tokens[i].
+static bool parseVariable(const std::vector<std::string> &tokens, size_t &i, Variable &variable)
+{
+    // skip precision and interpolation qualifiers
+    while (i < tokens.size() && (tokens[i] == "highp" || tokens[i] == "mediump" || tokens[i] == "lowp" ||
+                                 tokens[i] == "flat" || tokens[i] == "smooth" || tokens[i] == "noperspective"))
+        i++;
+    if (i + 1 >= tokens.size())
+        return false;
+    variable.Type = tokens[i++];
+    variable.Name = tokens[i++];
+    variable.ArraySize = 0;
+    if (i + 2 < tokens.size() && tokens[i] == "[")
+    {
+        variable.ArraySize = std::atoi(tokens[i + 1].c_str());
+        i += 3;
+    }
+    return true;
+}
+
+template<typename T>
+static T* findByName(std::vector<T> &list, const std::string &name)
+{
+    for (T &item : list)
+    {
+        if (item.Name == name)
+            return &item;
+    }
+    return nullptr;
+}
+
+// adds the interface of one stage to its program, checking that declarations shared with the
+// other stages agree.
+static void parseStage(const std::string &file, const std::string &code, bool vertexStage, Program &program)
+{
+    std::vector<std::string> tokens = tokenize(code);
+    size_t i = 0;
+    while (i < tokens.size())
+    {
+        // a declaration starts here, collect its qualifiers
+        std::vector<std::string> layout;
+        bool uniform = false, input = false;
+        while (i < tokens.size())
+        {
+            if (tokens[i] == "layout" && i + 1 < tokens.size() && tokens[i + 1] == "(")
+            {
+                i += 2;
+                while (i < tokens.size() && tokens[i] != ")")
+                    layout.push_back(tokens[i++]);
+                i++;
+            }
+            else if (tokens[i] == "uniform")
+            {
+                uniform = true;
+                i++;
+            }
+            else if (tokens[i] == "in" || tokens[i] == "attribute")
+            {
+                input = true;
+                i++;
+            }
+            else if (tokens[i] == "out" || tokens[i] == "const" || tokens[i] == "centroid")
+                i++;
+            else
+                break;
+        }
+        if (i >= tokens.size())
+            break;
+
+        if (uniform && i + 1 < tokens.size() && tokens[i + 1] == "{")
+        {
+            // uniform block: uniform Name { members } [instance];
+            Block block;
+            block.Name = tokens[i];
+            block.Binding = layoutValue(layout, "binding");
+            i += 2;
+            while (i < tokens.size() && tokens[i] != "}")
+            {
+                Variable member;
+                if (!parseVariable(tokens, i, member))
+                    break;
+                member.Location = -1;
+                block.Members.push_back(member);
+                while (i < tokens.size() && tokens[i] != ";")
+                    i++;
+                i++;
+            }
+            while (i < tokens.size() && tokens[i] != ";")
+                i++;
+            i++;
+
+            Block* existing = findByName(program.Blocks, block.Name);
+            if (existing == nullptr)
+                program.Blocks.push_back(block);
+            else if (existing->Members.size() != block.Members.size())
+                error(file, "uniform block " + block.Name + " is declared differently in another stage");
+            continue;
+        }
+
+        if (uniform || (input && vertexStage))
+        {
+            Variable variable;
+            if (!parseVariable(tokens, i, variable))
+                break;
+            variable.Location = layoutValue(layout, "location");
+            std::vector<Variable> &list = !uniform ? program.Attributes :
+                                          isOpaque(variable.Type) ? program.Samplers : program.Uniforms;
+            Variable* existing = findByName(list, variable.Name);
+            if (existing == nullptr)
+                list.push_back(variable);
+            else if (existing->Type != variable.Type || existing->ArraySize != variable.ArraySize)
+                error(file, "uniform " + variable.Name + " is declared as " + variable.Type + " here and as " + existing->Type + " in another stage");
+            while (i < tokens.size() && tokens[i] != ";")
+                i++;
+            i++;
+            continue;
+        }
+
+        // anything else (functions, structs, varyings...): skip to the end of the statement or body
+        int depth = 0;
+        while (i < tokens.size())
+        {
+            const std::string &token = tokens[i++];
+            if (token == "{")
+                depth++;
+            else if (token == "}")
+            {
+                if (--depth == 0)
+                {
+                    if (i < tokens.size() && tokens[i] == ";")
+                        i++;
+                    break;
+                }
+            }
+            else if (token == ";" && depth == 0)
+                break;
+        }
+    }
+}
+
+static int alignUp(int value, int alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+static std::string identifier(const std::string &name)
+{
+    std::string result = name;
+    for (char &c : result)
+    {
+        if (!std::isalnum((unsigned char) c))
+            c = '_';
+    }
+    return result;
+}
+
+static void writeBlock(std::ostream &out, const std::string &file, const Block &block, int binding)
+{
+    out << "    // uniform block " << block.Name << ", std140 layout: fill it and memcpy it into the UBO bound at Binding.\n";
+    out << "    struct " << block.Name << "\n    {\n";
+    out << "        static const GLuint Binding = " << binding << ";\n\n";
+    int offset = 0;
+    int padding = 0;
+    std::vector<std::pair<std::string, int> > offsets;
+    for (const Variable &member : block.Members)
+    {
+        const TypeInfo* type = findType(member.Type);
+        if (type == nullptr)
+        {
+            error(file, "unsupported type " + member.Type + " in uniform block " + block.Name);
+            continue;
+        }
+        int align = member.ArraySize > 0 ? 16 : type->align;
+        int size = member.ArraySize > 0 ? alignUp(type->size, 16) * member.ArraySize : type->size;
+        int aligned = alignUp(offset, align);
+        if (aligned != offset)
+            out << "        char _pad" << padding++ << "[" << aligned - offset << "];\n";
+        if (member.ArraySize > 0)
+        {
+            // arrays use a 16 byte stride in std140, vec4 sized types already have it
+            bool strided = type->size % 16 == 0;
+            out << "        " << (strided ? std::string(type->cpp) : "std140_element<" + std::string(type->cpp) + ">")
+                << " " << member.Name << "[" << member.ArraySize << "];\n";
+        }
+        else
+            out << "        " << type->cpp << " " << member.Name << ";\n";
+        offsets.push_back(std::make_pair(member.Name, aligned));
+        offset = aligned + size;
+    }
+    out << "    };\n";
+    for (const std::pair<std::string, int> &entry : offsets)
+        out << "    static_assert(offsetof(" << block.Name << ", " << entry.first << ") == " << entry.second
+            << ", \"std140 offset of " << block.Name << "::" << entry.first << "\");\n";
+    out << "\n";
+}
+
+// blocks with the same name share their binding point across programs, so one UBO serves all of them.
+static std::map<std::string, int> blockBindings;
+
+// explicit layout(binding = N) values first, then every other block gets the lowest number no block uses yet,
+// so generated bindings never collide with explicit ones (whatever program they appear in).
+static void assignBlockBindings(const std::map<std::string, Program> &programs)
+{
+    std::set<int> used;
+    for (const std::pair<const std::string, Program> &entry : programs)
+    {
+        for (const Block &block : entry.second.Blocks)
+        {
+            if (block.Binding < 0)
+                continue;
+            std::map<std::string, int>::iterator assigned = blockBindings.find(block.Name);
+            if (assigned != blockBindings.end() && assigned->second != block.Binding)
+                error(entry.first, "block " + block.Name + " has binding " + std::to_string(block.Binding) + " here and " +
+                                   std::to_string(assigned->second) + " in another program");
+            else if (assigned == blockBindings.end())
+                blockBindings[block.Name] = block.Binding;
+            used.insert(block.Binding);
+        }
+    }
+    int next = 0;
+    for (const std::pair<const std::string, Program> &entry : programs)
+    {
+        for (const Block &block : entry.second.Blocks)
+        {
+            if (blockBindings.find(block.Name) != blockBindings.end())
+                continue;
+            while (used.count(next) > 0)
+                next++;
+            blockBindings[block.Name] = next;
+            used.insert(next);
+        }
+    }
+}
+
+static void writeProgram(std::ostream &out, const std::string &file, const Program &program)
+{
+    out << "namespace " << identifier(program.Name) << "\n{\n";
+
+    out << "    // vertex attribute locations\n    enum Attribute\n    {\n";
+    for (const Variable &attribute : program.Attributes)
+    {
+        if (attribute.Location < 0)
+            out << "        // " << attribute.Name << " has no explicit location\n";
+        else
+            out << "        " << attribute.Name << " = " << attribute.Location << ",\n";
+    }
+    out << "    };\n\n";
+
+    // sampler arrays take one unit per element, the enum holds the first one
+    out << "    // texture unit of every sampler, assigned by Setup()\n    enum Sampler\n    {\n";
+    int unit = 0;
+    for (const Variable &sampler : program.Samplers)
+    {
+        out << "        " << sampler.Name << " = " << unit << ",\n";
+        unit += sampler.ArraySize > 0 ? sampler.ArraySize : 1;
+    }
+    out << "    };\n\n";
+
+    for (const Block &block : program.Blocks)
+        writeBlock(out, file, block, blockBindings[block.Name]);
+
+    out << "    // locations of the default block uniforms, resolved once by Setup()\n    struct Uniforms\n    {\n";
+    for (const Variable &uniform : program.Uniforms)
+        out << "        GLint " << uniform.Name << ";\n";
+    out << "    };\n\n";
+
+    out << "    // assigns the sampler units and block bindings of program and resolves the uniform locations.\n";
+    out << "    inline Uniforms Setup(GLuint program)\n    {\n";
+    out << "        Uniforms uniforms;\n";
+    for (const Variable &sampler : program.Samplers)
+    {
+        if (sampler.ArraySize > 0)
+        {
+            out << "        {\n            GLint units[" << sampler.ArraySize << "];\n";
+            out << "            for (int i = 0; i < " << sampler.ArraySize << "; i++)\n                units[i] = " << sampler.Name << " + i;\n";
+            out << "            glProgramUniform1iv(program, glGetUniformLocation(program, \"" << sampler.Name << "\"), " << sampler.ArraySize << ", units);\n        }\n";
+        }
+        else
+            out << "        glProgramUniform1i(program, glGetUniformLocation(program, \"" << sampler.Name << "\"), " << sampler.Name << ");\n";
+    }
+    for (size_t i = 0; i < program.Blocks.size(); i++)
+    {
+        const std::string &name = program.Blocks[i].Name;
+        out << "        if (glGetUniformBlockIndex(program, \"" << name << "\") != GL_INVALID_INDEX)\n";
+        out << "            glUniformBlockBinding(program, glGetUniformBlockIndex(program, \"" << name << "\"), " << name << "::Binding);\n";
+    }
+    for (const Variable &uniform : program.Uniforms)
+        out << "        uniforms." << uniform.Name << " = glGetUniformLocation(program, \"" << uniform.Name << "\");\n";
+    // ProgramSamplers may have read the units before, it reads them again on the next lookup
+    if (!program.Samplers.empty())
+        out << "        ProgramSamplers::Invalidate(program);\n";
+    out << "        return uniforms;\n    }\n";
+    out << "}\n\n";
+}
+
+static std::string readFile(const std::string &path)
+{
+    std::ifstream file(path);
+    if (!file)
+        return std::string();
+    std::stringstream stream;
+    stream << file.rdbuf();
+    return stream.str();
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        std::cerr << "usage: glsl_reflect <output header> <shader files...>" << std::endl;
+        return 1;
+    }
+
+    std::map<std::string, Program> programs;
+    for (int i = 2; i < argc; i++)
+    {
+        std::string path = argv[i];
+        size_t slash = path.find_last_of("/\\");
+        std::string fileName = slash == std::string::npos ? path : path.substr(slash + 1);
+        size_t dot = fileName.find_last_of('.');
+        std::string name = fileName.substr(0, dot);
+        std::string extension = dot == std::string::npos ? std::string() : fileName.substr(dot + 1);
+
+        std::string code = readFile(path);
+        if (code.empty())
+        {
+            error(path, "can't read shader");
+            continue;
+        }
+        Program &program = programs[name];
+        program.Name = name;
+        parseStage(path, code, extension == "vs" || extension == "vert", program);
+    }
+
+    std::stringstream out;
+    out << "// generated by tools/glsl_reflect.cpp from res/shaders, do not edit.\n";
+    out << "#ifndef SHADER_PARAMS_H\n#define SHADER_PARAMS_H\n\n";
+    out << "#include <glad/glad.h>\n#include <glm/glm.hpp>\n\n#include <learnopengl/program_samplers.h>\n\n#include <cstddef>\n#include <cstdint>\n\n";
+    out << "namespace ShaderParams\n{\n";
+    out << "// std140 pads matrix columns and array elements to 16 bytes.\n";
+    out << "struct std140_mat2\n{\n    glm::vec4 columns[2];\n    std140_mat2 &operator=(const glm::mat2 &m) { columns[0] = glm::vec4(m[0], 0.0f, 0.0f); columns[1] = glm::vec4(m[1], 0.0f, 0.0f); return *this; }\n};\n";
+    out << "struct std140_mat3\n{\n    glm::vec4 columns[3];\n    std140_mat3 &operator=(const glm::mat3 &m) { for (int i = 0; i < 3; i++) columns[i] = glm::vec4(m[i], 0.0f); return *this; }\n};\n";
+    out << "template<typename T>\nstruct alignas(16) std140_element\n{\n    T value;\n};\n\n";
+
+    assignBlockBindings(programs);
+    for (const std::pair<const std::string, Program> &entry : programs)
+        writeProgram(out, entry.first, entry.second);
+    out << "}\n\n#endif\n";
+
+    if (errors > 0)
+        return 1;
+
+    std::ofstream file(argv[1]);
+    file << out.str();
+    if (!file)
+    {
+        std::cerr << argv[1] << ": error: can't write header" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,136 @@
+// soft_render: renders a model with the CPU rasterizer (include/learnopengl/software_rasterizer.h) into a PPM,
+// no GL context or GPU needed. Meant for reference images and previews of assets on build servers.
+//
+// The model is imported like Model::loadModel does (same assimp post processing, Model::ConvertMesh for the
+// vertices) and shaded with the first diffuse and specular texture of every material. The camera looks at the
+// model bounds from the front, --yaw/--pitch orbit it around the center (degrees).
+//
+// usage: soft_render <model> [--output model.ppm] [--width 800] [--height 600] [--workers 0] [--yaw 0] [--pitch 15]
+
+// model.h pulls in stb_image.h, compile its implementation in this translation unit.
+#define STB_IMAGE_IMPLEMENTATION
+#include <learnopengl/model.h>
+#include <learnopengl/software_rasterizer.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+struct SoftwareMesh
+{
+    std::vector<Vertex> Vertices;
+    std::vector<unsigned int> Indices;
+    SoftwareMaterial Material;
+};
+
+static const SoftwareTexture* materialTexture(SoftwareRasterizer &rasterizer, const aiMaterial* material, aiTextureType type,
+                                              const std::string &directory)
+{
+    if (material->GetTextureCount(type) == 0)
+        return nullptr;
+    aiString path;
+    material->GetTexture(type, 0, &path);
+    return rasterizer.LoadTexture(directory + '/' + path.C_Str());
+}
+
+static void processNode(const aiNode* node, const aiScene* scene, SoftwareRasterizer &rasterizer, const std::string &directory,
+                        std::vector<SoftwareMesh> &meshes)
+{
+    for (unsigned int i = 0; i < node->mNumMeshes; i++)
+    {
+        const aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
+        const aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
+        SoftwareMesh converted;
+        Model::ConvertMesh(mesh, converted.Vertices, converted.Indices);
+        SoftwareMaterial shading = {materialTexture(rasterizer, material, aiTextureType_DIFFUSE, directory),
+                                    materialTexture(rasterizer, material, aiTextureType_SPECULAR, directory), glm::vec3(0.8f), 0.5f, 32.0f};
+        converted.Material = shading;
+        meshes.push_back(converted);
+    }
+    for (unsigned int i = 0; i < node->mNumChildren; i++)
+        processNode(node->mChildren[i], scene, rasterizer, directory, meshes);
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::cout << "usage: soft_render <model> [--output model.ppm] [--width W] [--height H] [--workers N] [--yaw D] [--pitch D]" << std::endl;
+        return -1;
+    }
+    const char* path = argv[1];
+    const char* output = "model.ppm";
+    int width = 800, height = 600;
+    unsigned int workers = 0;
+    float yaw = 0.0f, pitch = 15.0f;
+    for (int i = 2; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "--output") == 0)
+            output = argv[i + 1];
+        else if (std::strcmp(argv[i], "--width") == 0)
+            width = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--height") == 0)
+            height = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--workers") == 0)
+            workers = (unsigned int) std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--yaw") == 0)
+            yaw = (float) std::atof(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--pitch") == 0)
+            pitch = (float) std::atof(argv[i + 1]);
+        else
+        {
+            std::cout << "unknown option " << argv[i] << std::endl;
+            return -1;
+        }
+    }
+
+    Assimp::Importer importer;
+    const aiScene* scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_CalcTangentSpace);
+    if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
+    {
+        std::cout << "ERROR::ASSIMP:: " << importer.GetErrorString() << std::endl;
+        return -1;
+    }
+    std::string file = path;
+    std::string directory = file.find('/') != std::string::npos ? file.substr(0, file.find_last_of('/')) : ".";
+
+    SoftwareRasterizer rasterizer(width, height, workers);
+    std::vector<SoftwareMesh> meshes;
+    processNode(scene->mRootNode, scene, rasterizer, directory, meshes);
+
+    // frame the bounding sphere of every vertex
+    glm::vec3 min(1e30f), max(-1e30f);
+    for (unsigned int m = 0; m < meshes.size(); m++)
+    {
+        for (unsigned int i = 0; i < meshes[m].Vertices.size(); i++)
+        {
+            min = glm::min(min, meshes[m].Vertices[i].Position);
+            max = glm::max(max, meshes[m].Vertices[i].Position);
+        }
+    }
+    glm::vec3 center = (min + max) * 0.5f;
+    float radius = glm::length(max - min) * 0.5f;
+    float fov = glm::radians(45.0f);
+    float distance = radius / std::sin(fov * 0.5f);
+    glm::vec3 direction(std::sin(glm::radians(yaw)) * std::cos(glm::radians(pitch)), std::sin(glm::radians(pitch)),
+                        std::cos(glm::radians(yaw)) * std::cos(glm::radians(pitch)));
+    glm::mat4 view = glm::lookAt(center + direction * distance, center, glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 projection = glm::perspective(fov, (float) width / (float) height, distance * 0.01f, distance + radius * 2.0f);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    rasterizer.BeginFrame(glm::vec4(0.1f, 0.1f, 0.1f, 1.0f));
+    rasterizer.SetCamera(view, projection);
+    for (unsigned int m = 0; m < meshes.size(); m++)
+        rasterizer.Draw(meshes[m].Vertices, meshes[m].Indices, glm::mat4(1.0f), meshes[m].Material);
+    rasterizer.Render();
+    double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    const SoftwareRasterStats &stats = rasterizer.Stats();
+    std::printf("%s: %u meshes, %u triangles, %u pixels shaded, %.2f ms on %u workers\n", path, (unsigned int) meshes.size(),
+                stats.Triangles, stats.Shaded, milliseconds, rasterizer.Workers());
+    return rasterizer.WritePPM(output) ? 0 : -1;
+}